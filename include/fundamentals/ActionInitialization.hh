@@ -20,9 +20,12 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 using std::string;
+using std::vector;
 
+#include "G4UserRunAction.hh"
 #include "G4VUserActionInitialization.hh"
 
 class B4DetectorConstruction;
@@ -36,6 +39,11 @@ public:
   virtual void Build() const;
 
 private:
+  /**
+   * \brief Set a single run action, or combine several of them
+   */
+  void SetRunActions(const vector<G4UserRunAction *> &run_actions) const;
+
   const long random_number_seed;
   const string output_file_name;
 };
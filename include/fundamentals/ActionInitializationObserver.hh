@@ -0,0 +1,54 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <string>
+
+using std::string;
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+/**
+ * \brief Register the ActionInitialization when the run manager is
+ * initialized
+ *
+ * The run manager builds the user actions of the master thread, and of the
+ * only thread of a sequential application, as soon as the action
+ * initialization is registered.
+ * The actions depend on settings of macro commands, for example the
+ * selected back-ends and the profiler, which must be given before
+ * /run/initialize.
+ * Therefore, the action initialization is only registered when the master
+ * thread enters the Init state for the first time.
+ *
+ * An instance must be created by the master thread before the first macro
+ * command is executed, and it is deleted by the G4StateManager.
+ */
+class ActionInitializationObserver : public G4VStateDependent {
+public:
+  ActionInitializationObserver(const string out_file_name, const long seed);
+  G4bool Notify(G4ApplicationState requested_state) override;
+
+private:
+  const long random_number_seed;
+  const string output_file_name;
+  bool registered;
+};
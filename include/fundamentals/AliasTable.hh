@@ -0,0 +1,79 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+using std::istream;
+using std::ostream;
+using std::vector;
+
+/**
+ * \brief Sample indices with given weights in constant time
+ *
+ * Implements Walker's alias method.
+ * The table is built in linear time with the algorithm of M. D. Vose, IEEE
+ * Transactions on Software Engineering 17, 972 (1991).
+ * Each index owns a cell of equal probability, which it shares with at most
+ * one other index, its alias.
+ */
+class AliasTable {
+public:
+  AliasTable() = default;
+  /**
+   * \brief Build the table
+   *
+   * \param weights Non-negative weights, which do not have to be normalized.
+   * At least one of them must be positive.
+   */
+  explicit AliasTable(const vector<double> &weights);
+
+  /**
+   * \brief Sample an index
+   *
+   * \param uniform Random number from the interval [0, 1). It selects the
+   * cell as well as the index inside the cell.
+   */
+  size_t operator()(const double uniform) const {
+    const double x = uniform * static_cast<double>(probability.size());
+    const size_t cell =
+        std::min(static_cast<size_t>(x), probability.size() - 1);
+    return x - static_cast<double>(cell) < probability[cell] ? cell
+                                                              : alias[cell];
+  }
+  size_t size() const { return probability.size(); }
+
+  void write(ostream &stream) const;
+  /**
+   * \brief Read a table that was written by write()
+   *
+   * \return false if the stream does not contain a valid table.
+   */
+  bool read(istream &stream);
+
+private:
+  vector<double>
+      probability; /**< Probability that a cell returns its own index. */
+  vector<uint32_t> alias; /**< Index that a cell returns otherwise. */
+};
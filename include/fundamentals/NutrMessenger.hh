@@ -21,7 +21,11 @@
 
 #include <string>
 
+#include "G4SystemOfUnits.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
 #include "G4UIdirectory.hh"
 #include "G4UImessenger.hh"
 
@@ -30,10 +34,71 @@ public:
   NutrMessenger();
   void SetNewValue(G4UIcommand *command, G4String str) override;
   static std::string GetFilename() { return filename; };
+  static std::string GetFormat() { return format; };
+  static size_t GetChunkSize() { return chunk_size; };
+  static int GetCompressionLevel() { return compression_level; };
+  static size_t GetWriterQueue() { return writer_queue; };
+  static bool GetSharding() { return sharding; };
+  static size_t GetShardSize() { return shard_size; };
+  static bool GetMerge() { return merge; };
+  static bool GetZeroSuppression() { return zero_suppression; };
+  static size_t GetHitMemory() { return hit_memory; };
+  static double GetTrackerMergeDistance() { return tracker_merge_distance; };
+  static double GetTrackerMergeTime() { return tracker_merge_time; };
+  static bool GetTrackerCompact() { return tracker_compact; };
+  static size_t GetHistogramBins() { return histogram_bins; };
+  static double GetHistogramMaximum() { return histogram_maximum; };
+  static bool GetHistogramSparse() { return histogram_sparse; };
+  static std::string GetHistogramLiveFile() { return histogram_live_file; };
+  static double GetHistogramLiveInterval() { return histogram_live_interval; };
+  static std::string GetGroupOutput() { return group_output; };
+  static double GetGroupThreshold() { return group_threshold; };
 
 private:
   G4UIdirectory dir;
   G4UIcmdWithAString cmd_filename;
+  G4UIcmdWithAString cmd_format;
+  G4UIdirectory dir_ncol;
+  G4UIcmdWithAnInteger cmd_chunk_size;
+  G4UIcmdWithAnInteger cmd_compression_level;
+  G4UIcmdWithAnInteger cmd_writer_queue;
+  G4UIcmdWithABool cmd_sharding;
+  G4UIcmdWithAnInteger cmd_shard_size;
+  G4UIcmdWithABool cmd_merge;
+  G4UIcmdWithABool cmd_zero_suppression;
+  G4UIcmdWithAnInteger cmd_hit_memory;
+  G4UIdirectory dir_tracker;
+  G4UIcmdWithADoubleAndUnit cmd_tracker_merge_distance;
+  G4UIcmdWithADoubleAndUnit cmd_tracker_merge_time;
+  G4UIcmdWithABool cmd_tracker_compact;
+  G4UIdirectory dir_histogram;
+  G4UIcmdWithAnInteger cmd_histogram_bins;
+  G4UIcmdWithADoubleAndUnit cmd_histogram_maximum;
+  G4UIcmdWithABool cmd_histogram_sparse;
+  G4UIcmdWithAString cmd_histogram_live_file;
+  G4UIcmdWithADoubleAndUnit cmd_histogram_live_interval;
+  G4UIdirectory dir_groups;
+  G4UIcmdWithAString cmd_group_output;
+  G4UIcmdWithADoubleAndUnit cmd_group_threshold;
 
   inline static std::string filename = "";
+  inline static std::string format = "geant4";
+  inline static size_t chunk_size = 16384;
+  inline static int compression_level = 1;
+  inline static size_t writer_queue = 0;
+  inline static bool sharding = false;
+  inline static size_t shard_size = 0;
+  inline static bool merge = false;
+  inline static bool zero_suppression = false;
+  inline static size_t hit_memory = 256;
+  inline static double tracker_merge_distance = 0.;
+  inline static double tracker_merge_time = 1. * ns;
+  inline static bool tracker_compact = false;
+  inline static size_t histogram_bins = 10000;
+  inline static double histogram_maximum = 10. * MeV;
+  inline static bool histogram_sparse = false;
+  inline static std::string histogram_live_file = "";
+  inline static double histogram_live_interval = 10. * s;
+  inline static std::string group_output = "detectors";
+  inline static double group_threshold = 0.;
 };
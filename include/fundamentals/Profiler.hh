@@ -0,0 +1,173 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+using std::map;
+using std::mutex;
+using std::string;
+using std::unordered_map;
+
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4UserRunAction.hh"
+#include "G4UserSteppingAction.hh"
+#include "G4UserTrackingAction.hh"
+#include "G4VProcess.hh"
+#include "tls.hh"
+
+/**
+ * \brief Find out in which volumes, for which particles, and in which
+ * processes the simulation spends its time
+ *
+ * If the profiler is enabled, each thread counts the steps, and sums up the
+ * step lengths, per logical volume, per particle type, and per process that
+ * limited the step.
+ * A step is attributed to the logical volume in which it begins.
+ *
+ * Measuring the CPU time of each step would slow down the simulation
+ * considerably, so only every N-th step is timed, where N is the sampling
+ * period.
+ * The CPU time of a sampled step is the CPU time of the thread between the
+ * end of the previous step of the same track, or the start of the track, and
+ * its own end, i.e. it includes the processing by a sensitive detector.
+ * It is multiplied by N to estimate the total CPU time.
+ * Work between two tracks, like the stacking and the actions at the end of
+ * an event, is not attributed to any step.
+ *
+ * At the end of a run, the master thread prints a report with the entries
+ * of each category sorted by their CPU time, or by their number of steps if
+ * no step was timed.
+ */
+class Profiler {
+public:
+  /**
+   * \brief Enable the profiler
+   *
+   * Must be called before the user actions are built, i.e. before
+   * /run/initialize.
+   */
+  static void SetEnabled(const bool _enabled) { enabled = _enabled; };
+  static bool IsEnabled() { return enabled; };
+  /**
+   * \brief Time every N-th step, or no step at all for N = 0
+   */
+  static void SetSamplingPeriod(const uint32_t period) {
+    sampling_period = period;
+  };
+  /**
+   * \brief Set the maximum number of entries per category in the report
+   */
+  static void SetRows(const size_t _rows) { rows = _rows; };
+
+  /**
+   * \brief Discard the results of the previous run
+   *
+   * Must be called by the master thread before the worker threads start.
+   */
+  static void BeginRun();
+  static void BeginThread();
+  static void BeginTrack();
+  static void Step(const G4Step *step);
+  /**
+   * \brief Add the results of the calling thread to the results of the run
+   */
+  static void EndThread();
+  /**
+   * \brief Print the results of the run
+   *
+   * Must be called by the master thread after all worker threads have
+   * finished.
+   */
+  static void Report();
+
+private:
+  struct Stats {
+    uint64_t n_steps = 0;
+    double length = 0.;
+    double cpu_time = 0.;
+
+    void Add(const double _length, const double _cpu_time) {
+      ++n_steps;
+      length += _length;
+      cpu_time += _cpu_time;
+    };
+    void Add(const Stats &stats) {
+      n_steps += stats.n_steps;
+      length += stats.length;
+      cpu_time += stats.cpu_time;
+    };
+  };
+
+  struct ThreadData {
+    unordered_map<const G4LogicalVolume *, Stats> volumes;
+    unordered_map<const G4ParticleDefinition *, Stats> particles;
+    unordered_map<const G4VProcess *, Stats> processes;
+    uint32_t countdown = 1;
+    // CPU time in seconds at the end of the step before a sampled step, or a
+    // negative value if the next step is not sampled.
+    double sample_start = -1.;
+  };
+
+  static double CpuTime();
+  static void Print(const string &category, const map<string, Stats> &stats);
+
+  inline static bool enabled = false;
+  inline static uint32_t sampling_period = 64;
+  inline static size_t rows = 20;
+
+  static G4ThreadLocal ThreadData *thread_data;
+
+  // Results of all threads, by name.
+  inline static mutex results_mutex;
+  inline static map<string, Stats> volumes;
+  inline static map<string, Stats> particles;
+  inline static map<string, Stats> processes;
+};
+
+/**
+ * \brief Run action that collects the results of the Profiler
+ */
+class ProfilerRunAction : public G4UserRunAction {
+public:
+  void BeginOfRunAction(const G4Run *) override;
+  void EndOfRunAction(const G4Run *) override;
+};
+
+class ProfilerTrackingAction : public G4UserTrackingAction {
+public:
+  void PreUserTrackingAction(const G4Track *) override {
+    Profiler::BeginTrack();
+  };
+};
+
+class ProfilerSteppingAction : public G4UserSteppingAction {
+public:
+  void UserSteppingAction(const G4Step *step) override {
+    Profiler::Step(step);
+  };
+};
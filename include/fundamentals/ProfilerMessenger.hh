@@ -16,20 +16,25 @@
 
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
+
 #pragma once
 
-#include "DetectorHit.hh"
-#include "NSensitiveDetector.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIdirectory.hh"
+#include "G4UImessenger.hh"
 
-class SensitiveDetector : public NSensitiveDetector {
+/**
+ * \brief Macro commands in /nutr/profiler/ to configure the Profiler
+ */
+class ProfilerMessenger : public G4UImessenger {
 public:
-  SensitiveDetector(const string &name, const string &hitsCollectionName)
-      : NSensitiveDetector(name, hitsCollectionName),
-        fDetectorHitsCollection(nullptr){};
-
-  void Initialize(G4HCofThisEvent *hce) override final;
-  G4bool ProcessHits(G4Step *step, G4TouchableHistory *history) override final;
-
-protected:
-  G4THitsCollection<DetectorHit> *fDetectorHitsCollection;
+  ProfilerMessenger();
+  void SetNewValue(G4UIcommand *command, G4String str) override;
+
+private:
+  G4UIdirectory dir;
+  G4UIcmdWithABool cmd_enable;
+  G4UIcmdWithAnInteger cmd_sampling;
+  G4UIcmdWithAnInteger cmd_rows;
 };
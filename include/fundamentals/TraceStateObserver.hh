@@ -0,0 +1,55 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+
+#include "G4VStateDependent.hh"
+#include "globals.hh"
+
+/**
+ * \brief Record the phases of the application state of a thread as spans of
+ * the Trace
+ *
+ * The first Init state of a thread is recorded as 'initialization', which
+ * includes the construction of the geometry and the physics list.
+ * Each run passes through the Init state again, where the physics tables are
+ * built and the geometry is optimized, which is recorded as 'run
+ * initialization'.
+ * The 'run' span lasts from the closing of the geometry until the run has
+ * ended.
+ * At the end of each run, the master thread writes the timeline and discards
+ * the spans of all threads.
+ * If the timeline cannot be written, a warning is printed.
+ *
+ * An instance must be created by each thread, and it is deleted by the
+ * G4StateManager of the thread.
+ */
+class TraceStateObserver : public G4VStateDependent {
+public:
+  TraceStateObserver();
+  G4bool Notify(G4ApplicationState requested_state) override;
+
+private:
+  G4ApplicationState state;
+  bool initialized;
+  int64_t init_start;
+  int64_t run_start;
+};
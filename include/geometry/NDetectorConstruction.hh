@@ -23,6 +23,7 @@
 #include <string>
 #include <vector>
 
+using std::shared_ptr;
 using std::string;
 using std::unique_ptr;
 using std::vector;
@@ -39,10 +40,33 @@ class NDetectorConstructionMessenger;
 
 #include "SourceVolume.hh"
 
+/**
+ * \brief Sensitive detectors that belong to the same physical detector
+ *
+ * For example, the four crystals of a clover detector.
+ */
+struct DetectorGroup {
+  string name;
+  vector<size_t> detector_ids;
+};
+
 class NDetectorConstruction : public G4VUserDetectorConstruction {
 public:
   NDetectorConstruction();
   virtual G4VPhysicalVolume *Construct() override = 0;
+  /**
+   * \brief Attach sensitive detectors to the sensitive logical volumes
+   *
+   * By default, each sensitive logical volume gets its own sensitive detector
+   * and hits collection.
+   * In multiplexed mode (see /nutr/multiplex_sd), a single sensitive detector
+   * per back-end is attached to all of them, which determines the detector ID
+   * of each step from its logical volume, and all hits of an event are stored
+   * in a single collection.
+   * The sensitive detectors are created by the back-ends that are assigned to
+   * the logical volumes (see Backends). Logical volumes without a back-end do
+   * not get a sensitive detector.
+   */
   void ConstructSDandField() override final;
   void ConstructBoxWorld(const double x, const double y, const double z,
                          const string material = "G4_AIR");
@@ -52,11 +76,25 @@ public:
   size_t GetNumberOfSensitiveDetectors() const {
     return sensitive_logical_volumes.size();
   };
+  /**
+   * \brief Return groups of sensitive detectors
+   *
+   * Each call of RegisterSensitiveLogicalVolumes() defines a group that
+   * contains the given logical volumes.
+   * The name of the group is the common prefix of the names of the logical
+   * volumes, without trailing underscores.
+   */
+  const vector<DetectorGroup> &GetDetectorGroups() const {
+    return detector_groups;
+  };
   vector<shared_ptr<SourceVolume>> GetSourceVolumes() { return source_volumes; }
 
   void set_molly_x(const double x) { molly_x = x; }
   void set_zero_degree_x(const double x) { zero_degree_x = x; }
   void set_zero_degree_y(const double y) { zero_degree_y = y; }
+  void set_multiplex_sensitive_detectors(const bool multiplex) {
+    multiplex_sensitive_detectors = multiplex;
+  }
 
 protected:
   G4VSolid *world_solid;
@@ -66,7 +104,9 @@ protected:
   NDetectorConstructionMessenger *messenger;
 
   vector<G4LogicalVolume *> sensitive_logical_volumes;
+  vector<DetectorGroup> detector_groups;
   vector<shared_ptr<SourceVolume>> source_volumes;
 
   double molly_x, zero_degree_x, zero_degree_y;
+  bool multiplex_sensitive_detectors;
 };
@@ -40,4 +40,5 @@ protected:
   G4UIcmdWithABool *molly_in_out_cmd;
   G4UIcmdWithABool *zero_degree_in_out_cmd;
   G4UIcmdWithADoubleAndUnit *zero_degree_y_cmd;
+  G4UIcmdWithABool *multiplex_sd_cmd;
 };
\ No newline at end of file
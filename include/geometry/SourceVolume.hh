@@ -19,35 +19,57 @@
 
 #pragma once
 
-#include <memory>
 #include <random>
-#include <vector>
 
 using std::mt19937;
-using std::shared_ptr;
 using std::uniform_real_distribution;
-using std::unique_ptr;
 
+#include "G4RotationMatrix.hh"
+#include "G4ThreeVector.hh"
 #include "G4VPhysicalVolume.hh"
-#include "G4VSolid.hh"
 
+/**
+ * \brief Volume from which primary particles are emitted
+ *
+ * Implementations sample a position in the local coordinate system of their
+ * solid, and convert it to global coordinates with the transformation of the
+ * placement.
+ * The placement is assumed to be a daughter of the world volume.
+ * All geometry constants are precomputed at construction, so sampling does
+ * not query the geometry.
+ * The solid and the physical volume are owned by the Geant4 geometry stores.
+ */
 class SourceVolume {
 public:
-  SourceVolume(G4VSolid *solid, G4VPhysicalVolume *physical,
-               const double rel_int);
+  /**
+   * \param physical Placement of the volume, or nullptr if positions are
+   * sampled in global coordinates.
+   * \param rel_int Relative intensity with respect to other source volumes.
+   */
+  SourceVolume(const G4VPhysicalVolume *physical, const double rel_int);
+  virtual ~SourceVolume() = default;
 
-  virtual G4ThreeVector operator()() = 0;
+  /**
+   * \brief Sample a position in the volume
+   *
+   * Source volumes are shared by all threads, so sampling must not change
+   * them, and each thread provides its own random number engine.
+   */
+  virtual G4ThreeVector operator()(mt19937 &random_engine) const = 0;
   double get_relative_intensity() const { return relative_intensity; }
-  void initialize(const int seed);
 
 protected:
-  shared_ptr<G4VSolid> source_solid;
-  unique_ptr<G4VPhysicalVolume> source_physical;
-
-  mt19937 random_engine; /**< Deterministic random number engine. */
-  uniform_real_distribution<double>
-      uniform_random; /**< Uniform distribution from which all random numbers
-                         are sampled here. */
+  static double uniform_random(mt19937 &random_engine) {
+    return uniform_real_distribution<double>(0., 1.)(random_engine);
+  }
+  G4ThreeVector to_global(const G4ThreeVector &local) const {
+    return (is_rotated ? rotation * local : local) + translation;
+  }
 
   const double relative_intensity;
+
+private:
+  G4RotationMatrix rotation; /**< Rotation of the solid in the world. */
+  G4ThreeVector translation;
+  bool is_rotated;
 };
@@ -17,20 +17,19 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include "DetectorHit.hh"
+#pragma once
 
-G4ThreadLocal G4Allocator<DetectorHit> *DetectorHitAllocator = 0;
+#include "G4Box.hh"
 
-DetectorHit::DetectorHit() : NDetectorHit(), fEdep(0.) {}
+#include "SourceVolume.hh"
 
-DetectorHit::DetectorHit(const DetectorHit &right) : NDetectorHit() {
-  fDetectorID = right.fDetectorID;
-  fEdep = right.fEdep;
-}
+class SourceVolumeBox : public SourceVolume {
+public:
+  SourceVolumeBox(const G4Box *box, const G4VPhysicalVolume *physical,
+                  const double rel_int);
 
-const DetectorHit &DetectorHit::operator=(const DetectorHit &right) {
-  fDetectorID = right.fDetectorID;
-  fEdep = right.fEdep;
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
 
-  return *this;
-}
\ No newline at end of file
+private:
+  G4ThreeVector half_lengths;
+};
@@ -0,0 +1,82 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <random>
+#include <utility>
+
+using std::mt19937;
+using std::pair;
+
+#include "G4Cons.hh"
+
+#include "SourceVolume.hh"
+
+/**
+ * \brief Hollow truncated cone between two planes of constant z
+ *
+ * The inner and outer radius change linearly between the planes.
+ * The cross section at a given z is a quadratic function of z.
+ * z is sampled from it by rejection with a constant envelope, which accepts at
+ * least one in four samples, and r^2 is sampled uniformly between the radii
+ * at z.
+ */
+class ConeSection {
+public:
+  ConeSection(const double z_1, const double inner_radius_1,
+              const double outer_radius_1, const double z_2,
+              const double inner_radius_2, const double outer_radius_2);
+
+  /**
+   * \brief Volume of the section if it extends over an azimuthal angle
+   * delta_phi
+   */
+  double volume(const double delta_phi) const;
+  /**
+   * \return Radius and z coordinate of a random point.
+   */
+  pair<double, double> sample_r_z(mt19937 &random_engine) const;
+
+private:
+  /**
+   * \brief Cross section, divided by half the azimuthal angle, at the
+   * relative position t in [0, 1] between the two planes
+   */
+  double cross_section(const double t) const { return a + t * (b + t * c); }
+
+  double z_1, delta_z;
+  double inner_radius_1, delta_inner_radius;
+  double outer_radius_1, delta_outer_radius;
+  double a, b, c; /**< Coefficients of the cross section. */
+  double max_cross_section;
+};
+
+class SourceVolumeCons : public SourceVolume {
+public:
+  SourceVolumeCons(const G4Cons *cons, const G4VPhysicalVolume *physical,
+                   const double rel_int);
+
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+
+private:
+  ConeSection section;
+  double start_phi;
+  double delta_phi;
+};
@@ -0,0 +1,41 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <memory>
+
+using std::shared_ptr;
+
+#include "G4VPhysicalVolume.hh"
+
+#include "SourceVolume.hh"
+
+/**
+ * \brief Create a source volume for any placement
+ *
+ * Selects the exact sampler for the solid of the placement if it exists,
+ * and SourceVolumeSolid otherwise.
+ * This makes any volume of a geometry a possible source.
+ */
+class SourceVolumeFactory {
+public:
+  static shared_ptr<SourceVolume> create(const G4VPhysicalVolume *physical,
+                                         const double rel_int);
+};
@@ -0,0 +1,56 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <vector>
+
+using std::vector;
+
+#include "G4Polycone.hh"
+
+#include "AliasTable.hh"
+#include "SourceVolume.hh"
+#include "SourceVolumeCons.hh"
+
+/**
+ * \brief Polycone that is defined by z planes
+ *
+ * Each pair of adjacent z planes bounds a cone section.
+ * A section is selected with an alias table according to its volume, and a
+ * position is sampled in it like in SourceVolumeCons.
+ */
+class SourceVolumePolycone : public SourceVolume {
+public:
+  /**
+   * \throw runtime_error if the polycone was defined by its (r, z) corners
+   * and Geant4 could not convert them to z planes.
+   * SourceVolumeSolid can sample such a polycone.
+   */
+  SourceVolumePolycone(const G4Polycone *polycone,
+                       const G4VPhysicalVolume *physical, const double rel_int);
+
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+
+private:
+  vector<ConeSection> sections;
+  AliasTable section_selection;
+  double start_phi;
+  double delta_phi;
+};
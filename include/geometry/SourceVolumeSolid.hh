@@ -0,0 +1,58 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include "G4VSolid.hh"
+
+#include "SourceVolume.hh"
+
+/**
+ * \brief Arbitrary solid, sampled by rejection from its bounding box
+ *
+ * The acceptance probability is estimated once at construction.
+ * A warning is printed if it is low, in which case an exact sampler for the
+ * shape would be much faster.
+ */
+class SourceVolumeSolid : public SourceVolume {
+public:
+  /**
+   * \throw runtime_error if no random point in the bounding box is inside the
+   * solid.
+   */
+  SourceVolumeSolid(const G4VSolid *solid, const G4VPhysicalVolume *physical,
+                    const double rel_int);
+
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+  double get_acceptance() const { return acceptance; }
+
+private:
+  G4ThreeVector sample_bounding_box(mt19937 &random_engine) const;
+
+  static constexpr size_t n_acceptance_samples = 10000;
+  static constexpr double min_acceptance = 0.01;
+
+  const G4VSolid *solid;
+  G4ThreeVector box_min; /**< Lower corner of the bounding box. */
+  G4ThreeVector box_size;
+  double acceptance; /**< Estimated fraction of the bounding box that is
+                        inside the solid. */
+  size_t max_trials; /**< Limit for the number of trials per sample, which is
+                        only reached if the estimated acceptance is wrong. */
+};
@@ -0,0 +1,44 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include "G4Sphere.hh"
+
+#include "SourceVolume.hh"
+
+/**
+ * \brief Spherical shell section, sampled with uniform distributions in r^3,
+ * cos(theta), and phi
+ */
+class SourceVolumeSphere : public SourceVolume {
+public:
+  SourceVolumeSphere(const G4Sphere *sphere, const G4VPhysicalVolume *physical,
+                     const double rel_int);
+
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+
+private:
+  double inner_radius_cubed;
+  double delta_radius_cubed;
+  double start_phi;
+  double delta_phi;
+  double start_cos_theta;
+  double delta_cos_theta;
+};
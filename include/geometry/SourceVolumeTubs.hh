@@ -25,8 +25,15 @@
 
 class SourceVolumeTubs : public SourceVolume {
 public:
-  SourceVolumeTubs(G4Tubs *tubs, G4VPhysicalVolume *physical,
+  SourceVolumeTubs(const G4Tubs *tubs, const G4VPhysicalVolume *physical,
                    const double rel_int);
 
-  G4ThreeVector operator()() override final;
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+
+private:
+  double outer_radius;
+  double min_r; /**< Squared ratio of the inner and the outer radius. */
+  double start_phi;
+  double delta_phi;
+  double z_half_length;
 };
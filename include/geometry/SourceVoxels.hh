@@ -0,0 +1,86 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::map;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+#include "G4ThreeVector.hh"
+
+#include "AliasTable.hh"
+#include "SourceVolume.hh"
+
+/**
+ * \brief Source that consists of many voxels with individual activities
+ *
+ * Represents a voxelized target or an imported activity map.
+ * A voxel is selected with an alias table, so the cost of a sample does not
+ * depend on the number of voxels, and the position is sampled uniformly
+ * inside the box of the voxel.
+ * The relative intensity of the source is the sum of the activities of its
+ * voxels.
+ */
+class SourceVoxels : public SourceVolume {
+public:
+  struct Voxel {
+    G4ThreeVector center; /**< Center in global coordinates. */
+    double activity;
+  };
+
+  /**
+   * \param voxels Voxels with non-negative activities, at least one of which
+   * must be positive.
+   * \param voxel_size Edge lengths of all voxels.
+   */
+  SourceVoxels(const vector<Voxel> &voxels, const G4ThreeVector &voxel_size);
+
+  /**
+   * \brief Read an activity map and share it between threads
+   *
+   * Each line of the text file contains the center of a voxel in global
+   * coordinates in mm and its activity, separated by whitespace.
+   * Empty lines and lines that start with '#' are ignored.
+   * Each file is only read once per voxel size, by the first thread that
+   * requests it.
+   */
+  static shared_ptr<SourceVoxels> load(const string &file_name,
+                                       const G4ThreeVector &voxel_size);
+
+  G4ThreeVector operator()(mt19937 &random_engine) const override final;
+  size_t size() const { return centers.size(); }
+
+private:
+  vector<G4ThreeVector> centers;
+  G4ThreeVector voxel_size;
+  AliasTable voxel_selection;
+
+  inline static mutex maps_mutex;
+  inline static map<string, shared_ptr<SourceVoxels>>
+      maps; /**< Activity maps by file name and voxel size. */
+};
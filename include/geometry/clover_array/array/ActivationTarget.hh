@@ -19,8 +19,16 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
+using std::shared_ptr;
+using std::vector;
+
 #include "G4LogicalVolume.hh"
 
+#include "SourceVolume.hh"
+
 /**
  * @brief Target holder for photoactivation experiments.
  *
@@ -53,6 +61,18 @@ public:
       : world_logical(_world_logical) {}
   void Construct(const G4ThreeVector global_coordinates);
 
+  /**
+   * \brief Cavity of the capsule as a source volume
+   *
+   * The cavity contains the activated targets, whose shape is not known, so
+   * the activity is distributed uniformly over the whole cavity.
+   * The walls of the capsule are not sources.
+   */
+  vector<shared_ptr<SourceVolume>> get_source_volumes() {
+    return source_volumes;
+  }
+
 protected:
   G4LogicalVolume *world_logical;
+  vector<shared_ptr<SourceVolume>> source_volumes;
 };
\ No newline at end of file
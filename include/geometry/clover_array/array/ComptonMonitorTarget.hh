@@ -19,9 +19,13 @@
 
 #pragma once
 
+#include <memory>
+
 #include "G4LogicalVolume.hh"
 #include "G4VPhysicalVolume.hh"
 
+#include "SourceVolume.hh"
+
 /**
  * \brief Copper scattering target for the Compton beam monitor.
  */
@@ -34,6 +38,9 @@ public:
   static constexpr double scattering_target_width = 60. * mm;   // Estimated
   static constexpr double scattering_target_thickness = 0.988 * mm;
 
+  std::shared_ptr<SourceVolume> get_source_volume() { return source_volume; }
+
 protected:
   G4LogicalVolume *world_logical;
+  std::shared_ptr<SourceVolume> source_volume;
 };
\ No newline at end of file
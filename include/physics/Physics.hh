@@ -45,5 +45,7 @@ class Physics : public G4VModularPhysicsList {
 public:
   Physics(); /**< Constructor */
 
+  void ConstructProcess() override;
+
   void SetCuts() override;
 };
@@ -0,0 +1,58 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+using std::array;
+using std::vector;
+
+/**
+ * \brief Block of pre-generated primary cascades of a thread
+ *
+ * Source positions and the directions of all steps of a cascade are generated
+ * for many events at once and stored as a structure of arrays.
+ * In this layout, the conversion of the angles of the rejection sampler to
+ * directions is a simple loop over contiguous arrays, which the compiler can
+ * vectorize.
+ */
+struct CascadeBatch {
+  /**
+   * \brief Allocate the arrays for a number of events and steps
+   */
+  void resize(const size_t _size, const size_t n_steps);
+  /**
+   * \brief Convert the angles of a step to directions
+   *
+   * Reads angles[step] and writes directions[step].
+   */
+  void angles_to_directions(const size_t step);
+  bool is_exhausted() const { return next == size; }
+
+  size_t size = 0;
+  size_t next = 0; /**< Index of the next event. */
+  array<vector<double>, 3> positions; /**< x, y, and z of each event. */
+  vector<array<vector<double>, 3>>
+      directions; /**< x, y, and z of each event, for each step. */
+  vector<array<vector<double>, 2>>
+      angles; /**< theta and phi of each event, for each step. */
+};
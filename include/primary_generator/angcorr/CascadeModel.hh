@@ -0,0 +1,102 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::map;
+using std::mutex;
+using std::pair;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+#include "AngularCorrelation.hh"
+
+class CascadeTables;
+
+/**
+ * \brief Angular correlations of a cascade, which are shared by all threads
+ *
+ * The macro command /alpaca/cascade is executed by each worker thread.
+ * To avoid that every thread parses the cascade, builds its angular
+ * correlations, and precomputes sampling tables, the first thread that
+ * requests a cascade does this for all of them, and the other threads wait
+ * for it and share the result.
+ * A model is immutable after it has been built, except for the tables, which
+ * are built on demand under a lock.
+ * Only samplers, which contain the state of a random number engine, are
+ * created per thread.
+ */
+class CascadeModel {
+public:
+  /**
+   * \brief Return the model of a cascade and build it if it does not exist
+   *
+   * \param cascade String representation of the cascade as given to
+   * /alpaca/cascade.
+   * \param use_tables Whether the caller samples the cascade with tables.
+   * If not, the report of a new model suggests the table sampler if the
+   * rejection sampler is inefficient.
+   */
+  static shared_ptr<const CascadeModel> get(const string &cascade,
+                                            const bool use_tables);
+
+  size_t size() const { return angular_correlations.size(); }
+  const vector<AngularCorrelation> &get_angular_correlations() const {
+    return angular_correlations;
+  }
+  /**
+   * \brief Return a string that uniquely identifies the cascade
+   *
+   * Contains the states and the multipole mixing ratios with full precision.
+   */
+  const string &get_key() const { return key; }
+  /**
+   * \brief Return sampling tables and build them if they do not exist
+   *
+   * See CascadeTables::load_or_build.
+   */
+  shared_ptr<const CascadeTables>
+  get_tables(const size_t n_bins_cos_theta,
+             const string &cache_directory) const;
+
+private:
+  CascadeModel(const vector<State> &states, const vector<double> &deltas);
+
+  void report(const bool use_tables) const;
+
+  vector<AngularCorrelation> angular_correlations;
+  string key;
+  string description; /**< Human-readable representation of the cascade. */
+
+  mutable mutex tables_mutex;
+  mutable map<size_t, shared_ptr<const CascadeTables>>
+      tables; /**< Sampling tables by the number of bins in cos(theta). */
+
+  inline static mutex models_mutex;
+  inline static map<string, shared_ptr<const CascadeModel>>
+      models; /**< Models by their key. */
+};
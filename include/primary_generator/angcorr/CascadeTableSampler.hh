@@ -0,0 +1,153 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::array;
+using std::mt19937;
+using std::shared_ptr;
+using std::string;
+using std::uniform_real_distribution;
+using std::vector;
+
+#include "AliasTable.hh"
+#include "CascadeBatch.hh"
+
+class AngularCorrelation;
+
+/**
+ * \brief Precomputed sampling tables for the angular correlations of a
+ * cascade
+ *
+ * For each step of the cascade, the angular correlation W(theta, phi) is
+ * evaluated at the centers of n_cos_theta x n_phi cells of equal solid angle,
+ * which are equidistant in cos(theta) and phi.
+ * An alias table selects a cell with a probability proportional to its value
+ * of W.
+ * Inside the cell, the direction is distributed uniformly, so the sampled
+ * distribution approximates W by its values at the cell centers.
+ *
+ * Building the tables requires n_cos_theta x n_phi evaluations of W per step.
+ * Therefore, they can be cached in a file whose name is derived from a key
+ * that identifies the cascade.
+ */
+class CascadeTables {
+public:
+  /**
+   * \brief Read the tables from the cache, or build them and write them to it
+   *
+   * \param cascade Angular correlations of the cascade.
+   * \param key String that uniquely identifies the cascade, including the
+   * multipole mixing ratios.
+   * \param n_bins_cos_theta Number of bins in cos(theta). The number of bins
+   * in phi is twice as large.
+   * \param cache_directory Directory of the cache files. An empty string
+   * disables the cache.
+   */
+  static shared_ptr<const CascadeTables>
+  load_or_build(const vector<AngularCorrelation> &cascade, const string &key,
+                const size_t n_bins_cos_theta, const string &cache_directory);
+
+  size_t size() const { return cells.size(); }
+  size_t get_n_bins_cos_theta() const { return n_bins_cos_theta; }
+  size_t get_n_bins_phi() const { return n_bins_phi; }
+  const AliasTable &get_cells(const size_t step) const { return cells[step]; }
+  /**
+   * \brief Return true if the tables were read from the cache
+   */
+  bool is_from_cache() const { return from_cache; }
+
+private:
+  CascadeTables(const size_t _n_bins_cos_theta)
+      : n_bins_cos_theta(_n_bins_cos_theta),
+        n_bins_phi(2 * _n_bins_cos_theta){};
+
+  bool read(const string &file_name, const string &key, const size_t n_steps);
+  void write(const string &file_name, const string &key) const;
+
+  size_t n_bins_cos_theta;
+  size_t n_bins_phi;
+  bool from_cache = false;
+  vector<AliasTable> cells; /**< Cells of each step, with the index
+                               i_cos_theta * n_bins_phi + i_phi. */
+};
+
+/**
+ * \brief Sample the directions of a cascade from CascadeTables
+ *
+ * The drop-in replacement for alpaca's CascadeRejectionSampler with a
+ * constant cost per event.
+ * The first step is sampled in the laboratory frame, with the beam along the
+ * z axis and its polarization along the x axis.
+ * Each further step is sampled in the frame of the previous photon, which is
+ * the laboratory frame rotated by phi around the z axis and then by theta
+ * around the new y axis.
+ * The directions of all steps are returned in the laboratory frame.
+ */
+class CascadeTableSampler {
+public:
+  CascadeTableSampler(shared_ptr<const CascadeTables> tables, const int seed);
+
+  vector<array<double, 2>> operator()();
+  /**
+   * \brief Sample the directions of all events of a batch
+   *
+   * The directions are written in Cartesian coordinates, which avoids the
+   * conversion to angles and back.
+   */
+  void fill(CascadeBatch &batch);
+
+private:
+  /**
+   * \brief Columns of the rotation from a frame to the laboratory frame
+   */
+  using Frame = array<array<double, 3>, 3>;
+  static constexpr Frame lab_frame{
+      {{1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}}};
+
+  /**
+   * \brief Sample the direction of a step and rotate the frame to it
+   *
+   * \return Direction in the laboratory frame.
+   */
+  const array<double, 3> &next_direction(Frame &frame, const size_t step);
+
+  shared_ptr<const CascadeTables> tables;
+
+  mt19937 random_engine; /**< Deterministic random number engine. */
+  uniform_real_distribution<double>
+      uniform_random; /**< Uniform distribution from which all random numbers
+                         are sampled here. */
+};
+
+/**
+ * \brief Estimate the probability that rejection sampling accepts a direction
+ *
+ * Ratio of the average of W over the sphere and the upper limit of W that a
+ * rejection sampler uses.
+ * The average number of evaluations of W per sampled direction is the
+ * inverse of this value.
+ */
+double rejection_efficiency(const AngularCorrelation &angular_correlation);
@@ -22,21 +22,29 @@
 #include <functional>
 #include <memory>
 #include <random>
+#include <string>
 #include <string_view>
 #include <vector>
 
 using std::shared_ptr;
+using std::string;
 using std::uniform_real_distribution;
 using std::unique_ptr;
 using std::vector;
 
+#include "G4ThreeVector.hh"
 #include "G4VUserPrimaryGeneratorAction.hh"
+
+#include "AliasTable.hh"
+#include "CascadeBatch.hh"
 #include "PrimaryGeneratorMessenger.hh"
 
 class PrimaryGeneratorMessenger;
 class G4ParticleGun;
 class SourceVolume;
+class CascadeModel;
 class CascadeRejectionSampler;
+class CascadeTableSampler;
 class AngularCorrelation;
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction {
@@ -49,21 +57,58 @@ public:
   void set_energies(const std::string &);
   void set_particle(const std::string &);
   void set_force_point_source(bool);
+  void set_sampler(const std::string &);
+  void set_table_bins(int);
+  void set_table_cache(const std::string &);
+  void set_batch_size(int);
+  /**
+   * \brief Replace the source volumes of the geometry by an activity map
+   *
+   * See SourceVoxels::load.
+   * An empty file name restores the source volumes of the geometry.
+   */
+  void set_activity_map(const std::string &);
+  void set_activity_map_voxel(const G4ThreeVector &);
 
 private:
-  void normalize_intensities();
+  void initialize_sources();
+  void initialize_sampler();
+  /**
+   * \brief Reseed the random number engines for a segment of a resumed run
+   *
+   * See Checkpoint::SegmentSeed.
+   */
+  void seed_engines(const int segment);
+  /**
+   * \brief Select a source volume and sample a position in it
+   *
+   * The position is not changed if no source volume was selected.
+   */
+  void sample_position(G4ThreeVector &position);
+  void fill_batch();
 
   unique_ptr<G4ParticleGun> particle_gun;
   unique_ptr<CascadeRejectionSampler> cas_rej_sam;
+  unique_ptr<CascadeTableSampler> cas_tab_sam;
   vector<double> cascade_energies;
-  vector<AngularCorrelation> cascade;
+  shared_ptr<const CascadeModel> cascade; /**< Shared by all threads. */
+  bool use_tables;
+  size_t table_bins;
+  string table_cache;
   bool force_point_source;
+  size_t batch_size; /**< Number of events per batch, or 1 to sample each
+                        event on its own. */
+  CascadeBatch batch;
 
   vector<shared_ptr<SourceVolume>> source_volumes;
-  vector<double> relative_intensities_normalized;
+  AliasTable source_selection; /**< Selects a source volume according to its
+                                  relative intensity. */
+  G4ThreeVector activity_map_voxel;
 
   PrimaryGeneratorMessenger messenger;
 
+  const long thread_seed; /**< Seed of the thread in the first segment. */
+  int seed_segment; /**< Segment for which the engines were seeded. */
   long random_number_seed;
   std::mt19937 random_engine; /**< Deterministic random number engine. */
   uniform_real_distribution<double>
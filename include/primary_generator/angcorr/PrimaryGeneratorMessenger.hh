@@ -19,8 +19,10 @@
 
 #pragma once
 
+#include "G4UIcmdWith3VectorAndUnit.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAnInteger.hh"
 #include "G4UIdirectory.hh"
 #include "G4UImessenger.hh"
 
@@ -38,4 +40,10 @@ private:
   G4UIcmdWithAString cmd_energies;
   G4UIcmdWithAString cmd_particle;
   G4UIcmdWithABool cmd_point_source;
+  G4UIcmdWithAString cmd_sampler;
+  G4UIcmdWithAnInteger cmd_table_bins;
+  G4UIcmdWithAString cmd_table_cache;
+  G4UIcmdWithAnInteger cmd_batch_size;
+  G4UIcmdWithAString cmd_activity_map;
+  G4UIcmdWith3VectorAndUnit cmd_activity_map_voxel;
 };
@@ -23,9 +23,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
+using std::map;
+using std::mutex;
 using std::string;
 using std::vector;
 
@@ -34,21 +40,179 @@ using std::vector;
 #include "G4VHit.hh"
 #include "globals.hh"
 
+#include "ColumnarWriter.hh"
+
+/**
+ * \brief Output formats supported by the AnalysisManager
+ *
+ * - geant4: Use the G4AnalysisManager, which determines the actual file format
+ * (ROOT, CSV, ...) from the suffix of the output file name.
+ * - ncol: Use the native columnar format of nutr (see ColumnarWriter).
+ */
+enum class OutputFormat { geant4, ncol };
+
+/**
+ * \brief Output file written by a single thread
+ */
+struct Shard {
+  string file_name;
+  int thread_id;
+  uint64_t n_rows;
+  uint64_t n_bytes;
+};
+
 class AnalysisManager {
 public:
   AnalysisManager();
   ~AnalysisManager();
 
-  void Book(string output_file_name);
-  [[maybe_unused]] virtual void
-  CreateNtupleColumns(G4AnalysisManager *analysisManager);
-  void FillNtuple(const G4Event *event, vector<G4VHit *> hits);
+  virtual void Book(string output_file_name);
+  [[maybe_unused]] virtual void CreateNtupleColumns();
+  void FillNtuple(const G4Event *event, const vector<G4VHit *> &hits);
   [[maybe_unused]] virtual size_t
-  FillNtupleColumns(G4AnalysisManager *analysisManager, const G4Event *event,
-                    vector<G4VHit *> hits);
-  void Save();
+  FillNtupleColumns(const G4Event *event, const vector<G4VHit *> &hits);
+  virtual void Save();
+  /**
+   * \brief Finish the output of a run after all threads have called Save()
+   *
+   * Must only be called by the master thread.
+   * Optionally merges the output files of all threads and writes a manifest
+   * '<name>_manifest.json' that lists all output files of the run.
+   */
+  void FinishRun(const int run_id);
+  /**
+   * \brief Flush the output of a thread to disk and write its checkpoint
+   *
+   * Does nothing if the output of the thread cannot be checkpointed, i.e. if
+   * the Geant4 analysis manager is used and its file is still open.
+   */
+  void WriteCheckpoint();
+  /**
+   * \brief Set the name of the back-end if several back-ends are combined
+   *
+   * The output file of a back-end is called NAME_BACKEND, where NAME is the
+   * output file name of the run. An empty name keeps the output file name of
+   * the run.
+   *
+   * \param first True for the first back-end of a run, which determines the
+   * output file name of the run and begins a new segment of the checkpoints
+   * (see Checkpoint::BeginSegment()).
+   */
+  void SetBackend(const string &name, const bool first) {
+    backend_name = name;
+    first_backend = first;
+  };
+  /**
+   * \brief Restrict the back-end to a subset of the sensitive detectors
+   *
+   * The energy depositions of all sensitive detectors are collected in the
+   * same array (see EnergyAccumulator), so a back-end that writes energy
+   * depositions must ignore the detectors of other back-ends.
+   * By default, a back-end uses all detectors.
+   *
+   * \param detector_ids IDs of the detectors.
+   * \param complement If true, the back-end uses all detectors except the
+   * given ones.
+   */
+  void SetBackendDetectors(const vector<size_t> &detector_ids,
+                           const bool complement);
+  bool UsesDetector(const size_t detector_id) const {
+    return std::binary_search(backend_detector_ids.begin(),
+                              backend_detector_ids.end(),
+                              detector_id) != backend_detectors_complement;
+  };
+  /**
+   * \brief Return the IDs of the detectors that the back-end uses, in
+   * ascending order
+   */
+  vector<size_t> GetBackendDetectors(const size_t n_detectors) const;
 
 protected:
-  string create_default_file_name() const;
+  string create_default_file_name(const string suffix) const;
+  string resolve_output_file_name(string output_file_name,
+                                  const string default_suffix);
+  string thread_local_file_name(const string file_name) const;
+  string shard_file_name(const size_t index) const;
+  void open_shard();
+  void close_shard();
+  void register_shard(const Shard &shard) const;
+
+  /**
+   * \brief Add a row after all of its columns have been filled
+   *
+   * \param end_of_event False if more rows of the same event follow. A shard
+   * is only closed at the end of an event, so the rows of an event are never
+   * distributed over several files.
+   */
+  void AddNtupleRow(const bool end_of_event = true);
+
+  void CreateNtuple(const string &name, const string &title);
+  void CreateNtupleIColumn(const string &name);
+  void CreateNtupleDColumn(const string &name);
+  void CreateNtupleFColumn(const string &name);
+  /**
+   * \brief Create vector-valued columns
+   *
+   * The G4AnalysisManager reads the values of a vector column directly from
+   * the given vector when a row is added, so the vector must outlive the
+   * ntuple.
+   * Vector columns are only supported by the ROOT format of Geant4.
+   */
+  void CreateNtupleIVColumn(const string &name, vector<int> &values);
+  void CreateNtupleDVColumn(const string &name, vector<double> &values);
+
+  void FillNtupleIColumn(const size_t col, const int value) {
+    if (output_format == OutputFormat::ncol) {
+      columnar_writer.FillI(col, value);
+    } else {
+      g4_analysis_manager->FillNtupleIColumn(0, col, value);
+    }
+  };
+  void FillNtupleDColumn(const size_t col, const double value) {
+    if (output_format == OutputFormat::ncol) {
+      columnar_writer.FillD(col, value);
+    } else {
+      g4_analysis_manager->FillNtupleDColumn(0, col, value);
+    }
+  };
+  void FillNtupleFColumn(const size_t col, const float value) {
+    if (output_format == OutputFormat::ncol) {
+      columnar_writer.FillF(col, value);
+    } else {
+      g4_analysis_manager->FillNtupleFColumn(0, col, value);
+    }
+  };
+  void FillNtupleDColumns(const size_t first_col, const double *values,
+                          const size_t n_values);
+  void FillNtupleIVColumn(const size_t col, const vector<int> &values) {
+    if (output_format == OutputFormat::ncol) {
+      columnar_writer.FillIV(col, values.data(), values.size());
+    }
+  };
+  void FillNtupleDVColumn(const size_t col, const vector<double> &values) {
+    if (output_format == OutputFormat::ncol) {
+      columnar_writer.FillDV(col, values.data(), values.size());
+    }
+  };
+
   G4bool fFactoryOn;
+  OutputFormat output_format;
+  G4AnalysisManager *g4_analysis_manager;
+  ColumnarWriter columnar_writer;
+  string ncol_file_name;
+  size_t shard_index;
+  uint64_t max_shard_size;
+  uint64_t n_rows;
+  vector<Shard> thread_shards;
+  string backend_name;
+  bool first_backend;
+  vector<size_t> backend_detector_ids; /**< Sorted. */
+  bool backend_detectors_complement;
+  // Output file name of the back-end in the current run.
+  string backend_file_name;
+
+  inline static string master_output_file_name = "";
+  inline static mutex shards_mutex;
+  // Output files of the current run, indexed by the name of the back-end.
+  inline static map<string, vector<Shard>> shards;
 };
@@ -0,0 +1,113 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#include "AnalysisManager.hh"
+#include "NEventAction.hh"
+#include "NSensitiveDetector.hh"
+
+/**
+ * \brief Sensitive-detector back-ends of a run
+ *
+ * All back-ends ('edep', 'event', 'flux', 'histogram', and 'tracker') are
+ * built into the same executable.
+ * By default, all sensitive detectors use the back-end that was selected with
+ * the SENSITIVE_DETECTOR_DIR build option.
+ * With the macro commands of the BackendsMessenger, a different back-end can
+ * be selected, or several back-ends can be combined, each of them for a
+ * different subset of the detectors.
+ * Each back-end writes its own output file, whose name is the output file
+ * name of the run with the name of the back-end appended if several back-ends
+ * are combined (see AnalysisManager::SetBackend()).
+ *
+ * The selection is read when the sensitive detectors and the user actions
+ * are constructed, so it must be made before the run manager is initialized.
+ */
+class Backends {
+public:
+  enum class Type { edep, event, flux, histogram, tracker };
+
+  struct Backend {
+    Type type;
+    string name;
+    // IDs of the detectors that use the back-end. An empty list selects all
+    // detectors that are not used by any other back-end.
+    vector<size_t> detector_ids;
+  };
+
+  /**
+   * \brief Add a back-end to the selection
+   *
+   * \param name Name of the back-end, i.e. the name of its directory in
+   * src/sensitive_detector.
+   * \param detector_ids IDs of the detectors that use the back-end, or an
+   * empty list for all remaining detectors.
+   */
+  static void Add(const string &name, const vector<size_t> &detector_ids);
+  static void Reset();
+  static void Print();
+
+  /**
+   * \brief Return the selected back-ends, or the default back-end for all
+   * detectors if none was selected
+   */
+  static vector<Backend> Get();
+  /**
+   * \brief Assign each detector to a back-end
+   *
+   * \return Index of the back-end in Get() for each detector, or -1 if no
+   * back-end is used for the detector.
+   */
+  static vector<int> Assign(const size_t n_detectors);
+
+  /**
+   * \brief Create the sensitive detector of a back-end
+   *
+   * \param index Index of the back-end in Get().
+   */
+  static NSensitiveDetector *CreateSensitiveDetector(const size_t index,
+                                                     const string &name);
+  /**
+   * \brief Create the analysis manager of a back-end
+   *
+   * \param index Index of the back-end in Get().
+   */
+  static AnalysisManager *CreateTupleManager(const size_t index);
+  /**
+   * \brief Create the event action of a back-end
+   *
+   * \param index Index of the back-end in Get().
+   * \param tuple_manager Analysis manager that was created by
+   * CreateTupleManager() for the same back-end.
+   */
+  static NEventAction *CreateEventAction(const size_t index,
+                                         AnalysisManager *tuple_manager);
+
+private:
+  static Type ParseType(const string &name);
+
+  inline static vector<Backend> backends;
+};
@@ -0,0 +1,40 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIdirectory.hh"
+#include "G4UImessenger.hh"
+
+/**
+ * \brief Macro commands in /nutr/backend/ to select the Backends of a run
+ */
+class BackendsMessenger : public G4UImessenger {
+public:
+  BackendsMessenger();
+  void SetNewValue(G4UIcommand *command, G4String str) override;
+
+private:
+  G4UIdirectory dir;
+  G4UIcmdWithAString cmd_add;
+  G4UIcmdWithoutParameter cmd_reset;
+  G4UIcmdWithoutParameter cmd_print;
+};
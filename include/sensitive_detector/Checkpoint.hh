@@ -0,0 +1,190 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::atomic;
+using std::string;
+using std::vector;
+
+#include "AnalysisManager.hh"
+
+/**
+ * \brief Checkpoints, resumption, and a wall-clock limit for long runs
+ *
+ * An interrupted run can be resumed if it has written checkpoints.
+ * Each thread that processes events periodically writes a checkpoint
+ * NAME_checkpoint_tN.txt, where NAME is the output file name without its
+ * suffix.
+ * It contains the number of completed events of the thread and its output
+ * files, together with the number of rows and bytes that contain these events.
+ * Before a checkpoint is written, the output is flushed to disk.
+ * The state of the random number engine of the thread is saved in
+ * NAME_checkpoint_tN.rndm.
+ * Periodic checkpoints require the native columnar output format, because the
+ * files of the Geant4 analysis manager are only valid after they were closed.
+ * Runs with other formats, or with the 'histogram' back-end, reject them.
+ * With any format, each thread writes a checkpoint at the end of a run.
+ * The master thread only writes one if it writes output files itself.
+ * Checkpoints are only written if a checkpoint interval or a wall-clock limit
+ * is set, or if a run is resumed.
+ *
+ * A run can be ended gracefully before all events are processed, either by a
+ * wall-clock limit or by the signal SIGTERM, which is sent by many batch
+ * systems before a job is pre-empted.
+ * All subsequent events are aborted, and the output files and checkpoints are
+ * closed regularly.
+ *
+ * A resumed run processes the missing events of the interrupted one.
+ * Its output files are called NAME_rK, where K counts the resumptions.
+ * The files of the interrupted run are truncated to the size given by the
+ * checkpoints, so they contain exactly the completed events, and they are
+ * listed in the manifest of the resumed run (see AnalysisManager::FinishRun).
+ * Event IDs of a resumed run are shifted to be unique.
+ * In a sequential application, the random number engine continues from the
+ * saved state.
+ * In a multithreaded application, the engines of the worker threads are
+ * reseeded by the master thread for each event, so the master engine is
+ * reseeded from the original seed and K.
+ * Primary generators with their own random number engines, like the angcorr
+ * generator, must reseed them with SegmentSeed() when K changes.
+ * Otherwise, a resumed run repeats the primaries of the interrupted one.
+ */
+class Checkpoint {
+public:
+  static void SetInterval(const double seconds) { interval = seconds; };
+  static void SetMaxWallclock(const double seconds) {
+    max_wallclock = seconds;
+  };
+  /**
+   * \brief Resume the interrupted run with the same output file name
+   *
+   * Only applies to the first run of the application.
+   */
+  static void SetResume(const bool _resume) { resume = _resume; };
+  static bool IsPeriodic() { return interval > 0.; };
+  static bool IsResuming() { return resume; };
+  /**
+   * \brief Return true if checkpoints are written
+   *
+   * Runs without a checkpoint interval, a wall-clock limit, or a resumption
+   * do not write any checkpoints.
+   */
+  static bool IsEnabled() {
+    return interval > 0. || max_wallclock > 0. || resume || segment > 0;
+  };
+  /**
+   * \brief End the current run gracefully on SIGTERM
+   */
+  static void InstallSignalHandler();
+  static void RequestStop() { stop_requested = true; };
+
+  /**
+   * \brief Prepare a run
+   *
+   * Must be called by the master thread before the output is booked.
+   */
+  static void BeginRun(const int n_events);
+  /**
+   * \brief Start a new segment of the output and resume a run if requested
+   *
+   * Must be called by the master thread with the output file name of the
+   * run.
+   *
+   * \return Output files of the interrupted run.
+   */
+  static vector<Shard> BeginSegment(const string &output_file_name);
+  /**
+   * \brief Return the name of an output file of the current segment
+   */
+  static string SegmentFileName(const string &file_name);
+  static int GetEventIDOffset() { return event_id_offset; };
+  /**
+   * \brief Return the index K of the current segment, 0 for a new run
+   */
+  static int GetSegment() { return segment; };
+  /**
+   * \brief Return a seed for a random number engine in the current segment
+   *
+   * For the first segment, the seed is returned unchanged. Otherwise, it is
+   * mixed with K in the same way as the seed of the master engine.
+   */
+  static long SegmentSeed(const long seed);
+  /**
+   * \brief Return the number of events that the current segment processes
+   *
+   * Less than the number of events of the run if the run was resumed.
+   */
+  static int64_t GetEventsRemaining() { return n_events_remaining; };
+
+  /**
+   * \brief Prepare a thread for a run
+   */
+  static void BeginThread();
+  /**
+   * \brief Decide whether the next event of a thread should be processed
+   *
+   * \return false if the run should be ended, because a wall-clock limit was
+   * reached, a stop was requested, or a resumed run has processed all missing
+   * events.
+   */
+  static bool ClaimEvent();
+  /**
+   * \brief Return true if a thread should write a periodic checkpoint
+   */
+  static bool IsDue();
+  /**
+   * \brief Write the checkpoint of a thread
+   *
+   * \param shards Output files of the thread in the current segment, with the
+   * number of rows and bytes that have been flushed to disk.
+   */
+  static void Write(const vector<Shard> &shards);
+
+private:
+  struct Record {
+    int segment = 0;
+    uint64_t n_events = 0;
+    int64_t n_event_ids = 0;
+    vector<Shard> shards;
+  };
+
+  static Record Read(const string &file_name);
+  static void Write(const string &file_name, const Record &record);
+  static string ThreadFileName(const string &suffix);
+  static vector<string> ThreadFileNames();
+
+  inline static double interval = 0.;
+  inline static double max_wallclock = 0.;
+  inline static bool resume = false;
+  inline static atomic<bool> stop_requested = false;
+  inline static atomic<bool> stop_reported = false;
+
+  inline static string base_name = "";
+  inline static int segment = 0;
+  inline static int event_id_offset = 0;
+  inline static int64_t n_events_requested = 0;
+  inline static int64_t n_events_remaining = 0;
+  inline static atomic<int64_t> n_events_claimed = 0;
+};
@@ -0,0 +1,48 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+namespace ncol {
+/**
+ * \brief Merge files in the nutr columnar format into a single file
+ *
+ * Since the chunks of a file are self-contained, they are copied to the output
+ * file without decompressing them.
+ * The position of each input file in the output file is known in advance, so
+ * the copies are done by several threads in parallel.
+ *
+ * \param input_file_names Names of the input files. All files must have the
+ * same column schema.
+ * \param output_file_name Name of the output file. It must not be one of the
+ * input files.
+ * \param n_threads Maximum number of threads.
+ *
+ * \return Number of rows in the output file.
+ */
+uint64_t merge(const vector<string> &input_file_names,
+               const string &output_file_name, const unsigned int n_threads);
+} // namespace ncol
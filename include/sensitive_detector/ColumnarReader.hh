@@ -0,0 +1,213 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+using std::span;
+using std::string;
+using std::vector;
+
+#include "ColumnarWriter.hh"
+
+namespace ncol {
+/**
+ * \brief Data of a vector column in a single chunk
+ *
+ * The values of row i are the lengths[i] values that follow the values of
+ * rows 0, ..., i-1.
+ */
+template <typename T> struct VectorColumnChunk {
+  span<const uint32_t> lengths;
+  span<const T> values;
+};
+} // namespace ncol
+
+/**
+ * \brief Reader for the nutr columnar output format
+ *
+ * The file is mapped into memory and only the column schema and the
+ * positions of the chunks are parsed on construction.
+ * Uncompressed column data are returned as views into the mapped file without
+ * any copy.
+ * Compressed column data are decompressed into a buffer per column that is
+ * owned by the reader and reused by subsequent calls, i.e. a view on
+ * compressed data is only valid until the next call of GetColumnChunk() for the
+ * same column.
+ */
+class ColumnarReader {
+public:
+  ColumnarReader(const string &file_name);
+  ~ColumnarReader();
+
+  ColumnarReader(const ColumnarReader &) = delete;
+  ColumnarReader &operator=(const ColumnarReader &) = delete;
+
+  size_t GetNumberOfColumns() const { return column_names.size(); };
+  string GetColumnName(const size_t col) const { return column_names[col]; };
+  ncol::ColumnType GetColumnType(const size_t col) const {
+    return column_types[col];
+  };
+  size_t GetColumnIndex(const string &name) const;
+
+  size_t GetNumberOfChunks() const { return chunks.size(); };
+  uint64_t GetNumberOfRows(const size_t chunk) const {
+    return chunks[chunk].n_rows;
+  };
+  uint64_t GetNumberOfRows() const;
+
+  bool HasSameSchema(const ColumnarReader &other) const {
+    return column_names == other.column_names &&
+           column_types == other.column_types;
+  };
+  /**
+   * \brief Return the header of the file, i.e. everything before the first
+   * chunk
+   */
+  span<const char> GetHeader() const { return {data, payload_begin}; };
+  /**
+   * \brief Return all complete chunks of the file as raw bytes
+   */
+  span<const char> GetPayload() const {
+    return {data + payload_begin, payload_end - payload_begin};
+  };
+
+  template <typename T>
+  span<const T> GetColumnChunk(const size_t col, const size_t chunk);
+
+  template <typename T>
+  ncol::VectorColumnChunk<T> GetVectorColumnChunk(const size_t col,
+                                                  const size_t chunk);
+
+  /**
+   * \brief Expand a zero-suppressed pair of vector columns into a dense table
+   *
+   * In a zero-suppressed record, each row contains only the indices of the
+   * non-zero entries in one vector column, and their values in another one.
+   * For example, the indices could be detector IDs and the values energy
+   * depositions.
+   *
+   * \param index_col Index of the IntVector column that contains the indices.
+   * \param value_col Index of the DoubleVector column that contains the
+   * values.
+   * \param n_indices Number of possible indices, i.e. the number of columns
+   * of the dense table.
+   *
+   * \return Dense table with n_indices values per row, in row-major order.
+   * Entries which are not contained in a row are zero.
+   */
+  vector<double> ExpandVectorColumns(const size_t index_col,
+                                     const size_t value_col,
+                                     const size_t n_indices);
+
+  /**
+   * \brief Read all values of a column into a vector
+   */
+  template <typename T> vector<T> ReadColumn(const size_t col) {
+    vector<T> values;
+    values.reserve(GetNumberOfRows());
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      const auto values_in_chunk = GetColumnChunk<T>(col, i);
+      values.insert(values.end(), values_in_chunk.begin(),
+                    values_in_chunk.end());
+    }
+    return values;
+  }
+
+private:
+  struct Chunk {
+    uint64_t n_rows;
+    vector<const char *> column_data;
+    vector<uint64_t> stored_sizes;
+    vector<uint64_t> raw_sizes;
+  };
+
+  void Parse();
+  const char *ColumnData(const size_t col, const size_t chunk,
+                         const ncol::ColumnType expected_type);
+  template <typename T>
+  ncol::VectorColumnChunk<T>
+  VectorColumnData(const size_t col, const size_t chunk,
+                   const ncol::ColumnType expected_type);
+
+  string file_name;
+  int file_descriptor;
+  const char *data;
+  size_t size;
+  size_t payload_begin;
+  size_t payload_end;
+
+  vector<string> column_names;
+  vector<ncol::ColumnType> column_types;
+  vector<Chunk> chunks;
+
+  vector<vector<char>> decompression_buffers;
+};
+
+template <>
+inline span<const int32_t> ColumnarReader::GetColumnChunk(const size_t col,
+                                                          const size_t chunk) {
+  return {reinterpret_cast<const int32_t *>(
+              ColumnData(col, chunk, ncol::ColumnType::Int)),
+          chunks[chunk].n_rows};
+}
+
+template <>
+inline span<const double> ColumnarReader::GetColumnChunk(const size_t col,
+                                                         const size_t chunk) {
+  return {reinterpret_cast<const double *>(
+              ColumnData(col, chunk, ncol::ColumnType::Double)),
+          chunks[chunk].n_rows};
+}
+
+template <>
+inline span<const float> ColumnarReader::GetColumnChunk(const size_t col,
+                                                        const size_t chunk) {
+  return {reinterpret_cast<const float *>(
+              ColumnData(col, chunk, ncol::ColumnType::Float)),
+          chunks[chunk].n_rows};
+}
+
+template <typename T>
+ncol::VectorColumnChunk<T>
+ColumnarReader::VectorColumnData(const size_t col, const size_t chunk,
+                                 const ncol::ColumnType expected_type) {
+  const char *column_data = ColumnData(col, chunk, expected_type);
+  const uint64_t n_rows = chunks[chunk].n_rows;
+  const size_t values_offset = ncol::padded_size(n_rows * sizeof(uint32_t));
+  return {{reinterpret_cast<const uint32_t *>(column_data), n_rows},
+          {reinterpret_cast<const T *>(column_data + values_offset),
+           (chunks[chunk].raw_sizes[col] - values_offset) / sizeof(T)}};
+}
+
+template <>
+inline ncol::VectorColumnChunk<int32_t>
+ColumnarReader::GetVectorColumnChunk(const size_t col, const size_t chunk) {
+  return VectorColumnData<int32_t>(col, chunk, ncol::ColumnType::IntVector);
+}
+
+template <>
+inline ncol::VectorColumnChunk<double>
+ColumnarReader::GetVectorColumnChunk(const size_t col, const size_t chunk) {
+  return VectorColumnData<double>(col, chunk, ncol::ColumnType::DoubleVector);
+}
@@ -0,0 +1,251 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::atomic;
+using std::exception_ptr;
+using std::string;
+using std::thread;
+using std::vector;
+
+/**
+ * \brief Layout of the nutr columnar output format ('.ncol')
+ *
+ * A file starts with a header that contains the magic string, the format
+ * version, and the column schema (type and name of each column).
+ * It is followed by an arbitrary number of self-contained chunks.
+ * Each chunk starts with a chunk header that contains the number of rows in
+ * the chunk and, for each column, the number of stored (possibly compressed)
+ * bytes and the number of raw bytes.
+ * The column data follow in the order of the schema.
+ * If the number of stored bytes equals the number of raw bytes, the data are
+ * stored uncompressed, otherwise they are zlib-compressed.
+ *
+ * Vector columns hold a variable number of values per row.
+ * Their raw data consist of the number of values in each row (uint32_t),
+ * followed by the values of all rows.
+ * Version 1 of the format did not have vector columns, and version 2 did not
+ * have single-precision floating-point columns.
+ *
+ * All numbers are stored in the byte order of the machine that wrote the file,
+ * and all blocks are padded to multiples of 8 bytes, so that uncompressed
+ * column data can be accessed in place after mapping the file into memory.
+ */
+namespace ncol {
+constexpr char magic[8] = {'N', 'U', 'T', 'R', 'C', 'O', 'L', '\0'};
+constexpr uint32_t version = 3;
+constexpr uint64_t chunk_magic = 0x4b4e484321434e4e; // "NNC!CHNK"
+constexpr size_t alignment = 8;
+
+enum class ColumnType : uint8_t {
+  Int = 0,
+  Double = 1,
+  IntVector = 2,
+  DoubleVector = 3,
+  Float = 4
+};
+
+/**
+ * \brief Size of a single value of a column type in bytes
+ */
+size_t column_type_size(const ColumnType type);
+bool is_vector(const ColumnType type);
+size_t padded_size(const size_t size);
+} // namespace ncol
+
+/**
+ * \brief Writer for the nutr columnar output format
+ *
+ * The writer keeps one typed buffer per column, which holds the values of a
+ * fixed number of rows (a 'chunk').
+ * Values are stored into the current row of the buffer without any lookup,
+ * and a full chunk is compressed column by column and written to the file at
+ * once.
+ * Cells which are not filled in a row are zero.
+ *
+ * Optionally, full chunks are handed over to a separate writer thread, which
+ * compresses and writes them while the calling thread continues to fill the
+ * next chunk.
+ * The chunks wait for the writer thread in a ring buffer with a fixed number
+ * of slots.
+ * The calling thread only blocks if all slots are occupied, i.e. if the writer
+ * thread cannot keep up with the filling on average.
+ * Since the buffers of a chunk are exchanged with those of a free slot, a
+ * hand-over does not copy any data.
+ *
+ * A ColumnarWriter is not thread safe.
+ * It is intended to be used by a single thread, i.e. each worker thread writes
+ * its own file.
+ */
+class ColumnarWriter {
+public:
+  ColumnarWriter();
+  ~ColumnarWriter();
+
+  size_t CreateColumn(const string &name, const ncol::ColumnType type);
+  void ResetColumns();
+  size_t GetNumberOfColumns() const { return column_names.size(); };
+  /**
+   * \brief Open a file and write the header
+   *
+   * \param n_queued_chunks Number of full chunks that can wait for a separate
+   * writer thread. If zero, full chunks are compressed and written by the
+   * thread that fills them.
+   */
+  void Open(const string &file_name, const size_t chunk_size,
+            const int compression_level, const size_t n_queued_chunks = 0);
+
+  void FillI(const size_t col, const int value) {
+    chunk.int_buffers[column_buffer_index[col]][n_rows_in_chunk] = value;
+  };
+  void FillD(const size_t col, const double value) {
+    chunk.double_buffers[column_buffer_index[col]][n_rows_in_chunk] = value;
+  };
+  void FillF(const size_t col, const float value) {
+    chunk.float_buffers[column_buffer_index[col]][n_rows_in_chunk] = value;
+  };
+  /**
+   * \brief Fill consecutive double-valued columns from an array
+   *
+   * \param first_col Index of the first column.
+   * \param values Pointer to the values.
+   * \param n_values Number of values. Columns first_col, ...,
+   * first_col + n_values - 1 must be double-valued.
+   */
+  void FillD(const size_t first_col, const double *values,
+             const size_t n_values);
+  /**
+   * \brief Fill a vector-valued column
+   *
+   * \param col Index of the column.
+   * \param values Pointer to the values.
+   * \param n_values Number of values in the current row.
+   */
+  void FillIV(const size_t col, const int *values, const size_t n_values) {
+    VectorBuffer &buffer = chunk.vector_buffers[column_buffer_index[col]];
+    buffer.lengths[n_rows_in_chunk] = static_cast<uint32_t>(n_values);
+    buffer.int_values.insert(buffer.int_values.end(), values,
+                             values + n_values);
+  };
+  void FillDV(const size_t col, const double *values, const size_t n_values) {
+    VectorBuffer &buffer = chunk.vector_buffers[column_buffer_index[col]];
+    buffer.lengths[n_rows_in_chunk] = static_cast<uint32_t>(n_values);
+    buffer.double_values.insert(buffer.double_values.end(), values,
+                                values + n_values);
+  };
+  void AddRow() {
+    if (++n_rows_in_chunk == chunk_size) {
+      Flush();
+    }
+  };
+  void Flush();
+  /**
+   * \brief Write all rows that were added so far to disk
+   *
+   * Flushes the current chunk, waits for the writer thread, if any, and
+   * synchronizes the file with the storage device.
+   * Afterwards, the file can be read up to GetNumberOfBytesWritten().
+   */
+  void Sync();
+  /**
+   * \brief Write the remaining rows and close the file
+   *
+   * If a writer thread is used, Close() waits until it has written all chunks.
+   * An error of the writer thread is rethrown here, or by the next hand-over
+   * of a chunk.
+   */
+  void Close();
+
+  bool IsOpen() const { return file != nullptr; };
+  string GetFileName() const { return file_name; };
+  uint64_t GetNumberOfRows() const { return n_rows_total + n_rows_in_chunk; };
+  /**
+   * \brief Return the number of bytes written so far
+   *
+   * If a writer thread is used, the chunks that are still waiting for it are
+   * not included.
+   */
+  uint64_t GetNumberOfBytesWritten() const {
+    return n_bytes_written.load(std::memory_order_relaxed);
+  };
+
+private:
+  struct VectorBuffer {
+    vector<uint32_t> lengths;
+    vector<int32_t> int_values;
+    vector<double> double_values;
+  };
+  struct Chunk {
+    vector<vector<int32_t>> int_buffers;
+    vector<vector<double>> double_buffers;
+    vector<vector<float>> float_buffers;
+    vector<VectorBuffer> vector_buffers;
+    size_t n_rows = 0;
+  };
+
+  const void *SerializeVectorColumn(const Chunk &c, const size_t col,
+                                    size_t &size);
+  void Write(const void *data, const size_t size);
+  void WritePadding(const size_t size);
+  void WriteHeader();
+  void WriteChunk(const Chunk &c);
+  void ClearChunk(Chunk &c);
+  void CompressColumn(const void *data, const size_t size, vector<char> &out);
+
+  void Enqueue();
+  void StopWriterThread();
+  void WriterLoop();
+
+  vector<string> column_names;
+  vector<ncol::ColumnType> column_types;
+  vector<size_t> column_buffer_index;
+  // Chunk that is currently being filled
+  Chunk chunk;
+
+  FILE *file;
+  string file_name;
+  size_t chunk_size;
+  int compression_level;
+  size_t n_rows_in_chunk;
+  uint64_t n_rows_total;
+  atomic<uint64_t> n_bytes_written;
+
+  // Buffers that are only used by the thread that writes the chunks
+  vector<vector<char>> compressed_buffers;
+  vector<char> serialization_buffer;
+
+  // Ring buffer of full chunks for the writer thread. The producer and the
+  // consumer count the chunks they have handed over and written, respectively.
+  // A chunk without rows tells the writer thread to stop.
+  vector<Chunk> queue;
+  atomic<uint64_t> n_chunks_queued;
+  atomic<uint64_t> n_chunks_written;
+  atomic<bool> writer_failed;
+  exception_ptr writer_error;
+  thread writer_thread;
+};
@@ -0,0 +1,78 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using std::function;
+using std::string;
+using std::vector;
+
+#include "NDetectorConstruction.hh"
+
+/**
+ * \brief Add-back and summed energies of detector groups
+ *
+ * The groups are taken from the detector construction (see
+ * NDetectorConstruction::GetDetectorGroups()).
+ * The summed energy of a group is the sum of the energy depositions in all of
+ * its sensitive detectors.
+ * The add-back energy only contains the sensitive detectors whose energy
+ * deposition is above a threshold, which suppresses noise-like contributions
+ * from single crystals.
+ */
+class DetectorGroups {
+public:
+  DetectorGroups() : threshold(0.), write_detectors(true){};
+
+  /**
+   * \brief Select groups and threshold according to the macro commands in
+   * /analysis/groups/
+   *
+   * \param uses_detector Returns true for the detectors of the back-end (see
+   * AnalysisManager::SetBackendDetectors()). Groups only contain these
+   * detectors, and groups without any of them are omitted.
+   */
+  void Initialize(const function<bool(size_t)> &uses_detector);
+
+  bool WriteDetectors() const { return write_detectors; };
+  size_t GetNumberOfGroups() const { return groups.size(); };
+  const string &GetGroupName(const size_t group) const {
+    return groups[group].name;
+  };
+
+  /**
+   * \param edep Energy deposition indexed by the detector ID. Detectors with
+   * an ID larger than the size of the vector are assumed to have no energy
+   * deposition.
+   */
+  void Compute(const vector<double> &edep);
+  double GetAddBack(const size_t group) const { return add_back[group]; };
+  double GetSum(const size_t group) const { return sum[group]; };
+
+private:
+  vector<DetectorGroup> groups;
+  double threshold;
+  bool write_detectors;
+  vector<double> add_back;
+  vector<double> sum;
+};
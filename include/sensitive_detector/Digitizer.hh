@@ -0,0 +1,159 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::atomic;
+using std::string;
+using std::vector;
+
+/**
+ * \brief Fast generator for normally distributed random numbers
+ *
+ * Uniform random numbers are generated with the xoshiro256+ algorithm, and
+ * they are transformed into normally distributed ones with the Box-Muller
+ * method.
+ * The random numbers are generated in blocks, which allows the compiler to
+ * vectorize the transformation.
+ * Each thread must use its own generator.
+ */
+class GaussianGenerator {
+public:
+  GaussianGenerator() : state{}, position(block_size){};
+
+  void SetSeed(uint64_t seed);
+  double operator()() {
+    if (position == block_size) {
+      Refill();
+    }
+    return block[position++];
+  };
+
+private:
+  static constexpr size_t block_size = 256;
+
+  uint64_t Next() {
+    const uint64_t result = state[0] + state[3];
+    const uint64_t t = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= t;
+    state[3] = (state[3] << 45) | (state[3] >> 19);
+    return result;
+  };
+  void Refill();
+
+  uint64_t state[4];
+  double uniform[block_size];
+  double block[block_size];
+  size_t position;
+};
+
+/**
+ * \brief Simulate the response of the data acquisition to energy depositions
+ *
+ * The digitizer processes the energy deposition \f$E\f$ in each detector
+ * (channel) of an event in the following order:
+ *
+ * 1. Non-linearity: \f$E \to p_1 E + p_2 E^2\f$.
+ * 2. Energy resolution: \f$E\f$ is replaced by a normally distributed random
+ * number with the mean \f$E\f$ and the full width at half maximum
+ * \f$\mathrm{FWHM}(E) = \sqrt{a + b E + c E^2}\f$.
+ * 3. Threshold: Energies below a threshold are set to zero.
+ * 4. Dead time: Each event is assigned a time, assuming that events occur
+ * randomly with a constant rate. A channel that has registered an energy is
+ * dead for a fixed time, during which it registers no further energies
+ * (non-paralyzable dead time).
+ *
+ * The parameters are shared by all threads and are set with the macro
+ * commands of the DigitizerMessenger.
+ * Each thread uses its own instance of the Digitizer, which holds copies of
+ * the parameters in contiguous arrays per parameter, the state of the random
+ * number generator, and the state of the dead-time model.
+ * The dead-time model of a thread assumes the full event rate, since the
+ * events processed by a thread are a random sample of all events.
+ */
+class Digitizer {
+public:
+  Digitizer();
+
+  static bool IsActive() { return active; };
+  /**
+   * \brief Process the energy depositions of an event in place
+   *
+   * \param edep Energy deposition indexed by the detector ID.
+   */
+  void Process(vector<double> &edep);
+
+  /**
+   * \brief Set parameters of a channel, or of all channels if channel < 0
+   */
+  static void SetResolution(const int channel, const double a, const double b,
+                            const double c);
+  static void SetNonLinearity(const int channel, const double p1,
+                              const double p2);
+  static void SetThreshold(const int channel, const double threshold);
+  static void SetDeadTime(const int channel, const double dead_time);
+  static void SetEventRate(const double rate);
+  static void Reset();
+  static void Print();
+
+private:
+  struct Parameters {
+    double a = 0., b = 0., c = 0.;
+    double p1 = 1., p2 = 0.;
+    double threshold = 0.;
+    double dead_time = 0.;
+  };
+
+  template <typename Setter>
+  static void SetParameters(const int channel, Setter setter);
+  void Update(const size_t n_channels);
+
+  inline static bool active = false;
+  static Parameters default_parameters;
+  static vector<Parameters> channel_parameters;
+  inline static double event_rate = 0.;
+  inline static atomic<unsigned int> revision = 0;
+
+  unsigned int local_revision;
+  bool seeded;
+  GaussianGenerator gaussian;
+  double time;
+
+  // Parameters of all channels in structure-of-arrays layout.
+  vector<double> a, b, c, p1, p2, threshold, dead_time;
+  vector<double> dead_until;
+
+  // Compacted data of the channels with an energy deposition in the current
+  // event, together with the parameters of these channels and one normally
+  // distributed random number per channel.
+  vector<size_t> hit_channels;
+  vector<double> hit_energies;
+  vector<double> hit_a, hit_b, hit_c, hit_p1, hit_p2;
+  vector<double> hit_noise;
+};
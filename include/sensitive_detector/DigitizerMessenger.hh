@@ -0,0 +1,45 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIdirectory.hh"
+#include "G4UImessenger.hh"
+
+/**
+ * \brief Macro commands in /nutr/digitizer/ to configure the Digitizer
+ */
+class DigitizerMessenger : public G4UImessenger {
+public:
+  DigitizerMessenger();
+  void SetNewValue(G4UIcommand *command, G4String str) override;
+
+private:
+  G4UIdirectory dir;
+  G4UIcmdWithAString cmd_resolution;
+  G4UIcmdWithAString cmd_nonlinearity;
+  G4UIcmdWithAString cmd_threshold;
+  G4UIcmdWithAString cmd_dead_time;
+  G4UIcmdWithADouble cmd_event_rate;
+  G4UIcmdWithoutParameter cmd_reset;
+  G4UIcmdWithoutParameter cmd_print;
+};
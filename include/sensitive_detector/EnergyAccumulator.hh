@@ -0,0 +1,73 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <vector>
+
+using std::vector;
+
+#include "tls.hh"
+
+/**
+ * \brief Energy deposition per detector in the current event of a thread
+ *
+ * Sensitive detectors that only need the total energy deposition in each
+ * detector add the energy of each step directly to a thread-local array,
+ * instead of creating a hit for each step.
+ * This avoids any allocation while an event is processed, since the array
+ * keeps its capacity from one event to the next.
+ * The array is reset by NEventAction::BeginOfEventAction() and read by the
+ * EndOfEventAction.
+ */
+class EnergyAccumulator {
+public:
+  static void Reset();
+  static void Add(const size_t detector_id, const double edep) {
+    if (detector_id >= edep_per_detector->size()) {
+      edep_per_detector->resize(detector_id + 1, 0.);
+    }
+    (*edep_per_detector)[detector_id] += edep;
+  };
+  /**
+   * \brief Return the energy deposition in the current event
+   *
+   * \return Energy deposition indexed by the detector ID. The vector ends with
+   * the highest detector ID that was hit.
+   * It may be modified in place, for example by the Digitizer.
+   */
+  static vector<double> &GetEdep() { return *edep_per_detector; };
+  /**
+   * \brief Mark the energy deposition in the current event as digitized
+   *
+   * \return false if it was already marked, for example by another back-end
+   * (see Backends).
+   */
+  static bool SetDigitized() {
+    if (digitized) {
+      return false;
+    }
+    digitized = true;
+    return true;
+  };
+
+private:
+  static G4ThreadLocal vector<double> *edep_per_detector;
+  static G4ThreadLocal bool digitized;
+};
@@ -16,20 +16,23 @@
 
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
+
 #pragma once
 
-#include "DetectorHit.hh"
 #include "NSensitiveDetector.hh"
 
-class SensitiveDetector : public NSensitiveDetector {
+/**
+ * \brief Sensitive detector that adds the energy deposition of each step to
+ * the EnergyAccumulator without creating any hits
+ *
+ * Used by all back-ends that only need the total energy deposition in each
+ * detector: 'edep', 'event', and 'histogram'.
+ */
+class EnergySensitiveDetector : public NSensitiveDetector {
 public:
-  SensitiveDetector(const string &name, const string &hitsCollectionName)
-      : NSensitiveDetector(name, hitsCollectionName),
-        fDetectorHitsCollection(nullptr){};
+  EnergySensitiveDetector(const string &name, const string &hitsCollectionName)
+      : NSensitiveDetector(name, hitsCollectionName){};
 
-  void Initialize(G4HCofThisEvent *hce) override final;
+  void Initialize(G4HCofThisEvent *) override final{};
   G4bool ProcessHits(G4Step *step, G4TouchableHistory *history) override final;
-
-protected:
-  G4THitsCollection<DetectorHit> *fDetectorHitsCollection;
 };
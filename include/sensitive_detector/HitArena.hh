@@ -0,0 +1,139 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+using std::array;
+using std::vector;
+
+#include "tls.hh"
+
+#include "NutrMessenger.hh"
+
+/**
+ * \brief Per-thread storage of the hits of an event
+ *
+ * Sensitive detectors that record single steps store each field of a hit in
+ * its own flat array (structure of arrays), instead of allocating a hit object
+ * per step.
+ * The arena is reset as a whole at the beginning of each event.
+ * Since the arrays keep their capacity across events, no memory is allocated
+ * anymore once the largest event so far fits into them.
+ * The capacity is only released when a smaller /analysis/hit_memory is set.
+ *
+ * The memory of the arena of a thread is limited by /analysis/hit_memory.
+ * The capacity of the arrays is grown explicitly and never exceeds this limit.
+ * Hits beyond the limit are discarded and counted, i.e. a pathological event
+ * is truncated instead of exhausting the memory.
+ *
+ * \tparam n_int_fields Number of integer fields of a hit.
+ * \tparam n_double_fields Number of floating-point fields of a hit.
+ */
+template <size_t n_int_fields, size_t n_double_fields> class HitArena {
+public:
+  static HitArena &Instance() {
+    if (!instance) {
+      instance = new HitArena;
+    }
+    return *instance;
+  };
+
+  void Reset() {
+    for (auto &field : int_fields) {
+      field.clear();
+    }
+    for (auto &field : double_fields) {
+      field.clear();
+    }
+    n_hits = 0;
+    n_dropped_hits = 0;
+    max_hits = std::max(NutrMessenger::GetHitMemory() * 1024 * 1024 / hit_size,
+                        size_t(1));
+    if (capacity > max_hits) {
+      for (auto &field : int_fields) {
+        vector<int32_t>().swap(field);
+      }
+      for (auto &field : double_fields) {
+        vector<double>().swap(field);
+      }
+      capacity = 0;
+    }
+  };
+  /**
+   * \return False if the hit was discarded because the arena is full.
+   */
+  bool Add(const array<int32_t, n_int_fields> &ints,
+           const array<double, n_double_fields> &doubles) {
+    if (n_hits == max_hits) {
+      ++n_dropped_hits;
+      return false;
+    }
+    if (n_hits == capacity) {
+      // Grow by doubling like push_back, but clamped to the limit.
+      capacity = std::min(std::max(2 * capacity, min_capacity), max_hits);
+      for (auto &field : int_fields) {
+        field.reserve(capacity);
+      }
+      for (auto &field : double_fields) {
+        field.reserve(capacity);
+      }
+    }
+    for (size_t i = 0; i < n_int_fields; ++i) {
+      int_fields[i].push_back(ints[i]);
+    }
+    for (size_t i = 0; i < n_double_fields; ++i) {
+      double_fields[i].push_back(doubles[i]);
+    }
+    ++n_hits;
+    return true;
+  };
+
+  size_t Size() const { return n_hits; };
+  uint64_t GetNumberOfDroppedHits() const { return n_dropped_hits; };
+  int32_t GetI(const size_t field, const size_t hit) const {
+    return int_fields[field][hit];
+  };
+  double GetD(const size_t field, const size_t hit) const {
+    return double_fields[field][hit];
+  };
+  double &GetD(const size_t field, const size_t hit) {
+    return double_fields[field][hit];
+  };
+
+private:
+  HitArena() : n_hits(0), n_dropped_hits(0), max_hits(0), capacity(0){};
+
+  static constexpr size_t hit_size =
+      n_int_fields * sizeof(int32_t) + n_double_fields * sizeof(double);
+  static constexpr size_t min_capacity = 64;
+
+  array<vector<int32_t>, n_int_fields> int_fields;
+  array<vector<double>, n_double_fields> double_fields;
+  size_t n_hits;
+  uint64_t n_dropped_hits;
+  size_t max_hits;
+  size_t capacity; /**< Number of hits for which memory is reserved. */
+
+  inline static G4ThreadLocal HitArena *instance = nullptr;
+};
@@ -0,0 +1,75 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using std::numeric_limits;
+using std::vector;
+
+/**
+ * \brief Selection of the particles that are recorded by sensitive detectors
+ * which write single steps
+ *
+ * A particle is recorded if it is in one of the selected detectors, if its PDG
+ * code is in the list of selected particles, and if its kinetic energy is
+ * inside the selected energy range.
+ * By default, all particles with any energy in all detectors are selected.
+ * All settings are shared by all threads and are intended to be changed
+ * between runs with the macro commands of the HitFilterMessenger.
+ */
+class HitFilter {
+public:
+  static bool AcceptDetector(const size_t detector_id) {
+    return selected_detectors.empty() ||
+           (detector_id < selected_detectors.size() &&
+            selected_detectors[detector_id]);
+  };
+  static bool AcceptParticle(const int particle_id) {
+    return particle_ids.empty() ||
+           std::find(particle_ids.begin(), particle_ids.end(), particle_id) !=
+               particle_ids.end();
+  };
+  static bool AcceptEnergy(const double ekin) {
+    return ekin >= e_min && ekin <= e_max;
+  };
+
+  /**
+   * \param detector_ids IDs of the selected detectors. An empty list selects
+   * all detectors.
+   */
+  static void SetDetectors(const vector<size_t> &detector_ids);
+  /**
+   * \param _particle_ids PDG codes of the selected particles. An empty list
+   * selects all particles.
+   */
+  static void SetParticles(const vector<int> &_particle_ids);
+  static void SetEnergyRange(const double _e_min, const double _e_max);
+  static void Reset();
+  static void Print();
+
+private:
+  inline static vector<bool> selected_detectors;
+  inline static vector<int> particle_ids;
+  inline static double e_min = 0.;
+  inline static double e_max = numeric_limits<double>::max();
+};
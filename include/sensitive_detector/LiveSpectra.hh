@@ -0,0 +1,135 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using std::mutex;
+using std::string;
+using std::vector;
+
+/**
+ * \brief Layout of a live spectra file
+ *
+ * The file starts with a header that contains the magic string, the format
+ * version, the number of spectra, the number of bins per spectrum (including
+ * the overflow bin), the upper limit of the energy range, a sequence number,
+ * and the number of events that have been added to the spectra.
+ * It is followed by the names of the spectra, each in a zero-padded field of
+ * name_length bytes, and by the counts of all spectra, stored spectrum by
+ * spectrum as 64-bit unsigned integers.
+ *
+ * The sequence number is a sequence lock: it is odd while the counts are
+ * being updated.
+ * A reader obtains a consistent snapshot by reading the sequence number,
+ * copying the counts, and reading the sequence number again.
+ * If the two numbers differ or are odd, the copy has to be repeated.
+ *
+ * All numbers are stored in the byte order of the machine that wrote the file.
+ */
+namespace live {
+constexpr char magic[8] = {'N', 'U', 'T', 'R', 'L', 'I', 'V', '\0'};
+constexpr uint32_t version = 1;
+constexpr size_t name_length = 64;
+constexpr size_t header_size = 48;
+} // namespace live
+
+/**
+ * \brief Energy spectra in a memory-mapped file that can be read during a run
+ *
+ * The simulation creates the file and adds counts to it from several threads.
+ * Updates are serialized by a mutex and published with a sequence lock (see
+ * the live namespace), so that other processes, which map the same file, can
+ * read consistent spectra at any time without slowing down the simulation.
+ */
+class LiveSpectra {
+public:
+  /**
+   * \brief Create a file with empty spectra
+   *
+   * \param n_bins Number of bins per spectrum, including the overflow bin.
+   */
+  LiveSpectra(const string &file_name, const vector<string> &spectrum_names,
+              const size_t n_bins, const double e_max);
+  /**
+   * \brief Open an existing file for reading
+   */
+  explicit LiveSpectra(const string &file_name);
+  ~LiveSpectra();
+
+  LiveSpectra(const LiveSpectra &) = delete;
+  LiveSpectra &operator=(const LiveSpectra &) = delete;
+
+  size_t GetNumberOfSpectra() const { return spectrum_names.size(); };
+  string GetSpectrumName(const size_t spectrum) const {
+    return spectrum_names[spectrum];
+  };
+  size_t GetNumberOfBins() const { return n_bins; };
+  double GetMaximumEnergy() const { return e_max; };
+
+  /**
+   * \brief Start an update of the counts
+   *
+   * Blocks until the updates of other threads are finished.
+   */
+  void BeginUpdate();
+  /**
+   * \param index Index of the bin in the counts of all spectra, i.e.
+   * spectrum * GetNumberOfBins() + bin.
+   */
+  void Add(const size_t index, const uint64_t n);
+  /**
+   * \brief Finish an update and publish it
+   *
+   * \param n_events Number of events that were added by this update.
+   */
+  void EndUpdate(const uint64_t n_events);
+
+  /**
+   * \brief Copy a consistent snapshot of the counts of all spectra
+   *
+   * Throws an exception if no consistent snapshot can be read within about
+   * a second, for example because the writer was terminated during an update.
+   *
+   * \return Number of events in the snapshot.
+   */
+  uint64_t Read(vector<uint64_t> &counts) const;
+
+private:
+  void Map(const bool writable);
+
+  string file_name;
+  int file_descriptor;
+  char *data;
+  size_t size;
+
+  vector<string> spectrum_names;
+  size_t n_bins;
+  double e_max;
+
+  uint64_t *sequence;
+  uint64_t *n_events_total;
+  uint64_t *counts;
+
+  mutex update_mutex;
+};
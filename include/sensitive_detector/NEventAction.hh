@@ -24,18 +24,44 @@
 #include "globals.hh"
 
 #include "AnalysisManager.hh"
-#include "SensitiveDetectorBuildOptions.hh"
+#include "Digitizer.hh"
+#include "NRunAction.hh"
 
 class NEventAction : public G4UserEventAction {
 public:
   NEventAction(AnalysisManager *ana_man)
-      : G4UserEventAction(), analysis_manager(ana_man),
-        update_frequency(sensitive_detector_build_options.update_frequency){};
+      : G4UserEventAction(), analysis_manager(ana_man), run_action(nullptr){};
 
   void BeginOfEventAction(const G4Event *event) override final;
-  virtual void EndOfEventAction(const G4Event *) = 0;
+  void EndOfEventAction(const G4Event *event) override final;
+
+  /**
+   * \brief Set the run action of the thread
+   *
+   * Must only be called for the event action of the first back-end of a run
+   * (see Backends), which also handles the tasks that are common to all
+   * back-ends: it resets the EnergyAccumulator, writes checkpoints, decides
+   * whether an event is processed, and reports the progress of the run.
+   */
+  void SetRunAction(const NRunAction *_run_action) {
+    run_action = _run_action;
+  };
 
 protected:
+  /**
+   * \brief Process the hits of an event, called by the EndOfEventAction
+   */
+  virtual void ProcessEvent(const G4Event *event) = 0;
+  /**
+   * \brief Return the energy deposition per detector in the current event,
+   * processed by the Digitizer if it is active
+   *
+   * If several back-ends are combined, the energy deposition is only
+   * digitized by the first one that requests it.
+   */
+  vector<double> &DigitizedEdep();
+
   AnalysisManager *analysis_manager;
-  const int update_frequency;
+  const NRunAction *run_action;
+  Digitizer digitizer;
 };
@@ -31,15 +31,20 @@ using std::chrono::time_point;
 
 class NRunAction : public G4UserRunAction {
 public:
-  NRunAction(const string _output_file_name, AnalysisManager *ana_man);
+  /**
+   * \param _first_backend False for all but the first back-end of a run (see
+   * Backends), which only book and save their own output. The first one also
+   * prepares the checkpoints of the run and the thread.
+   */
+  NRunAction(const string _output_file_name, AnalysisManager *ana_man,
+             const bool _first_backend = true);
 
   void BeginOfRunAction(const G4Run *run) override;
   void EndOfRunAction(const G4Run *run) override;
 
-  time_point<system_clock> get_start_time() { return start_time; };
-
 private:
   const string output_file_name;
   AnalysisManager *analysis_manager;
+  const bool first_backend;
   const time_point<system_clock> start_time;
 };
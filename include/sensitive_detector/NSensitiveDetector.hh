@@ -20,11 +20,15 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 using std::string;
+using std::vector;
 
 #include "G4HCofThisEvent.hh"
+#include "G4LogicalVolume.hh"
 #include "G4Step.hh"
+#include "G4VPhysicalVolume.hh"
 #include "G4VSensitiveDetector.hh"
 
 #include "NDetectorHit.hh"
@@ -38,9 +42,33 @@ public:
   virtual void EndOfEvent(G4HCofThisEvent *hitCollection);
 
   unsigned int GetDetectorID() const { return fDetectorID; };
+  /**
+   * \brief Return the detector ID of the volume in which a step takes place
+   *
+   * This is the ID of the sensitive detector, unless it is attached to
+   * several logical volumes (see SetLogicalVolumes()).
+   */
+  unsigned int GetDetectorID(const G4Step *step) const {
+    if (detector_ids.empty()) {
+      return fDetectorID;
+    }
+    return detector_ids[step->GetPreStepPoint()
+                            ->GetPhysicalVolume()
+                            ->GetLogicalVolume()
+                            ->GetInstanceID()];
+  };
 
   void SetDetectorID(const unsigned int id) { fDetectorID = id; };
+  /**
+   * \brief Use the sensitive detector for several logical volumes
+   *
+   * The detector ID of a step is the index of its logical volume in the given
+   * list.
+   */
+  void SetLogicalVolumes(const vector<G4LogicalVolume *> &logical_volumes);
 
 protected:
   unsigned int fDetectorID;
+  // Detector IDs indexed by the instance ID of a logical volume.
+  vector<unsigned int> detector_ids;
 };
\ No newline at end of file
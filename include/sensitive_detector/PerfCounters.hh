@@ -0,0 +1,166 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+using std::array;
+using std::atomic;
+using std::map;
+using std::mutex;
+using std::vector;
+
+#include "tls.hh"
+
+/**
+ * \brief Hardware performance counters per thread and phase of an event
+ *
+ * If enabled, each thread counts the CPU cycles, instructions, cache misses,
+ * and branch misses with the perf_event_open interface of Linux, together
+ * with the CPU time of the thread.
+ * Only events in user space are counted.
+ * The counts are attributed to the phase of the simulation in which they
+ * occur: the generation of the primary particles, the tracking, the
+ * processing of steps by sensitive detectors, and the analysis and output at
+ * the end of an event.
+ * Everything else, like the initialization of a run, belongs to the phase
+ * 'other'.
+ * Each change of the phase reads the counters with a system call, which is
+ * not counted itself, but it slows down the simulation.
+ *
+ * If the kernel or the processor cannot provide a counter, for example in a
+ * virtual machine or if /proc/sys/kernel/perf_event_paranoid is too
+ * restrictive, the counter is omitted, and a message is printed once.
+ * If no counter is available at all, for example on operating systems other
+ * than Linux, the simulation runs without them.
+ *
+ * At the end of a run, the master thread prints the counts of all threads per
+ * phase, together with the number of instructions per cycle (IPC) and the
+ * numbers of misses per thousand instructions.
+ */
+class PerfCounters {
+public:
+  enum class Phase : size_t {
+    other,
+    primary_generation,
+    tracking,
+    sensitive_detector,
+    analysis
+  };
+
+  /**
+   * \brief Switch to a phase for the lifetime of an object
+   */
+  class Scope {
+  public:
+    explicit Scope(const Phase phase) : previous(SetPhase(phase)){};
+    ~Scope() { SetPhase(previous); };
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+  private:
+    const Phase previous;
+  };
+
+  static void SetEnabled(const bool _enabled) { enabled = _enabled; };
+  static void SetPerThread(const bool _per_thread) {
+    per_thread = _per_thread;
+  };
+
+  /**
+   * \brief Discard the counts of the previous run
+   *
+   * Must be called by the master thread before the worker threads start.
+   */
+  static void BeginRun();
+  /**
+   * \brief Open the counters of the calling thread if they are enabled
+   */
+  static void BeginThread();
+  /**
+   * \brief Switch the calling thread to another phase
+   *
+   * \return The previous phase.
+   */
+  static Phase SetPhase(const Phase phase) {
+    if (thread_counters == nullptr || thread_counters->phase == phase) {
+      return phase;
+    }
+    return Switch(phase);
+  };
+  /**
+   * \brief Add the counts of the calling thread to the counts of the run
+   */
+  static void EndThread();
+  /**
+   * \brief Print the counts of the run
+   *
+   * Must be called by the master thread after all worker threads have
+   * finished.
+   */
+  static void Report();
+
+private:
+  static constexpr size_t n_counters = 5;
+  static constexpr size_t n_phases = 5;
+
+  struct Counts {
+    array<uint64_t, n_counters> values{};
+    // Time during which the counters were enabled and running, which differ
+    // if the kernel multiplexes more counters than the hardware provides.
+    uint64_t time_enabled = 0;
+    uint64_t time_running = 0;
+
+    void Add(const Counts &counts);
+  };
+
+  struct ThreadCounters {
+    int leader = -1;
+    vector<int> file_descriptors;
+    // Position of each counter in the values that are read from the leader,
+    // or -1 if it is not available.
+    array<int, n_counters> positions;
+    Phase phase = Phase::other;
+    Counts last;
+    array<Counts, n_phases> counts;
+  };
+
+  static ThreadCounters *Open();
+  static void Close(ThreadCounters *counters);
+  static Counts Read(const ThreadCounters &counters);
+  static Phase Switch(const Phase phase);
+  static void Print(const char *title, const array<Counts, n_phases> &counts);
+
+  inline static bool enabled = false;
+  inline static bool per_thread = false;
+  inline static atomic<bool> unavailable_reported = false;
+
+  static G4ThreadLocal ThreadCounters *thread_counters;
+
+  // Counts of all threads, by thread ID.
+  inline static mutex results_mutex;
+  inline static map<int, array<Counts, n_phases>> results;
+  inline static array<bool, n_counters> available{};
+};
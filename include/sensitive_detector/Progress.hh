@@ -0,0 +1,152 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+using std::array;
+using std::atomic;
+using std::mutex;
+using std::string;
+using std::chrono::steady_clock;
+using std::chrono::system_clock;
+
+#include "tls.hh"
+
+#include "SensitiveDetectorBuildOptions.hh"
+
+/**
+ * \brief Report the progress of a run
+ *
+ * All threads count their processed events in atomic counters, so a report
+ * always describes the whole run and not only the thread that prints it.
+ * A report is printed after every /nutr/progress/events events of the run,
+ * and additionally after every /nutr/progress/interval.
+ * It contains the total number of events per second since the start of the
+ * run, the estimated time until all events are processed (ETA), and the
+ * events per second of each thread.
+ * The load imbalance is the relative difference between the mean rate of the
+ * threads and the rate of the slowest one.
+ *
+ * Optionally, each report is also written to a status file in the JSON
+ * format, which can be read by monitoring tools while the run is in
+ * progress.
+ * At the end of the run, the master thread prints a summary and writes the
+ * final status.
+ */
+class Progress {
+public:
+  static void SetInterval(const double seconds) { interval = seconds; };
+  static void SetEventInterval(const uint64_t n_events) {
+    event_interval = n_events;
+  };
+  static void SetPerThread(const bool _per_thread) {
+    per_thread = _per_thread;
+  };
+  /**
+   * \brief Set the name of the status file, or disable it with an empty name
+   */
+  static void SetStatusFile(const string &file_name) {
+    status_file = file_name;
+  };
+
+  /**
+   * \brief Prepare a run
+   *
+   * Must be called by the master thread before the worker threads start to
+   * process events.
+   *
+   * \param n_events Number of events that will be processed.
+   */
+  static void BeginRun(const int64_t n_events);
+  /**
+   * \brief Prepare a thread that processes events
+   *
+   * Threads that do not process events, like the master thread of a
+   * multithreaded application, are ignored.
+   */
+  static void BeginThread();
+  /**
+   * \brief Stop the clock of the calling thread
+   *
+   * The rate of a thread that has finished its events is not reduced by the
+   * time it waits for the other threads.
+   */
+  static void EndThread();
+  /**
+   * \brief Count an event of the calling thread and report if due
+   */
+  static void CountEvent();
+  /**
+   * \brief Print a summary of the run and write the final status
+   *
+   * Must be called by the master thread after all worker threads have
+   * finished.
+   */
+  static void EndRun();
+
+  /**
+   * \brief Format a point in time as local time
+   *
+   * In contrast to std::localtime, this function can be called by several
+   * threads at the same time.
+   */
+  static string FormatTime(const system_clock::time_point time,
+                           const char *format = "%F %T");
+
+private:
+  // Each thread owns a cache line, so counting does not slow down the other
+  // threads.
+  struct alignas(64) Slot {
+    atomic<uint64_t> n_events;
+    atomic<int64_t> start;
+    atomic<int64_t> end;
+    atomic<int> thread_id;
+  };
+
+  static int64_t Now();
+  static void Report(const bool final);
+
+  static constexpr size_t max_threads = 256;
+
+  inline static double interval = 0.;
+  inline static uint64_t event_interval =
+      sensitive_detector_build_options.update_frequency;
+  inline static bool per_thread = true;
+  inline static string status_file = "";
+
+  inline static int64_t n_events_expected = 0;
+  inline static steady_clock::time_point start;
+  inline static atomic<uint64_t> n_events = 0;
+  inline static atomic<int64_t> next_report = 0;
+  inline static array<Slot, max_threads> slots;
+  inline static atomic<size_t> n_slots = 0;
+  static G4ThreadLocal Slot *thread_slot;
+
+  // Only one thread reports at a time.
+  inline static mutex report_mutex;
+  inline static uint64_t n_events_last_report = 0;
+  inline static int64_t last_report = 0;
+};
@@ -0,0 +1,133 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+using std::string;
+
+/**
+ * \brief Timeline of the phases of a run in the Chrome trace format
+ *
+ * If tracing is enabled, each thread records timestamped spans, for example
+ * for the initialization, the construction of the physics tables, each event
+ * or chunk of events, the analysis at the end of each event, and the output
+ * of the native columnar format.
+ * The timeline is written in the JSON format of the Chrome trace viewer,
+ * which can be opened with https://ui.perfetto.dev or chrome://tracing.
+ * Each thread of nutr, including the writer threads of the native columnar
+ * format, is a separate track.
+ *
+ * Events that are processed by a thread are combined into spans of a given
+ * number of events, which keeps the file small for runs with many short
+ * events.
+ * The span of an event begins with its BeginOfEventAction and ends with its
+ * last EndOfEventAction.
+ *
+ * The spans of each thread are stored in memory, and the timeline is written
+ * by the master thread at the end of each run.
+ * Afterwards, the spans are discarded, so the file contains the spans since
+ * the end of the previous run.
+ * This class does not depend on Geant4, so it can also be used by the
+ * standalone tools for the native columnar format.
+ */
+class Trace {
+public:
+  /**
+   * \brief Record spans and write them to the given file
+   */
+  static void Enable(const string &_file_name);
+  static bool IsEnabled() { return enabled; };
+  static void SetEventsPerSpan(const uint64_t n_events) {
+    events_per_span = n_events > 0 ? n_events : 1;
+  };
+  /**
+   * \brief Set the name under which the spans of the calling thread are shown
+   */
+  static void SetThreadName(const string &name);
+
+  /**
+   * \brief Return the time in ns since the start of the application
+   */
+  static int64_t Now();
+  /**
+   * \brief Record a span of the calling thread
+   *
+   * \param name Must be a string literal, or another string that exists until
+   * the end of the application.
+   * \param category Must be a string literal.
+   */
+  static void Add(const char *name, const char *category, const int64_t start,
+                  const int64_t end, const int64_t first_event = -1,
+                  const int64_t last_event = -1);
+
+  /**
+   * \brief Start an event of the calling thread
+   */
+  static void BeginEvent(const int64_t event_id);
+  /**
+   * \brief Mark the end of the processing of the current event
+   *
+   * Can be called several times per event, the last call determines the end.
+   */
+  static void EndEvent();
+  /**
+   * \brief Record the pending span of events of the calling thread
+   */
+  static void EndThread();
+
+  /**
+   * \brief Write the timeline of all threads
+   */
+  static void Write();
+  /**
+   * \brief Discard the spans of all threads, for example after they were
+   * written at the end of a run
+   */
+  static void Clear();
+
+  /**
+   * \brief Record the lifetime of an object as a span, if tracing is enabled
+   */
+  class Span {
+  public:
+    Span(const char *_name, const char *_category)
+        : name(_name), category(_category),
+          start(Trace::IsEnabled() ? Trace::Now() : 0){};
+    ~Span() {
+      if (Trace::IsEnabled()) {
+        Trace::Add(name, category, start, Trace::Now());
+      }
+    };
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+  private:
+    const char *name;
+    const char *category;
+    const int64_t start;
+  };
+
+private:
+  inline static bool enabled = false;
+  inline static string file_name = "";
+  inline static uint64_t events_per_span = 1;
+};
@@ -0,0 +1,101 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+/**
+ * \brief Online event filter that is applied before any output is written
+ *
+ * A detector 'fires' in an event if its energy deposition is larger than zero
+ * and not smaller than its threshold.
+ * An event is accepted if
+ *
+ * - at least 'multiplicity' detectors fire (at least one, if the trigger is
+ * active),
+ * - for each coincidence, at least one detector of each group in the
+ * coincidence fires, and
+ * - for each energy window, the sum of the energy depositions in all detectors
+ * of a group is inside the window.
+ *
+ * Groups are named lists of detector IDs.
+ * The trigger is inactive and accepts all events as long as none of the
+ * conditions above has been set.
+ * All settings are shared by all threads and are intended to be changed
+ * between runs with the macro commands of the TriggerMessenger.
+ */
+class Trigger {
+public:
+  static bool IsActive() { return active; };
+  /**
+   * \brief Decide whether an event is accepted
+   *
+   * \param edep Energy deposition in each detector, indexed by the detector
+   * ID. Detectors with an ID larger than the size of the vector are assumed to
+   * have no energy deposition.
+   */
+  static bool Accept(const vector<double> &edep);
+
+  static void SetThreshold(const double _threshold);
+  static void SetDetectorThreshold(const size_t detector_id,
+                                   const double _threshold);
+  static void SetMultiplicity(const size_t _multiplicity);
+  static void AddGroup(const string &name, const vector<size_t> &detector_ids);
+  static void AddCoincidence(const vector<string> &group_names);
+  static void AddWindow(const string &group_name, const double lower,
+                        const double upper);
+  static void Reset();
+  static void Print();
+
+private:
+  struct Group {
+    string name;
+    vector<size_t> detector_ids;
+  };
+  struct Window {
+    size_t group;
+    double lower;
+    double upper;
+  };
+
+  static size_t GetGroupIndex(const string &name);
+  static bool Fires(const vector<double> &edep, const size_t detector_id) {
+    if (detector_id >= edep.size() || edep[detector_id] <= 0.) {
+      return false;
+    }
+    return edep[detector_id] >=
+           (detector_id < detector_thresholds.size() &&
+                    detector_thresholds[detector_id] >= 0.
+                ? detector_thresholds[detector_id]
+                : threshold);
+  };
+
+  inline static bool active = false;
+  inline static double threshold = 0.;
+  inline static vector<double> detector_thresholds;
+  inline static size_t multiplicity = 1;
+  inline static vector<Group> groups;
+  inline static vector<vector<size_t>> coincidences;
+  inline static vector<Window> windows;
+};
@@ -21,12 +21,19 @@
 
 #include "globals.hh"
 
-#include "AnalysisManager.hh"
 #include "NEventAction.hh"
+#include "TupleManager.hh"
+
+namespace edep {
 
 class EventAction : public NEventAction {
 public:
-  EventAction(AnalysisManager *ana_man);
+  EventAction(TupleManager *tuple_man);
+
+  void ProcessEvent(const G4Event *) override final;
 
-  void EndOfEventAction(const G4Event *) override final;
+private:
+  TupleManager *tuple_manager;
 };
+
+} // namespace edep
@@ -21,13 +21,22 @@
 
 #include "AnalysisManager.hh"
 
+namespace edep {
+
 class TupleManager : public AnalysisManager {
 public:
   TupleManager() : AnalysisManager(){};
 
-  void CreateNtupleColumns(G4AnalysisManager *analysisManager) override;
+  void CreateNtupleColumns() override;
 
-  size_t FillNtupleColumns(G4AnalysisManager *analysisManager,
-                           const G4Event *event,
-                           vector<G4VHit *> hits) override;
+  using AnalysisManager::FillNtuple;
+  /**
+   * \brief Write one row for each detector with a non-zero energy deposition
+   *
+   * \param edep Energy deposition indexed by the detector ID, see
+   * EnergyAccumulator::GetEdep().
+   */
+  void FillNtuple(const G4Event *event, const vector<double> &edep);
 };
+
+} // namespace edep
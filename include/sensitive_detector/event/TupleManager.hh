@@ -20,17 +20,35 @@
 #pragma once
 
 #include "AnalysisManager.hh"
+#include "DetectorGroups.hh"
+
+namespace event {
 
 class TupleManager : public AnalysisManager {
 public:
-  TupleManager() : AnalysisManager(), n_sensitive_detectors(0){};
+  TupleManager()
+      : AnalysisManager(), n_sensitive_detectors(0),
+        zero_suppression(false){};
 
-  void CreateNtupleColumns(G4AnalysisManager *analysisManager) override;
+  void CreateNtupleColumns() override;
 
-  size_t FillNtupleColumns(G4AnalysisManager *analysisManager,
-                           const G4Event *event,
-                           vector<G4VHit *> hits) override;
+  using AnalysisManager::FillNtuple;
+  /**
+   * \brief Write the row of an event
+   *
+   * \param edep Energy deposition indexed by the detector ID, see
+   * EnergyAccumulator::GetEdep().
+   */
+  void FillNtuple(const G4Event *event, const vector<double> &edep);
 
 private:
   size_t n_sensitive_detectors;
+  vector<size_t> backend_detectors; /**< IDs of the detectors of the
+                                       back-end. */
+  bool zero_suppression;
+  vector<int> detector_ids;
+  vector<double> edeps;
+  DetectorGroups detector_groups;
 };
+
+} // namespace event
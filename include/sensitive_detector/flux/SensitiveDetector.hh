@@ -18,18 +18,38 @@
 */
 #pragma once
 
-#include "DetectorHit.hh"
+#include <cstdint>
+#include <unordered_set>
+
+using std::unordered_set;
+
+#include "DetectorHits.hh"
 #include "NSensitiveDetector.hh"
 
+namespace flux {
+
+/**
+ * \brief Sensitive detector that records each particle when it enters a
+ * detector for the first time in an event
+ *
+ * A particle enters a detector if its step begins at the boundary of the
+ * detector, or if it is created inside the detector.
+ * Only the first entry of each track into a detector is recorded, and only if
+ * the particle is selected by the HitFilter.
+ * The hits are stored in the DetectorHits arena of the thread.
+ */
 class SensitiveDetector : public NSensitiveDetector {
 public:
   SensitiveDetector(const string &name, const string &hitsCollectionName)
-      : NSensitiveDetector(name, hitsCollectionName),
-        fDetectorHitsCollection(nullptr){};
+      : NSensitiveDetector(name, hitsCollectionName){};
 
-  void Initialize(G4HCofThisEvent *hce) override final;
+  void Initialize(G4HCofThisEvent *) override final;
   G4bool ProcessHits(G4Step *step, G4TouchableHistory *history) override final;
 
-protected:
-  G4THitsCollection<DetectorHit> *fDetectorHitsCollection;
+private:
+  // Track and detector IDs of the entries that have been recorded in the
+  // current event.
+  unordered_set<uint64_t> recorded_entries;
 };
+
+} // namespace flux
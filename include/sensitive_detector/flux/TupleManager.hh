@@ -20,14 +20,21 @@
 #pragma once
 
 #include "AnalysisManager.hh"
+#include "DetectorHits.hh"
+
+namespace flux {
 
 class TupleManager : public AnalysisManager {
 public:
   TupleManager() : AnalysisManager(){};
 
-  void CreateNtupleColumns(G4AnalysisManager *analysisManager) override;
+  void CreateNtupleColumns() override;
 
-  size_t FillNtupleColumns(G4AnalysisManager *analysisManager,
-                           const G4Event *event,
-                           vector<G4VHit *> hits) override;
+  /**
+   * \brief Write a row for a single hit
+   */
+  void FillHit(const G4Event *event, const DetectorHits &hits,
+               const size_t hit);
 };
+
+} // namespace flux
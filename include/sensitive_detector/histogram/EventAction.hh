@@ -17,20 +17,23 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include "DetectorHit.hh"
+#pragma once
 
-G4ThreadLocal G4Allocator<DetectorHit> *DetectorHitAllocator = 0;
+#include "globals.hh"
 
-DetectorHit::DetectorHit() : NDetectorHit(), fEdep(0.) {}
+#include "NEventAction.hh"
+#include "TupleManager.hh"
 
-DetectorHit::DetectorHit(const DetectorHit &right) : NDetectorHit() {
-  fDetectorID = right.fDetectorID;
-  fEdep = right.fEdep;
-}
+namespace histogram {
 
-const DetectorHit &DetectorHit::operator=(const DetectorHit &right) {
-  fDetectorID = right.fDetectorID;
-  fEdep = right.fEdep;
+class EventAction : public NEventAction {
+public:
+  EventAction(TupleManager *tuple_man);
 
-  return *this;
-}
\ No newline at end of file
+  void ProcessEvent(const G4Event *) override final;
+
+private:
+  TupleManager *tuple_manager;
+};
+
+} // namespace histogram
@@ -0,0 +1,125 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+using std::atomic;
+using std::chrono::steady_clock;
+using std::unique_ptr;
+using std::unordered_map;
+
+#include "AnalysisManager.hh"
+#include "DetectorGroups.hh"
+#include "LiveSpectra.hh"
+
+namespace histogram {
+
+/**
+ * \brief Analysis manager that accumulates an energy spectrum per detector
+ *
+ * Instead of writing one row per event, each thread adds the energy
+ * depositions in each detector to its own spectra, so that no
+ * synchronization or I/O is required while events are processed.
+ * Depending on the /analysis/groups/ macro commands, there are also spectra
+ * of the add-back and summed energies of detector groups (see
+ * DetectorGroups).
+ * The spectra have n_bins bins between 0 and e_max, plus an overflow bin
+ * (see the /analysis/histogram/ macro commands).
+ * By default, the spectra of a thread are stored in a contiguous array.
+ * In sparse mode, only the bins that are not empty are stored in a hash map
+ * per detector.
+ *
+ * At the end of a run, the worker threads add their spectra to a shared
+ * result without taking any lock: dense spectra are added bin by bin with
+ * atomic operations, and sparse spectra are pushed onto an atomic list.
+ * Only the master thread writes the spectra, using the histograms of the
+ * G4AnalysisManager.
+ *
+ * Optionally, the spectra are also published to a memory-mapped file during
+ * the run (see LiveSpectra and /analysis/histogram/live_file).
+ * Each thread adds the counts it has collected since its last publication to
+ * the file at most once per /analysis/histogram/live_interval, so the file
+ * can be viewed by another process while the simulation continues.
+ */
+class TupleManager : public AnalysisManager {
+public:
+  TupleManager();
+
+  void Book(string output_file_name) override;
+  void Save() override;
+
+  /**
+   * \param edep Energy deposition in an event, indexed by the detector ID.
+   */
+  void FillHistograms(const vector<double> &edep);
+
+private:
+  struct SparseSpectra {
+    vector<unordered_map<size_t, uint64_t>> counts;
+    SparseSpectra *next;
+  };
+
+  void FillHistogram(const size_t spectrum, const double edep) {
+    const size_t bin =
+        std::min(static_cast<size_t>(edep * inverse_bin_width), n_bins);
+    if (sparse) {
+      ++sparse_counts[spectrum][bin];
+    } else {
+      ++counts[spectrum * (n_bins + 1) + bin];
+    }
+  };
+  void Merge();
+  void Write();
+  /**
+   * \brief Add the counts since the last publication to the live spectra
+   */
+  void Publish();
+
+  DetectorGroups detector_groups;
+  size_t n_sensitive_detectors;
+  vector<int> detector_spectra; /**< Index of the spectrum of each detector,
+                                   or -1 if it belongs to another back-end. */
+  vector<string> spectrum_names;
+  size_t n_bins;
+  double e_max;
+  double inverse_bin_width;
+  bool sparse;
+  vector<uint64_t> counts;
+  vector<unordered_map<size_t, uint64_t>> sparse_counts;
+
+  // Counts of this thread at its last publication to the live spectra.
+  vector<uint64_t> published_counts;
+  vector<unordered_map<size_t, uint64_t>> published_sparse_counts;
+  uint64_t n_unpublished_events;
+  steady_clock::duration publication_interval;
+  steady_clock::time_point next_publication;
+
+  inline static unique_ptr<atomic<uint64_t>[]> merged_counts;
+  inline static atomic<SparseSpectra *> merged_sparse_counts = nullptr;
+  inline static vector<int> histogram_ids;
+  inline static unique_ptr<LiveSpectra> live_spectra;
+};
+
+} // namespace histogram
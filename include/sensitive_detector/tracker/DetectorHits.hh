@@ -0,0 +1,39 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#pragma once
+
+#include "HitArena.hh"
+
+namespace tracker {
+
+/**
+ * \brief Fields of a hit of the tracker sensitive detector
+ *
+ * A hit is a single step in a detector, described by the state of the
+ * particle at its beginning and by the energy deposited in it.
+ */
+namespace hit {
+enum Int : size_t { track_id, particle_id, detector_id, n_ints };
+enum Double : size_t { time, edep, ekin, x, y, z, px, py, pz, n_doubles };
+} // namespace hit
+
+using DetectorHits = HitArena<hit::n_ints, hit::n_doubles>;
+
+} // namespace tracker
@@ -18,18 +18,24 @@
 */
 #pragma once
 
-#include "DetectorHit.hh"
+#include "DetectorHits.hh"
 #include "NSensitiveDetector.hh"
 
+namespace tracker {
+
+/**
+ * \brief Sensitive detector that stores its hits in the DetectorHits arena of
+ * the thread
+ */
 class SensitiveDetector : public NSensitiveDetector {
 public:
   SensitiveDetector(const string &name, const string &hitsCollectionName)
-      : NSensitiveDetector(name, hitsCollectionName),
-        fDetectorHitsCollection(nullptr){};
+      : NSensitiveDetector(name, hitsCollectionName){};
 
-  void Initialize(G4HCofThisEvent *hce) override final;
+  void Initialize(G4HCofThisEvent *) override final {
+    DetectorHits::Instance().Reset();
+  };
   G4bool ProcessHits(G4Step *step, G4TouchableHistory *history) override final;
-
-protected:
-  G4THitsCollection<DetectorHit> *fDetectorHitsCollection;
 };
+
+} // namespace tracker
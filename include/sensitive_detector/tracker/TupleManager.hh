@@ -20,14 +20,42 @@
 #pragma once
 
 #include "AnalysisManager.hh"
-
+#include "DetectorHits.hh"
+
+namespace tracker {
+
+/**
+ * \brief Output of the 'tracker' sensitive detector
+ *
+ * In the compact mode (see NutrMessenger), all floating-point columns are
+ * written with single precision, and the position of a hit is stored as the
+ * difference to the position of the previous row if that row belongs to the
+ * same track in the same event.
+ * The differences are taken with respect to the position that a reader
+ * reconstructs from the single-precision values, so rounding errors do not
+ * accumulate along a track.
+ * Since this requires the rows of a thread to stay consecutive, the compact
+ * mode is only available for the native columnar output format.
+ */
 class TupleManager : public AnalysisManager {
 public:
-  TupleManager() : AnalysisManager(){};
-
-  void CreateNtupleColumns(G4AnalysisManager *analysisManager) override;
-
-  size_t FillNtupleColumns(G4AnalysisManager *analysisManager,
-                           const G4Event *event,
-                           vector<G4VHit *> hits) override;
+  TupleManager()
+      : AnalysisManager(), compact(false), previous_event_id(-1),
+        previous_track_id(-1), previous_position{} {};
+
+  void CreateNtupleColumns() override;
+
+  /**
+   * \brief Write a row for a single hit
+   */
+  void FillHit(const G4Event *event, const DetectorHits &hits,
+               const size_t hit);
+
+private:
+  bool compact;
+  int previous_event_id;
+  int previous_track_id;
+  double previous_position[3];
 };
+
+} // namespace tracker
@@ -17,11 +17,20 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
+#include <vector>
+
+using std::vector;
+
+#include "G4MultiEventAction.hh"
+#include "G4MultiRunAction.hh"
+
 #include "ActionInitialization.hh"
-#include "EventAction.hh"
+#include "Backends.hh"
 #include "NRunAction.hh"
 #include "PrimaryGeneratorAction.hh"
-#include "TupleManager.hh"
+#include "Profiler.hh"
+#include "Trace.hh"
+#include "TraceStateObserver.hh"
 
 ActionInitialization::ActionInitialization(const string out_file_name,
                                            const long seed)
@@ -31,15 +40,71 @@ ActionInitialization::ActionInitialization(const string out_file_name,
 ActionInitialization::~ActionInitialization() {}
 
 void ActionInitialization::BuildForMaster() const {
-  TupleManager *tuple = new TupleManager();
+  if (Trace::IsEnabled()) {
+    new TraceStateObserver();
+  }
 
-  SetUserAction(new NRunAction(output_file_name, tuple));
+  vector<G4UserRunAction *> run_actions;
+  for (size_t i = 0; i < Backends::Get().size(); ++i) {
+    run_actions.push_back(new NRunAction(
+        output_file_name, Backends::CreateTupleManager(i), i == 0));
+  }
+  if (Profiler::IsEnabled()) {
+    run_actions.push_back(new ProfilerRunAction());
+  }
+  SetRunActions(run_actions);
 }
 
 void ActionInitialization::Build() const {
-  TupleManager *tuple = new TupleManager();
+  // Build() is called by each worker thread before its initialization, or by
+  // the master thread of a sequential application.
+  if (Trace::IsEnabled()) {
+    new TraceStateObserver();
+  }
 
   SetUserAction(new PrimaryGeneratorAction(random_number_seed));
-  SetUserAction(new NRunAction(output_file_name, tuple));
-  SetUserAction(new EventAction(tuple));
-}
\ No newline at end of file
+
+  vector<G4UserRunAction *> run_actions;
+  vector<G4UserEventAction *> event_actions;
+  for (size_t i = 0; i < Backends::Get().size(); ++i) {
+    AnalysisManager *tuple = Backends::CreateTupleManager(i);
+    NRunAction *run_action = new NRunAction(output_file_name, tuple, i == 0);
+    NEventAction *event_action = Backends::CreateEventAction(i, tuple);
+    if (i == 0) {
+      event_action->SetRunAction(run_action);
+    }
+    run_actions.push_back(run_action);
+    event_actions.push_back(event_action);
+  }
+  if (Profiler::IsEnabled()) {
+    run_actions.push_back(new ProfilerRunAction());
+    SetUserAction(new ProfilerTrackingAction());
+    SetUserAction(new ProfilerSteppingAction());
+  }
+  SetRunActions(run_actions);
+
+  if (event_actions.size() == 1) {
+    SetUserAction(event_actions[0]);
+    return;
+  }
+  G4MultiEventAction *multi_event_action = new G4MultiEventAction();
+  for (auto event_action : event_actions) {
+    multi_event_action->push_back(G4UserEventActionUPtr(event_action));
+  }
+  SetUserAction(multi_event_action);
+}
+
+void ActionInitialization::SetRunActions(
+    const vector<G4UserRunAction *> &run_actions) const {
+  if (run_actions.size() == 1) {
+    SetUserAction(run_actions[0]);
+    return;
+  }
+  // The actions of several back-ends are called in the order of their
+  // selection, followed by the actions that do not write output.
+  G4MultiRunAction *multi_run_action = new G4MultiRunAction();
+  for (auto run_action : run_actions) {
+    multi_run_action->push_back(G4UserRunActionUPtr(run_action));
+  }
+  SetUserAction(multi_run_action);
+}
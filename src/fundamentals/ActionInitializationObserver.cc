@@ -0,0 +1,38 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "G4RunManager.hh"
+
+#include "ActionInitialization.hh"
+#include "ActionInitializationObserver.hh"
+
+ActionInitializationObserver::ActionInitializationObserver(
+    const string out_file_name, const long seed)
+    : G4VStateDependent(), random_number_seed(seed),
+      output_file_name(out_file_name), registered(false) {}
+
+G4bool ActionInitializationObserver::Notify(
+    G4ApplicationState requested_state) {
+  if (requested_state == G4State_Init && !registered) {
+    registered = true;
+    G4RunManager::GetRunManager()->SetUserInitialization(
+        new ActionInitialization(output_file_name, random_number_seed));
+  }
+  return true;
+}
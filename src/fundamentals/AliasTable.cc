@@ -0,0 +1,102 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <limits>
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "AliasTable.hh"
+
+AliasTable::AliasTable(const vector<double> &weights)
+    : probability(weights.size(), 1.), alias(weights.size()) {
+  if (weights.empty() ||
+      weights.size() > std::numeric_limits<uint32_t>::max()) {
+    throw runtime_error("AliasTable: Invalid number of weights.");
+  }
+
+  double sum = 0.;
+  for (const double weight : weights) {
+    if (!(weight >= 0.)) {
+      throw runtime_error("AliasTable: Weights must not be negative.");
+    }
+    sum += weight;
+  }
+  if (!(sum > 0.)) {
+    throw runtime_error("AliasTable: At least one weight must be positive.");
+  }
+
+  // Weights in units of the average weight. Indices with a weight below 1
+  // fill up their cell with an index with a weight above 1.
+  const size_t n = weights.size();
+  vector<double> scaled(n);
+  vector<uint32_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * static_cast<double>(n) / sum;
+    (scaled[i] < 1. ? small : large).push_back(static_cast<uint32_t>(i));
+  }
+  while (!small.empty() && !large.empty()) {
+    const uint32_t s = small.back();
+    small.pop_back();
+    const uint32_t l = large.back();
+    probability[s] = scaled[s];
+    alias[s] = l;
+    scaled[l] = (scaled[l] + scaled[s]) - 1.;
+    if (scaled[l] < 1.) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Due to rounding errors, the remaining indices may have a weight that is
+  // only close to 1.
+  for (const uint32_t i : large) {
+    alias[i] = i;
+  }
+  for (const uint32_t i : small) {
+    alias[i] = i;
+  }
+}
+
+void AliasTable::write(ostream &stream) const {
+  const uint64_t n = probability.size();
+  stream.write(reinterpret_cast<const char *>(&n), sizeof(n));
+  stream.write(reinterpret_cast<const char *>(probability.data()),
+               static_cast<std::streamsize>(n * sizeof(double)));
+  stream.write(reinterpret_cast<const char *>(alias.data()),
+               static_cast<std::streamsize>(n * sizeof(uint32_t)));
+}
+
+bool AliasTable::read(istream &stream) {
+  uint64_t n = 0;
+  stream.read(reinterpret_cast<char *>(&n), sizeof(n));
+  if (!stream || n == 0 || n > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  probability.resize(n);
+  alias.resize(n);
+  stream.read(reinterpret_cast<char *>(probability.data()),
+              static_cast<std::streamsize>(n * sizeof(double)));
+  stream.read(reinterpret_cast<char *>(alias.data()),
+              static_cast<std::streamsize>(n * sizeof(uint32_t)));
+  if (!stream) {
+    return false;
+  }
+  return std::all_of(alias.begin(), alias.end(),
+                     [n](const uint32_t index) { return index < n; });
+}
@@ -20,15 +20,245 @@
 #include <NutrMessenger.hh>
 
 NutrMessenger::NutrMessenger()
-    : dir("/analysis/"), cmd_filename("/analysis/filename", this) {
+    : dir("/analysis/"), cmd_filename("/analysis/filename", this),
+      cmd_format("/analysis/format", this), dir_ncol("/analysis/ncol/"),
+      cmd_chunk_size("/analysis/ncol/chunk_size", this),
+      cmd_compression_level("/analysis/ncol/compression_level", this),
+      cmd_writer_queue("/analysis/ncol/writer_queue", this),
+      cmd_sharding("/analysis/sharding", this),
+      cmd_shard_size("/analysis/ncol/shard_size", this),
+      cmd_merge("/analysis/ncol/merge", this),
+      cmd_zero_suppression("/analysis/zero_suppression", this),
+      cmd_hit_memory("/analysis/hit_memory", this),
+      dir_tracker("/analysis/tracker/"),
+      cmd_tracker_merge_distance("/analysis/tracker/merge_distance", this),
+      cmd_tracker_merge_time("/analysis/tracker/merge_time", this),
+      cmd_tracker_compact("/analysis/tracker/compact", this),
+      dir_histogram("/analysis/histogram/"),
+      cmd_histogram_bins("/analysis/histogram/n_bins", this),
+      cmd_histogram_maximum("/analysis/histogram/e_max", this),
+      cmd_histogram_sparse("/analysis/histogram/sparse", this),
+      cmd_histogram_live_file("/analysis/histogram/live_file", this),
+      cmd_histogram_live_interval("/analysis/histogram/live_interval", this),
+      dir_groups("/analysis/groups/"),
+      cmd_group_output("/analysis/groups/output", this),
+      cmd_group_threshold("/analysis/groups/threshold", this) {
   dir.SetGuidance("Controls for general simulation settings.");
 
   cmd_filename.SetGuidance("Set filename of simulation output.");
   cmd_filename.SetParameterName("filename", false);
+
+  cmd_format.SetGuidance(
+      "Set format of simulation output. 'geant4' uses the Geant4 analysis "
+      "manager, which determines the file type from the suffix of the output "
+      "file name. 'ncol' uses the native columnar format of nutr, which is "
+      "also selected by the suffix '.ncol' (default: geant4).");
+  cmd_format.SetParameterName("format", false);
+  cmd_format.SetCandidates("geant4 ncol");
+  cmd_format.SetDefaultValue("geant4");
+
+  dir_ncol.SetGuidance("Controls for the native columnar output format.");
+
+  cmd_chunk_size.SetGuidance(
+      "Set number of rows that are buffered by each thread before they are "
+      "compressed and written to disk (default: 16384).");
+  cmd_chunk_size.SetParameterName("chunk_size", false);
+  cmd_chunk_size.SetRange("chunk_size > 0");
+  cmd_chunk_size.SetDefaultValue(16384);
+
+  cmd_compression_level.SetGuidance(
+      "Set zlib compression level between 0 (no compression) and 9 (best "
+      "compression) (default: 1).");
+  cmd_compression_level.SetParameterName("compression_level", false);
+  cmd_compression_level.SetRange(
+      "compression_level >= 0 && compression_level <= 9");
+  cmd_compression_level.SetDefaultValue(1);
+
+  cmd_writer_queue.SetGuidance(
+      "Set number of full chunks per thread that can wait for a separate "
+      "writer thread, which compresses and writes them to disk. The thread "
+      "that processes the events only waits if all of them are occupied. A "
+      "value of 0 means that each thread compresses and writes its chunks "
+      "itself (default: 0).");
+  cmd_writer_queue.SetParameterName("writer_queue", false);
+  cmd_writer_queue.SetRange("writer_queue >= 0");
+  cmd_writer_queue.SetDefaultValue(0);
+
+  cmd_sharding.SetGuidance(
+      "If true, each worker thread writes its own output file NAME_tN instead "
+      "of sending its rows to the master thread, which merges them into a "
+      "single file. The native columnar format always writes one file per "
+      "thread (default: false).");
+  cmd_sharding.SetParameterName("sharding", false);
+  cmd_sharding.SetDefaultValue(false);
+
+  cmd_shard_size.SetGuidance(
+      "Set size in MB after which a thread closes its current output file and "
+      "continues with a new one. A size of 0 means that each thread writes a "
+      "single file (default: 0).");
+  cmd_shard_size.SetParameterName("shard_size", false);
+  cmd_shard_size.SetRange("shard_size >= 0");
+  cmd_shard_size.SetDefaultValue(0);
+
+  cmd_merge.SetGuidance(
+      "If true, the output files of all threads are merged into a single file "
+      "at the end of the run, and the files of the threads are deleted "
+      "(default: false).");
+  cmd_merge.SetParameterName("merge", false);
+  cmd_merge.SetDefaultValue(false);
+
+  cmd_zero_suppression.SetGuidance(
+      "If true, the 'event' sensitive detector stores only the IDs and energy "
+      "depositions of the detectors that were hit in an event, in the vector "
+      "columns 'deid' and 'edep', instead of one column per detector. With "
+      "the Geant4 analysis manager, this requires the ROOT format (default: "
+      "false).");
+  cmd_zero_suppression.SetParameterName("zero_suppression", false);
+  cmd_zero_suppression.SetDefaultValue(false);
+
+  cmd_hit_memory.SetGuidance(
+      "Set maximum memory in MB per thread for the hits of a single event of "
+      "the 'flux' and 'tracker' sensitive detectors. Further hits of an event "
+      "are discarded, and a warning is printed (default: 256).");
+  cmd_hit_memory.SetParameterName("hit_memory", false);
+  cmd_hit_memory.SetRange("hit_memory > 0");
+  cmd_hit_memory.SetDefaultValue(256);
+
+  dir_tracker.SetGuidance(
+      "Controls for the output of the 'tracker' sensitive detector.");
+
+  cmd_tracker_merge_distance.SetGuidance(
+      "Merge consecutive steps of a particle in the same detector into a "
+      "single hit, as long as they begin within the given distance from the "
+      "first step of the hit. The hit has the sum of their energy depositions. "
+      "A distance of 0 disables the merging (default: 0 mm).");
+  cmd_tracker_merge_distance.SetParameterName("merge_distance", false);
+  cmd_tracker_merge_distance.SetRange("merge_distance >= 0.");
+  cmd_tracker_merge_distance.SetDefaultValue(0.);
+  cmd_tracker_merge_distance.SetDefaultUnit("mm");
+
+  cmd_tracker_merge_time.SetGuidance(
+      "Set the maximum time between the first and the last step that are "
+      "merged into a single hit (default: 1 ns).");
+  cmd_tracker_merge_time.SetParameterName("merge_time", false);
+  cmd_tracker_merge_time.SetRange("merge_time >= 0.");
+  cmd_tracker_merge_time.SetDefaultValue(1.);
+  cmd_tracker_merge_time.SetDefaultUnit("ns");
+
+  cmd_tracker_compact.SetGuidance(
+      "If true, the floating-point columns are written with single precision, "
+      "and the position of a hit is stored relative to the previous hit of the "
+      "same track in the same event (default: false). Requires the native "
+      "columnar output format.");
+  cmd_tracker_compact.SetParameterName("compact", false);
+  cmd_tracker_compact.SetDefaultValue(false);
+
+  dir_histogram.SetGuidance(
+      "Controls for the energy spectra of the 'histogram' sensitive detector.");
+
+  cmd_histogram_bins.SetGuidance(
+      "Set number of bins of the energy spectrum of each detector (default: "
+      "10000).");
+  cmd_histogram_bins.SetParameterName("n_bins", false);
+  cmd_histogram_bins.SetRange("n_bins > 0");
+  cmd_histogram_bins.SetDefaultValue(10000);
+
+  cmd_histogram_maximum.SetGuidance(
+      "Set upper limit of the energy spectrum of each detector. Larger energy "
+      "depositions are counted in the overflow bin (default: 10 MeV).");
+  cmd_histogram_maximum.SetParameterName("e_max", false);
+  cmd_histogram_maximum.SetRange("e_max > 0.");
+  cmd_histogram_maximum.SetDefaultValue(10.);
+  cmd_histogram_maximum.SetDefaultUnit("MeV");
+
+  cmd_histogram_sparse.SetGuidance(
+      "If true, each thread stores only the bins of the energy spectra that "
+      "are not empty. This saves memory for a large number of bins and "
+      "detectors (default: false).");
+  cmd_histogram_sparse.SetParameterName("sparse", false);
+  cmd_histogram_sparse.SetDefaultValue(false);
+
+  cmd_histogram_live_file.SetGuidance(
+      "Set name of a file into which the energy spectra are published "
+      "periodically during the run. The file is mapped into memory and can be "
+      "read at any time, for example with 'livespectra2csv'. An empty name "
+      "disables the live spectra (default: '').");
+  cmd_histogram_live_file.SetParameterName("live_file", true);
+  cmd_histogram_live_file.SetDefaultValue("");
+
+  cmd_histogram_live_interval.SetGuidance(
+      "Set the minimum time between two publications of the energy spectra of "
+      "a thread to the live file (default: 10 s).");
+  cmd_histogram_live_interval.SetParameterName("live_interval", false);
+  cmd_histogram_live_interval.SetRange("live_interval > 0.");
+  cmd_histogram_live_interval.SetDefaultValue(10.);
+  cmd_histogram_live_interval.SetDefaultUnit("s");
+
+  dir_groups.SetGuidance(
+      "Controls for the output of detector groups, i.e. detectors with several "
+      "sensitive volumes like clover detectors.");
+
+  cmd_group_output.SetGuidance(
+      "Select whether the 'event' and 'histogram' sensitive detectors write the "
+      "energy depositions of single sensitive volumes ('detectors'), the "
+      "add-back and summed energies of detector groups ('groups'), or both. "
+      "With 'both', only groups with more than one sensitive volume are "
+      "written (default: detectors).");
+  cmd_group_output.SetParameterName("output", false);
+  cmd_group_output.SetCandidates("detectors groups both");
+  cmd_group_output.SetDefaultValue("detectors");
+
+  cmd_group_threshold.SetGuidance(
+      "Set the threshold for the energy deposition in a single sensitive "
+      "volume to contribute to the add-back energy of its group. The summed "
+      "energy contains all energy depositions (default: 0 keV).");
+  cmd_group_threshold.SetParameterName("threshold", false);
+  cmd_group_threshold.SetRange("threshold >= 0.");
+  cmd_group_threshold.SetDefaultValue(0.);
+  cmd_group_threshold.SetDefaultUnit("keV");
 }
 
 void NutrMessenger::SetNewValue(G4UIcommand *command, G4String str) {
   if (command == &cmd_filename) {
     filename = str;
+  } else if (command == &cmd_format) {
+    format = str;
+  } else if (command == &cmd_chunk_size) {
+    chunk_size = cmd_chunk_size.GetNewIntValue(str);
+  } else if (command == &cmd_compression_level) {
+    compression_level = cmd_compression_level.GetNewIntValue(str);
+  } else if (command == &cmd_writer_queue) {
+    writer_queue = cmd_writer_queue.GetNewIntValue(str);
+  } else if (command == &cmd_sharding) {
+    sharding = cmd_sharding.GetNewBoolValue(str);
+  } else if (command == &cmd_shard_size) {
+    shard_size = cmd_shard_size.GetNewIntValue(str);
+  } else if (command == &cmd_merge) {
+    merge = cmd_merge.GetNewBoolValue(str);
+  } else if (command == &cmd_zero_suppression) {
+    zero_suppression = cmd_zero_suppression.GetNewBoolValue(str);
+  } else if (command == &cmd_hit_memory) {
+    hit_memory = cmd_hit_memory.GetNewIntValue(str);
+  } else if (command == &cmd_tracker_merge_distance) {
+    tracker_merge_distance = cmd_tracker_merge_distance.GetNewDoubleValue(str);
+  } else if (command == &cmd_tracker_merge_time) {
+    tracker_merge_time = cmd_tracker_merge_time.GetNewDoubleValue(str);
+  } else if (command == &cmd_tracker_compact) {
+    tracker_compact = cmd_tracker_compact.GetNewBoolValue(str);
+  } else if (command == &cmd_histogram_bins) {
+    histogram_bins = cmd_histogram_bins.GetNewIntValue(str);
+  } else if (command == &cmd_histogram_maximum) {
+    histogram_maximum = cmd_histogram_maximum.GetNewDoubleValue(str);
+  } else if (command == &cmd_histogram_sparse) {
+    histogram_sparse = cmd_histogram_sparse.GetNewBoolValue(str);
+  } else if (command == &cmd_histogram_live_file) {
+    histogram_live_file = str;
+  } else if (command == &cmd_histogram_live_interval) {
+    histogram_live_interval =
+        cmd_histogram_live_interval.GetNewDoubleValue(str);
+  } else if (command == &cmd_group_output) {
+    group_output = str;
+  } else if (command == &cmd_group_threshold) {
+    group_threshold = cmd_group_threshold.GetNewDoubleValue(str);
   }
 }
@@ -0,0 +1,183 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <time.h>
+#include <utility>
+#include <vector>
+
+using std::fixed;
+using std::left;
+using std::ostringstream;
+using std::pair;
+using std::right;
+using std::setprecision;
+using std::setw;
+using std::vector;
+
+#include "G4StepPoint.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ios.hh"
+
+#include "Profiler.hh"
+
+G4ThreadLocal Profiler::ThreadData *Profiler::thread_data = nullptr;
+
+double Profiler::CpuTime() {
+  timespec time;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+  return static_cast<double>(time.tv_sec) + 1e-9 * time.tv_nsec;
+}
+
+void Profiler::BeginRun() {
+  const std::lock_guard<mutex> lock(results_mutex);
+  volumes.clear();
+  particles.clear();
+  processes.clear();
+}
+
+void Profiler::BeginThread() {
+  if (!thread_data) {
+    thread_data = new ThreadData;
+  }
+  *thread_data = ThreadData();
+  thread_data->countdown = sampling_period;
+}
+
+void Profiler::BeginTrack() {
+  // If the next step is sampled, start its measurement here, so that it
+  // does not include the work between two tracks. Dropping the sample
+  // instead would make fewer than one in N steps sampled.
+  if (thread_data->sample_start >= 0.) {
+    thread_data->sample_start = CpuTime();
+  }
+}
+
+void Profiler::Step(const G4Step *step) {
+  ThreadData &data = *thread_data;
+
+  double cpu_time = 0.;
+  if (data.sample_start >= 0.) {
+    cpu_time = (CpuTime() - data.sample_start) * sampling_period;
+    data.sample_start = -1.;
+  }
+  if (sampling_period > 0 && --data.countdown == 0) {
+    data.countdown = sampling_period;
+    data.sample_start = CpuTime();
+  }
+
+  const double length = step->GetStepLength();
+  const G4VPhysicalVolume *volume =
+      step->GetPreStepPoint()->GetPhysicalVolume();
+  data.volumes[volume ? volume->GetLogicalVolume() : nullptr].Add(length,
+                                                                  cpu_time);
+  data.particles[step->GetTrack()->GetParticleDefinition()].Add(length,
+                                                                cpu_time);
+  data.processes[step->GetPostStepPoint()->GetProcessDefinedStep()].Add(
+      length, cpu_time);
+}
+
+void Profiler::EndThread() {
+  if (!thread_data) {
+    return;
+  }
+
+  // Entries with the same name are combined. In a multithreaded application,
+  // each thread has its own instances of the processes.
+  const std::lock_guard<mutex> lock(results_mutex);
+  for (const auto &[volume, stats] : thread_data->volumes) {
+    volumes[volume ? volume->GetName() : "unknown"].Add(stats);
+  }
+  for (const auto &[particle, stats] : thread_data->particles) {
+    particles[particle ? particle->GetParticleName() : "unknown"].Add(stats);
+  }
+  for (const auto &[process, stats] : thread_data->processes) {
+    processes[process ? process->GetProcessName() : "unknown"].Add(stats);
+  }
+  *thread_data = ThreadData();
+}
+
+void Profiler::Print(const string &category,
+                     const map<string, Stats> &stats) {
+  Stats total;
+  vector<pair<string, Stats>> sorted;
+  for (const auto &entry : stats) {
+    total.Add(entry.second);
+    sorted.push_back(entry);
+  }
+  const bool timed = total.cpu_time > 0.;
+  std::sort(sorted.begin(), sorted.end(),
+            [timed](const auto &a, const auto &b) {
+              return timed ? a.second.cpu_time > b.second.cpu_time
+                           : a.second.n_steps > b.second.n_steps;
+            });
+
+  ostringstream report;
+  report << "Profiler: " << category << ", sorted by "
+         << (timed ? "estimated CPU time" : "number of steps") << "\n"
+         << left << setw(32) << "  name" << right << setw(14) << "steps"
+         << setw(9) << "steps %" << setw(14) << "length / m" << setw(14)
+         << "CPU time / s" << setw(9) << "CPU %" << "\n";
+  auto print = [&](const string &name, const Stats &entry) {
+    report << "  " << left << setw(30) << name << right << setw(14)
+           << entry.n_steps << fixed << setprecision(1) << setw(9)
+           << (total.n_steps > 0 ? 100. * entry.n_steps / total.n_steps : 0.)
+           << setprecision(3) << setw(14) << entry.length / m << setw(14)
+           << entry.cpu_time << setprecision(1) << setw(9)
+           << (timed ? 100. * entry.cpu_time / total.cpu_time : 0.) << "\n";
+  };
+  for (size_t i = 0; i < std::min(rows, sorted.size()); ++i) {
+    print(sorted[i].first, sorted[i].second);
+  }
+  if (sorted.size() > rows) {
+    Stats others;
+    for (size_t i = rows; i < sorted.size(); ++i) {
+      others.Add(sorted[i].second);
+    }
+    print("(" + std::to_string(sorted.size() - rows) + " others)", others);
+  }
+  print("total", total);
+  G4cout << report.str() << G4endl;
+}
+
+void Profiler::Report() {
+  const std::lock_guard<mutex> lock(results_mutex);
+  Print("logical volumes", volumes);
+  Print("particles", particles);
+  Print("processes that limited the step", processes);
+}
+
+void ProfilerRunAction::BeginOfRunAction(const G4Run *) {
+  // The master thread starts the run before the worker threads.
+  if (G4Threading::IsMasterThread()) {
+    Profiler::BeginRun();
+  }
+  Profiler::BeginThread();
+}
+
+void ProfilerRunAction::EndOfRunAction(const G4Run *) {
+  Profiler::EndThread();
+  if (G4Threading::IsMasterThread()) {
+    Profiler::Report();
+  }
+}
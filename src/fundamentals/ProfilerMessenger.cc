@@ -0,0 +1,61 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "G4ApplicationState.hh"
+
+#include "Profiler.hh"
+#include "ProfilerMessenger.hh"
+
+ProfilerMessenger::ProfilerMessenger()
+    : dir("/nutr/profiler/"), cmd_enable("/nutr/profiler/enable", this),
+      cmd_sampling("/nutr/profiler/sampling", this),
+      cmd_rows("/nutr/profiler/rows", this) {
+  dir.SetGuidance("Profiler that reports the number of steps, the track "
+                  "length, and the CPU time per logical volume, particle "
+                  "type, and process at the end of each run.");
+
+  cmd_enable.SetGuidance("If true, profile the simulation. Must be given "
+                         "before /run/initialize (default: false).");
+  cmd_enable.SetParameterName("enable", false);
+  cmd_enable.SetDefaultValue(true);
+  cmd_enable.AvailableForStates(G4State_PreInit);
+
+  cmd_sampling.SetGuidance(
+      "Measure the CPU time of every N-th step. A value of 0 disables the "
+      "measurement of the CPU time (default: 64).");
+  cmd_sampling.SetParameterName("sampling", false);
+  cmd_sampling.SetRange("sampling >= 0");
+  cmd_sampling.SetDefaultValue(64);
+
+  cmd_rows.SetGuidance("Set the maximum number of entries per category in "
+                       "the report (default: 20).");
+  cmd_rows.SetParameterName("rows", false);
+  cmd_rows.SetRange("rows > 0");
+  cmd_rows.SetDefaultValue(20);
+}
+
+void ProfilerMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  if (command == &cmd_enable) {
+    Profiler::SetEnabled(cmd_enable.GetNewBoolValue(str));
+  } else if (command == &cmd_sampling) {
+    Profiler::SetSamplingPeriod(cmd_sampling.GetNewIntValue(str));
+  } else if (command == &cmd_rows) {
+    Profiler::SetRows(cmd_rows.GetNewIntValue(str));
+  }
+}
@@ -0,0 +1,69 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <stdexcept>
+#include <string>
+
+using std::to_string;
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include "Trace.hh"
+#include "TraceStateObserver.hh"
+
+TraceStateObserver::TraceStateObserver()
+    : G4VStateDependent(), state(G4State_PreInit), initialized(false),
+      init_start(0), run_start(0) {
+  Trace::SetThreadName(G4Threading::IsWorkerThread()
+                           ? "worker " + to_string(G4Threading::G4GetThreadId())
+                           : "master");
+}
+
+G4bool TraceStateObserver::Notify(G4ApplicationState requested_state) {
+  const int64_t now = Trace::Now();
+
+  if (requested_state == G4State_Init && state != G4State_Init) {
+    init_start = now;
+  } else if (state == G4State_Init && requested_state != G4State_Init) {
+    Trace::Add(initialized ? "run initialization" : "initialization",
+               "initialization", init_start, now);
+    initialized = true;
+  }
+
+  if (requested_state == G4State_GeomClosed && state == G4State_Idle) {
+    run_start = now;
+  } else if (requested_state == G4State_Idle &&
+             (state == G4State_GeomClosed || state == G4State_EventProc)) {
+    Trace::Add("run", "run", run_start, now);
+    // The master thread writes the timeline after all threads have finished
+    // the run. A failure to write it must not abort the application.
+    if (!G4Threading::IsWorkerThread()) {
+      try {
+        Trace::Write();
+      } catch (const std::exception &error) {
+        G4cout << "Warning: " << error.what() << G4endl;
+      }
+      Trace::Clear();
+    }
+  }
+
+  state = requested_state;
+  return true;
+}
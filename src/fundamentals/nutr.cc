@@ -32,10 +32,19 @@ namespace po = boost::program_options;
 #include "G4UIExecutive.hh"
 #include "G4VisExecutive.hh"
 
-#include "ActionInitialization.hh"
+#include "ActionInitializationObserver.hh"
+#include "BackendsMessenger.hh"
+#include "Checkpoint.hh"
 #include "DetectorConstruction.hh"
+#include "DigitizerMessenger.hh"
+#include "HitFilterMessenger.hh"
 #include "NutrMessenger.hh"
+#include "PerfCountersMessenger.hh"
 #include "Physics.hh"
+#include "ProfilerMessenger.hh"
+#include "ProgressMessenger.hh"
+#include "Trace.hh"
+#include "TriggerMessenger.hh"
 
 int main(int argc, char **argv) {
   po::options_description desc("nutr: new utr - program options");
@@ -49,7 +58,25 @@ int main(int argc, char **argv) {
       "file determines the output format. If no output file name is specified, "
       "a time stamp is used. Default: \"\", i.e. use time stamp.")(
       "seed", po::value<long>()->default_value(1),
-      "Set random-number seed. Default: 1.");
+      "Set random-number seed. Default: 1.")(
+      "checkpoint-interval", po::value<double>()->default_value(0.),
+      "Time in seconds after which each thread writes a checkpoint, which "
+      "allows to resume an interrupted run. Requires the native columnar "
+      "output format. Default: 0, i.e. checkpoints are only written at the "
+      "end of a run.")(
+      "max-wallclock", po::value<double>()->default_value(0.),
+      "Time in seconds after the start of nutr after which the current run is "
+      "ended gracefully, with valid output files and checkpoints. Default: 0, "
+      "i.e. no limit.")(
+      "resume", "Resume an interrupted run from its checkpoints. The output "
+                "file name must be the same as for the interrupted run.")(
+      "trace", po::value<string>()->default_value(""),
+      "Name of a file into which a timeline of the initialization, the events, "
+      "and the output of each thread is written at the end of each run, in "
+      "the Chrome trace format. Default: \"\", i.e. no timeline.")(
+      "trace-events", po::value<unsigned long>()->default_value(1),
+      "Number of consecutive events of a thread that are combined into a "
+      "single span of the timeline. Default: 1.");
   po::variables_map vm;
   po::store(po::parse_command_line(argc, argv, desc), vm);
   po::notify(vm);
@@ -66,6 +93,17 @@ int main(int argc, char **argv) {
 
   G4Random::setTheSeed(vm["seed"].as<long>());
 
+  Checkpoint::SetInterval(vm["checkpoint-interval"].as<double>());
+  Checkpoint::SetMaxWallclock(vm["max-wallclock"].as<double>());
+  Checkpoint::SetResume(vm.count("resume"));
+  if (vm["checkpoint-interval"].as<double>() > 0. ||
+      vm["max-wallclock"].as<double>() > 0. || vm.count("resume")) {
+    Checkpoint::InstallSignalHandler();
+  }
+
+  Trace::Enable(vm["trace"].as<string>());
+  Trace::SetEventsPerSpan(vm["trace-events"].as<unsigned long>());
+
   auto *runManager =
       G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
 
@@ -75,10 +113,19 @@ int main(int argc, char **argv) {
   physicsList->SetCuts();
   runManager->SetUserInitialization(physicsList);
 
-  runManager->SetUserInitialization(new ActionInitialization(
-      vm["output"].as<string>(), vm["seed"].as<long>()));
+  // The user actions depend on macro commands, so they are only built by
+  // /run/initialize.
+  new ActionInitializationObserver(vm["output"].as<string>(),
+                                   vm["seed"].as<long>());
 
   NutrMessenger analysisMessenger;
+  TriggerMessenger triggerMessenger;
+  DigitizerMessenger digitizerMessenger;
+  HitFilterMessenger hitFilterMessenger;
+  BackendsMessenger backendsMessenger;
+  ProgressMessenger progressMessenger;
+  ProfilerMessenger profilerMessenger;
+  PerfCountersMessenger perfCountersMessenger;
 
   G4VisManager *visManager = new G4VisExecutive();
   visManager->Initialize();
@@ -17,6 +17,7 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer
 */
 
+#include <algorithm>
 #include <stdexcept>
 
 using std::runtime_error;
@@ -28,11 +29,13 @@ using std::runtime_error;
 #include "G4SystemOfUnits.hh"
 #include "G4VisAttributes.hh"
 
+#include "Backends.hh"
 #include "NDetectorConstruction.hh"
-#include "SensitiveDetector.hh"
+#include "Trace.hh"
 
 NDetectorConstruction::NDetectorConstruction()
-    : molly_x(0.), zero_degree_x(0.), zero_degree_y(30. * mm) {
+    : molly_x(0.), zero_degree_x(0.), zero_degree_y(30. * mm),
+      multiplex_sensitive_detectors(false) {
   messenger = new NDetectorConstructionMessenger(this);
 }
 
@@ -43,9 +46,25 @@ void NDetectorConstruction::RegisterSensitiveLogicalVolumes(
         "NDetectorConstruction::RegisterSensitiveLogicalVolumes() called with "
         "an empty list.");
   }
+
+  DetectorGroup group{logical_volumes[0]->GetName(), {}};
   for (auto log_vol : logical_volumes) {
+    const string name = log_vol->GetName();
+    const auto mismatch =
+        std::mismatch(group.name.begin(), group.name.end(), name.begin(),
+                      name.end())
+            .first;
+    group.name.erase(mismatch, group.name.end());
+    group.detector_ids.push_back(sensitive_logical_volumes.size());
     sensitive_logical_volumes.push_back(log_vol);
   }
+  while (!group.name.empty() && group.name.back() == '_') {
+    group.name.pop_back();
+  }
+  if (group.name.empty()) {
+    group.name = "group" + std::to_string(detector_groups.size());
+  }
+  detector_groups.push_back(group);
 }
 
 void NDetectorConstruction::ConstructBoxWorld(const double x, const double y,
@@ -64,15 +83,38 @@ void NDetectorConstruction::ConstructBoxWorld(const double x, const double y,
 }
 
 void NDetectorConstruction::ConstructSDandField() {
+  const Trace::Span span("sensitive detectors", "initialization");
 
-  SensitiveDetector *sen_det = nullptr;
+  const auto backends = Backends::Get();
+  const vector<int> assignment =
+      Backends::Assign(sensitive_logical_volumes.size());
+
+  if (multiplex_sensitive_detectors) {
+    for (size_t i = 0; i < backends.size(); ++i) {
+      const string name = backends.size() == 1
+                              ? "sensitive_detectors"
+                              : "sensitive_detectors_" + backends[i].name;
+      NSensitiveDetector *sen_det = Backends::CreateSensitiveDetector(i, name);
+      sen_det->SetLogicalVolumes(sensitive_logical_volumes);
+      G4SDManager::GetSDMpointer()->AddNewDetector(sen_det);
+      for (size_t j = 0; j < sensitive_logical_volumes.size(); ++j) {
+        if (assignment[j] == static_cast<int>(i)) {
+          SetSensitiveDetector(sensitive_logical_volumes[j], sen_det);
+        }
+      }
+    }
+    return;
+  }
 
   for (size_t i = 0; i < sensitive_logical_volumes.size(); ++i) {
-    sen_det = new SensitiveDetector(sensitive_logical_volumes[i]->GetName(),
-                                    sensitive_logical_volumes[i]->GetName());
+    if (assignment[i] < 0) {
+      continue;
+    }
+    NSensitiveDetector *sen_det = Backends::CreateSensitiveDetector(
+        assignment[i], sensitive_logical_volumes[i]->GetName());
     sen_det->SetDetectorID(i);
     G4SDManager::GetSDMpointer()->AddNewDetector(sen_det);
     SetSensitiveDetector(sensitive_logical_volumes[i]->GetName(), sen_det,
                          true);
   }
-}
\ No newline at end of file
+}
@@ -52,6 +52,16 @@ NDetectorConstructionMessenger::NDetectorConstructionMessenger(
   zero_degree_y_cmd->SetParameterName("y", false);
   zero_degree_y_cmd->SetUnitCategory("Length");
   zero_degree_y_cmd->AvailableForStates(G4State_PreInit);
+
+  multiplex_sd_cmd = new G4UIcmdWithABool("/nutr/multiplex_sd", this);
+  multiplex_sd_cmd->SetGuidance(
+      "Determines whether a single sensitive detector with a single hits "
+      "collection is used for all sensitive logical volumes (true) instead of "
+      "one per logical volume (false). This reduces the overhead per event for "
+      "a large number of detectors (default: false).");
+  multiplex_sd_cmd->SetParameterName("multiplex", false);
+  multiplex_sd_cmd->SetDefaultValue(false);
+  multiplex_sd_cmd->AvailableForStates(G4State_PreInit);
 }
 
 void NDetectorConstructionMessenger::SetNewValue(G4UIcommand *command,
@@ -68,4 +78,8 @@ void NDetectorConstructionMessenger::SetNewValue(G4UIcommand *command,
     detector_construction->set_zero_degree_y(
         zero_degree_y_cmd->GetNewDoubleValue(str));
   }
+  if (command == multiplex_sd_cmd) {
+    detector_construction->set_multiplex_sensitive_detectors(
+        multiplex_sd_cmd->GetNewBoolValue(str));
+  }
 }
\ No newline at end of file
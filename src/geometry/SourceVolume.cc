@@ -19,9 +19,12 @@
 
 #include "SourceVolume.hh"
 
-SourceVolume::SourceVolume(G4VSolid *solid, G4VPhysicalVolume *physical,
+SourceVolume::SourceVolume(const G4VPhysicalVolume *physical,
                            const double rel_int)
-    : source_solid(solid), source_physical(physical),
-      relative_intensity(rel_int) {}
-
-void SourceVolume::initialize(const int seed) { random_engine = mt19937(seed); }
\ No newline at end of file
+    : relative_intensity(rel_int), is_rotated(false) {
+  if (physical != nullptr) {
+    rotation = physical->GetObjectRotationValue();
+    translation = physical->GetObjectTranslation();
+    is_rotated = !rotation.isIdentity();
+  }
+}
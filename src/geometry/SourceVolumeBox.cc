@@ -0,0 +1,34 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "SourceVolumeBox.hh"
+
+SourceVolumeBox::SourceVolumeBox(const G4Box *box,
+                                 const G4VPhysicalVolume *physical,
+                                 const double rel_int)
+    : SourceVolume(physical, rel_int),
+      half_lengths(box->GetXHalfLength(), box->GetYHalfLength(),
+                   box->GetZHalfLength()) {}
+
+G4ThreeVector SourceVolumeBox::operator()(mt19937 &random_engine) const {
+  return to_global(G4ThreeVector(
+      (2. * uniform_random(random_engine) - 1.) * half_lengths.x(),
+      (2. * uniform_random(random_engine) - 1.) * half_lengths.y(),
+      (2. * uniform_random(random_engine) - 1.) * half_lengths.z()));
+}
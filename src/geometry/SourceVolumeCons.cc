@@ -0,0 +1,89 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <cmath>
+
+using std::max;
+
+#include "SourceVolumeCons.hh"
+
+ConeSection::ConeSection(const double _z_1, const double _inner_radius_1,
+                         const double _outer_radius_1, const double z_2,
+                         const double inner_radius_2,
+                         const double outer_radius_2)
+    : z_1(_z_1), delta_z(z_2 - _z_1), inner_radius_1(_inner_radius_1),
+      delta_inner_radius(inner_radius_2 - _inner_radius_1),
+      outer_radius_1(_outer_radius_1),
+      delta_outer_radius(outer_radius_2 - _outer_radius_1) {
+  a = outer_radius_1 * outer_radius_1 - inner_radius_1 * inner_radius_1;
+  b = 2. * (outer_radius_1 * delta_outer_radius -
+            inner_radius_1 * delta_inner_radius);
+  c = delta_outer_radius * delta_outer_radius -
+      delta_inner_radius * delta_inner_radius;
+
+  max_cross_section = max(cross_section(0.), cross_section(1.));
+  if (c != 0.) {
+    const double t_vertex = -0.5 * b / c;
+    if (t_vertex > 0. && t_vertex < 1.) {
+      max_cross_section = max(max_cross_section, cross_section(t_vertex));
+    }
+  }
+}
+
+double ConeSection::volume(const double delta_phi) const {
+  return 0.5 * delta_phi * fabs(delta_z) * (a + b / 2. + c / 3.);
+}
+
+pair<double, double> ConeSection::sample_r_z(mt19937 &random_engine) const {
+  uniform_real_distribution<double> uniform_random(0., 1.);
+
+  double t;
+  do {
+    t = uniform_random(random_engine);
+  } while (uniform_random(random_engine) * max_cross_section >
+           cross_section(t));
+
+  const double inner_radius = inner_radius_1 + t * delta_inner_radius;
+  const double outer_radius = outer_radius_1 + t * delta_outer_radius;
+  const double inner_radius_squared = inner_radius * inner_radius;
+  return {sqrt(inner_radius_squared +
+               (outer_radius * outer_radius - inner_radius_squared) *
+                   uniform_random(random_engine)),
+          z_1 + t * delta_z};
+}
+
+SourceVolumeCons::SourceVolumeCons(const G4Cons *cons,
+                                   const G4VPhysicalVolume *physical,
+                                   const double rel_int)
+    : SourceVolume(physical, rel_int),
+      section(-cons->GetZHalfLength(), cons->GetInnerRadiusMinusZ(),
+              cons->GetOuterRadiusMinusZ(), cons->GetZHalfLength(),
+              cons->GetInnerRadiusPlusZ(), cons->GetOuterRadiusPlusZ()),
+      start_phi(cons->GetStartPhiAngle()),
+      delta_phi(cons->GetDeltaPhiAngle()) {}
+
+G4ThreeVector SourceVolumeCons::operator()(mt19937 &random_engine) const {
+  const auto [random_r, random_z] = section.sample_r_z(random_engine);
+  const double random_phi =
+      start_phi + delta_phi * uniform_random(random_engine);
+
+  return to_global(G4ThreeVector(random_r * cos(random_phi),
+                                 random_r * sin(random_phi), random_z));
+}
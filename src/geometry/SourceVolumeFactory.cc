@@ -0,0 +1,58 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <memory>
+
+using std::make_shared;
+
+#include "G4LogicalVolume.hh"
+
+#include "SourceVolumeBox.hh"
+#include "SourceVolumeCons.hh"
+#include "SourceVolumeFactory.hh"
+#include "SourceVolumePolycone.hh"
+#include "SourceVolumeSolid.hh"
+#include "SourceVolumeSphere.hh"
+#include "SourceVolumeTubs.hh"
+
+shared_ptr<SourceVolume>
+SourceVolumeFactory::create(const G4VPhysicalVolume *physical,
+                            const double rel_int) {
+  const G4VSolid *solid = physical->GetLogicalVolume()->GetSolid();
+
+  if (const auto *box = dynamic_cast<const G4Box *>(solid)) {
+    return make_shared<SourceVolumeBox>(box, physical, rel_int);
+  }
+  if (const auto *tubs = dynamic_cast<const G4Tubs *>(solid)) {
+    return make_shared<SourceVolumeTubs>(tubs, physical, rel_int);
+  }
+  if (const auto *sphere = dynamic_cast<const G4Sphere *>(solid)) {
+    return make_shared<SourceVolumeSphere>(sphere, physical, rel_int);
+  }
+  if (const auto *cons = dynamic_cast<const G4Cons *>(solid)) {
+    return make_shared<SourceVolumeCons>(cons, physical, rel_int);
+  }
+  if (const auto *polycone = dynamic_cast<const G4Polycone *>(solid)) {
+    const G4PolyconeHistorical *parameters = polycone->GetOriginalParameters();
+    if (parameters != nullptr && parameters->Num_z_planes >= 2) {
+      return make_shared<SourceVolumePolycone>(polycone, physical, rel_int);
+    }
+  }
+  return make_shared<SourceVolumeSolid>(solid, physical, rel_int);
+}
@@ -0,0 +1,65 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "SourceVolumePolycone.hh"
+
+SourceVolumePolycone::SourceVolumePolycone(const G4Polycone *polycone,
+                                           const G4VPhysicalVolume *physical,
+                                           const double rel_int)
+    : SourceVolume(physical, rel_int) {
+  const G4PolyconeHistorical *parameters = polycone->GetOriginalParameters();
+  if (parameters == nullptr || parameters->Num_z_planes < 2) {
+    throw runtime_error("SourceVolumePolycone: Polycone '" +
+                        polycone->GetName() +
+                        "' is not defined by z planes. Use "
+                        "SourceVolumeSolid instead.");
+  }
+
+  start_phi = parameters->Start_angle;
+  delta_phi = parameters->Opening_angle;
+
+  vector<double> volumes;
+  for (int i = 0; i + 1 < parameters->Num_z_planes; ++i) {
+    // Planes with the same z only change the radii.
+    if (parameters->Z_values[i] == parameters->Z_values[i + 1]) {
+      continue;
+    }
+    sections.emplace_back(parameters->Z_values[i], parameters->Rmin[i],
+                          parameters->Rmax[i], parameters->Z_values[i + 1],
+                          parameters->Rmin[i + 1], parameters->Rmax[i + 1]);
+    volumes.push_back(sections.back().volume(delta_phi));
+  }
+  section_selection = AliasTable(volumes);
+}
+
+G4ThreeVector SourceVolumePolycone::operator()(mt19937 &random_engine) const {
+  const auto &section =
+      sections[section_selection(uniform_random(random_engine))];
+  const auto [random_r, random_z] = section.sample_r_z(random_engine);
+  const double random_phi =
+      start_phi + delta_phi * uniform_random(random_engine);
+
+  return to_global(G4ThreeVector(random_r * cos(random_phi),
+                                 random_r * sin(random_phi), random_z));
+}
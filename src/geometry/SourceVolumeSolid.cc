@@ -0,0 +1,80 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <cmath>
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "SourceVolumeSolid.hh"
+
+SourceVolumeSolid::SourceVolumeSolid(const G4VSolid *_solid,
+                                     const G4VPhysicalVolume *physical,
+                                     const double rel_int)
+    : SourceVolume(physical, rel_int), solid(_solid) {
+  G4ThreeVector box_max;
+  solid->BoundingLimits(box_min, box_max);
+  box_size = box_max - box_min;
+
+  // A fixed seed makes the estimate, and with it the limit for the number of
+  // trials, independent of the random number seed of the simulation.
+  mt19937 random_engine(0);
+  size_t n_inside = 0;
+  for (size_t i = 0; i < n_acceptance_samples; ++i) {
+    if (solid->Inside(sample_bounding_box(random_engine)) != kOutside) {
+      ++n_inside;
+    }
+  }
+  if (n_inside == 0) {
+    throw runtime_error("SourceVolumeSolid: None of " +
+                        std::to_string(n_acceptance_samples) +
+                        " random points in the bounding box of '" +
+                        solid->GetName() + "' is inside the solid.");
+  }
+  acceptance = static_cast<double>(n_inside) / n_acceptance_samples;
+  max_trials = static_cast<size_t>(ceil(1000. / acceptance));
+
+  if (acceptance < min_acceptance) {
+    G4cout << "Warning: Only a fraction of " << acceptance
+           << " of the bounding box of the source volume '"
+           << solid->GetName()
+           << "' is inside the solid. Sampling positions will be slow."
+           << G4endl;
+  }
+}
+
+G4ThreeVector SourceVolumeSolid::operator()(mt19937 &random_engine) const {
+  for (size_t n_trial = 0; n_trial < max_trials; ++n_trial) {
+    const G4ThreeVector position = sample_bounding_box(random_engine);
+    if (solid->Inside(position) != kOutside) {
+      return to_global(position);
+    }
+  }
+  throw runtime_error("SourceVolumeSolid: Could not sample a position in '" +
+                      solid->GetName() + "' in " + std::to_string(max_trials) +
+                      " trials.");
+}
+
+G4ThreeVector
+SourceVolumeSolid::sample_bounding_box(mt19937 &random_engine) const {
+  return G4ThreeVector(
+      box_min.x() + uniform_random(random_engine) * box_size.x(),
+      box_min.y() + uniform_random(random_engine) * box_size.y(),
+      box_min.z() + uniform_random(random_engine) * box_size.z());
+}
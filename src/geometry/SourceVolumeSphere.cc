@@ -0,0 +1,53 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <cmath>
+
+#include "SourceVolumeSphere.hh"
+
+SourceVolumeSphere::SourceVolumeSphere(const G4Sphere *sphere,
+                                       const G4VPhysicalVolume *physical,
+                                       const double rel_int)
+    : SourceVolume(physical, rel_int),
+      inner_radius_cubed(pow(sphere->GetInnerRadius(), 3)),
+      delta_radius_cubed(pow(sphere->GetOuterRadius(), 3) -
+                         inner_radius_cubed),
+      start_phi(sphere->GetStartPhiAngle()),
+      delta_phi(sphere->GetDeltaPhiAngle()),
+      start_cos_theta(cos(sphere->GetStartThetaAngle())),
+      delta_cos_theta(cos(sphere->GetStartThetaAngle() +
+                          sphere->GetDeltaThetaAngle()) -
+                      start_cos_theta) {}
+
+G4ThreeVector SourceVolumeSphere::operator()(mt19937 &random_engine) const {
+  const double random_r =
+      cbrt(inner_radius_cubed +
+           delta_radius_cubed * uniform_random(random_engine));
+  const double random_cos_theta =
+      start_cos_theta + delta_cos_theta * uniform_random(random_engine);
+  const double random_sin_theta =
+      sqrt(1. - random_cos_theta * random_cos_theta);
+  const double random_phi =
+      start_phi + delta_phi * uniform_random(random_engine);
+
+  return to_global(random_r *
+                   G4ThreeVector(random_sin_theta * cos(random_phi),
+                                 random_sin_theta * sin(random_phi),
+                                 random_cos_theta));
+}
@@ -17,44 +17,28 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <memory>
-
-using std::dynamic_pointer_cast;
-
-#include "G4PhysicalConstants.hh"
+#include <cmath>
 
 #include "SourceVolumeTubs.hh"
 
-SourceVolumeTubs::SourceVolumeTubs(G4Tubs *tubs, G4VPhysicalVolume *physical,
+SourceVolumeTubs::SourceVolumeTubs(const G4Tubs *tubs,
+                                   const G4VPhysicalVolume *physical,
                                    const double rel_int)
-    : SourceVolume(tubs, physical, rel_int) {}
-
-G4ThreeVector SourceVolumeTubs::operator()() {
-
-  shared_ptr<G4Tubs> source_tubs = dynamic_pointer_cast<G4Tubs>(source_solid);
-
-  const double min_r =
-      (source_tubs->GetInnerRadius() * source_tubs->GetInnerRadius()) /
-      (source_tubs->GetOuterRadius() * source_tubs->GetOuterRadius());
-
-  double random_r = source_tubs->GetOuterRadius() *
-                    sqrt(min_r + (1. - min_r) * uniform_random(random_engine));
-  double random_phi =
-      source_tubs->GetStartPhiAngle() +
-      uniform_random(random_engine) * source_tubs->GetDeltaPhiAngle();
-  double random_z =
-      (2. * uniform_random(random_engine) - 1.) * source_tubs->GetZHalfLength();
-
-  G4RotationMatrix rotation;
-  if (source_physical->GetRotation()) {
-    rotation = *(source_physical->GetRotation());
-  }
-  auto translation = source_physical->GetTranslation();
-
-  auto res = G4ThreeVector(random_r * cos(random_phi),
-                           random_r * sin(random_phi), random_z)
-                 .transform(rotation) +
-             translation;
-
-  return res;
+    : SourceVolume(physical, rel_int), outer_radius(tubs->GetOuterRadius()),
+      min_r((tubs->GetInnerRadius() * tubs->GetInnerRadius()) /
+            (tubs->GetOuterRadius() * tubs->GetOuterRadius())),
+      start_phi(tubs->GetStartPhiAngle()),
+      delta_phi(tubs->GetDeltaPhiAngle()),
+      z_half_length(tubs->GetZHalfLength()) {}
+
+G4ThreeVector SourceVolumeTubs::operator()(mt19937 &random_engine) const {
+  const double random_r =
+      outer_radius * sqrt(min_r + (1. - min_r) * uniform_random(random_engine));
+  const double random_phi =
+      start_phi + uniform_random(random_engine) * delta_phi;
+  const double random_z =
+      (2. * uniform_random(random_engine) - 1.) * z_half_length;
+
+  return to_global(G4ThreeVector(random_r * cos(random_phi),
+                                 random_r * sin(random_phi), random_z));
 }
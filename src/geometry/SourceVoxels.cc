@@ -0,0 +1,122 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+using std::ifstream;
+using std::lock_guard;
+using std::runtime_error;
+using std::stringstream;
+using std::to_string;
+
+#include "G4SystemOfUnits.hh"
+
+#include "SourceVoxels.hh"
+
+namespace {
+double total_activity(const vector<SourceVoxels::Voxel> &voxels) {
+  double sum = 0.;
+  for (const auto &voxel : voxels) {
+    sum += voxel.activity;
+  }
+  return sum;
+}
+
+vector<double> activities(const vector<SourceVoxels::Voxel> &voxels) {
+  vector<double> result;
+  result.reserve(voxels.size());
+  for (const auto &voxel : voxels) {
+    if (voxel.activity < 0.) {
+      throw runtime_error("SourceVoxels: Negative activity " +
+                          to_string(voxel.activity) + ".");
+    }
+    result.push_back(voxel.activity);
+  }
+  return result;
+}
+} // namespace
+
+SourceVoxels::SourceVoxels(const vector<Voxel> &voxels,
+                           const G4ThreeVector &size)
+    : SourceVolume(nullptr, total_activity(voxels)), voxel_size(size),
+      voxel_selection(activities(voxels)) {
+  centers.reserve(voxels.size());
+  for (const auto &voxel : voxels) {
+    centers.push_back(voxel.center);
+  }
+}
+
+shared_ptr<SourceVoxels> SourceVoxels::load(const string &file_name,
+                                            const G4ThreeVector &voxel_size) {
+  stringstream key;
+  key.precision(17);
+  key << file_name << ' ' << voxel_size.x() << ' ' << voxel_size.y() << ' '
+      << voxel_size.z();
+
+  const lock_guard<mutex> lock(maps_mutex);
+  const auto existing = maps.find(key.str());
+  if (existing != maps.end()) {
+    return existing->second;
+  }
+
+  ifstream file(file_name);
+  if (!file.is_open()) {
+    throw runtime_error("SourceVoxels: Could not open activity map '" +
+                        file_name + "'.");
+  }
+
+  vector<Voxel> voxels;
+  string line;
+  for (size_t n_line = 1; std::getline(file, line); ++n_line) {
+    const size_t first = line.find_first_not_of(" \t\r");
+    if (first == string::npos || line[first] == '#') {
+      continue;
+    }
+    stringstream stream(line);
+    double x, y, z, activity;
+    string rest;
+    if (!(stream >> x >> y >> z >> activity) || stream >> rest) {
+      throw runtime_error("SourceVoxels: Expected 'x y z activity' in line " +
+                          to_string(n_line) + " of '" + file_name + "'.");
+    }
+    voxels.push_back({G4ThreeVector(x * mm, y * mm, z * mm), activity});
+  }
+  if (total_activity(voxels) <= 0.) {
+    throw runtime_error("SourceVoxels: Activity map '" + file_name +
+                        "' contains no active voxels.");
+  }
+
+  auto source = std::make_shared<SourceVoxels>(voxels, voxel_size);
+  G4cout << "Read activity map '" << file_name << "' with " << source->size()
+         << " voxels." << G4endl;
+  maps[key.str()] = source;
+  return source;
+}
+
+G4ThreeVector SourceVoxels::operator()(mt19937 &random_engine) const {
+  const G4ThreeVector &center =
+      centers[voxel_selection(uniform_random(random_engine))];
+  return G4ThreeVector(
+      center.x() + (uniform_random(random_engine) - 0.5) * voxel_size.x(),
+      center.y() + (uniform_random(random_engine) - 0.5) * voxel_size.y(),
+      center.z() + (uniform_random(random_engine) - 0.5) * voxel_size.z());
+}
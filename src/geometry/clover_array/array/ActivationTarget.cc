@@ -27,6 +27,7 @@
 #include "G4VisAttributes.hh"
 
 #include "ActivationTarget.hh"
+#include "SourceVolumeFactory.hh"
 
 void ActivationTarget::Construct(const G4ThreeVector global_coordinates) {
   const double inch = 25.4 * mm;
@@ -136,4 +137,25 @@ void ActivationTarget::Construct(const G4ThreeVector global_coordinates) {
                                              0.5 * capsule_total_length -
                                              0.5 * capsule_lid_thickness),
       capsule_lid_logical, "capsule_lid", world_logical, false, 0);
-}
\ No newline at end of file
+
+  // Cavity of the capsule, which contains the activated targets. The targets
+  // and the filling material are not implemented, so the cavity is filled
+  // with the material of the world. Its only purpose is to be a source volume.
+  G4Tubs *capsule_cavity_solid =
+      new G4Tubs("capsule_cavity_solid", 0., capsule_inner_radius,
+                 0.5 * capsule_chamber_length, 0., twopi);
+  G4LogicalVolume *capsule_cavity_logical =
+      new G4LogicalVolume(capsule_cavity_solid, world_logical->GetMaterial(),
+                          "capsule_cavity_logical");
+  capsule_cavity_logical->SetVisAttributes(G4VisAttributes::GetInvisible());
+  auto *capsule_cavity_physical = new G4PVPlacement(
+      0,
+      global_coordinates + G4ThreeVector(0., 0.,
+                                         activation_target_holder_to_target -
+                                             0.5 * capsule_total_length +
+                                             capsule_bottom_thickness +
+                                             0.5 * capsule_chamber_length),
+      capsule_cavity_logical, "capsule_cavity", world_logical, false, 0);
+  source_volumes.push_back(
+      SourceVolumeFactory::create(capsule_cavity_physical, 1.));
+}
@@ -24,6 +24,7 @@
 #include "G4VisAttributes.hh"
 
 #include "ComptonMonitorTarget.hh"
+#include "SourceVolumeFactory.hh"
 
 void ComptonMonitorTarget::Construct(const G4ThreeVector global_coordinates) {
 
@@ -36,6 +37,8 @@ void ComptonMonitorTarget::Construct(const G4ThreeVector global_coordinates) {
       scattering_target_solid, nist->FindOrBuildMaterial("G4_Cu"),
       "scattering_target_logical");
   scattering_target_logical->SetVisAttributes(G4Color(1., 165. / 255., 0));
-  new G4PVPlacement(0, global_coordinates, scattering_target_logical,
-                    "scattering_target", world_logical, false, 0, false);
+  auto *scattering_target_physical =
+      new G4PVPlacement(0, global_coordinates, scattering_target_logical,
+                        "scattering_target", world_logical, false, 0, false);
+  source_volume = SourceVolumeFactory::create(scattering_target_physical, 1.);
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
 
 #include "Physics.hh"
 #include "PhysicsConfig.hh"
+#include "Trace.hh"
 
 Physics::Physics() {
 
@@ -49,6 +50,11 @@ Physics::Physics() {
   }
 }
 
+void Physics::ConstructProcess() {
+  const Trace::Span span("physics list", "initialization");
+  G4VModularPhysicsList::ConstructProcess();
+}
+
 void Physics::SetCuts() {
   G4ProductionCutsTable::GetProductionCutsTable()->SetEnergyRange(
       physics_build_options.production_cut_low_keV * keV, 1. * GeV);
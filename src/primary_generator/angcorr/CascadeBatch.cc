@@ -0,0 +1,71 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "CascadeBatch.hh"
+
+void CascadeBatch::resize(const size_t _size, const size_t n_steps) {
+  size = _size;
+  next = _size;
+  for (auto &coordinate : positions) {
+    coordinate.resize(size);
+  }
+  directions.resize(n_steps);
+  angles.resize(n_steps);
+  for (size_t step = 0; step < n_steps; ++step) {
+    for (auto &component : directions[step]) {
+      component.resize(size);
+    }
+    for (auto &angle : angles[step]) {
+      angle.resize(size);
+    }
+  }
+}
+
+void CascadeBatch::angles_to_directions(const size_t step) {
+  const double *__restrict theta = angles[step][0].data();
+  const double *__restrict phi = angles[step][1].data();
+  double *__restrict x = directions[step][0].data();
+  double *__restrict y = directions[step][1].data();
+  double *__restrict z = directions[step][2].data();
+
+  // Separate loops for each function prevent that the compiler fuses sin and
+  // cos into sincos, which has no vectorized implementation.
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i) {
+    z[i] = cos(theta[i]);
+  }
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i) {
+    x[i] = cos(phi[i]);
+  }
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i) {
+    y[i] = sin(phi[i]);
+  }
+  // The polar angle is in [0, pi], so its sine is not negative.
+#pragma omp simd
+  for (size_t i = 0; i < size; ++i) {
+    const double sin_theta = sqrt(std::max(1. - z[i] * z[i], 0.));
+    x[i] *= sin_theta;
+    y[i] *= sin_theta;
+  }
+}
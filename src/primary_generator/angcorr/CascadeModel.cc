@@ -0,0 +1,228 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string_view>
+
+using std::lock_guard;
+
+#include "CascadeModel.hh"
+#include "CascadeTableSampler.hh"
+#include "State.hh"
+
+namespace {
+template <typename F>
+void split_string_foreach(const std::string &str, const std::string &delim,
+                          F &&func) {
+  size_t start = 0;
+  size_t end = str.find(delim);
+
+  while (end != std::string::npos) {
+    func(str.substr(start, end - start));
+    start = end + delim.length();
+    end = str.find(delim, start);
+  }
+  func(str.substr(start));
+}
+
+std::pair<std::vector<State>, std::vector<double>>
+parse_cascade(const std::string &cascade) {
+  std::vector<State> states;
+  std::vector<double> deltas;
+  double last_delta = 0.;
+  bool is_first_state = true;
+
+  split_string_foreach(cascade, " ", [&](std::string_view str) {
+    str.remove_prefix(std::min(str.find_first_not_of(" "), str.size()));
+    str.remove_suffix(
+        std::min(str.size() - str.find_last_not_of(" ") - 1, str.size()));
+
+    if (str.starts_with("[") && str.ends_with("]")) {
+      str.remove_suffix(1);
+      str.remove_prefix(1);
+
+      last_delta = std::stod(std::string{str});
+    } else {
+      Parity par = parity_unknown;
+      switch (str.back()) {
+      case '+':
+        par = positive;
+        str.remove_suffix(1);
+        break;
+      case '-':
+        par = negative;
+        str.remove_suffix(1);
+        break;
+      default:
+        break;
+      }
+
+      int two_J_factor = 2;
+      if (str.ends_with("/2")) {
+        str.remove_suffix(2);
+        two_J_factor = 1;
+      }
+      int two_J = std::stoi(std::string{str});
+
+      states.emplace_back(two_J * two_J_factor, par);
+      if (!is_first_state) {
+        deltas.push_back(last_delta);
+      }
+      is_first_state = false;
+      last_delta = 0.;
+    }
+  });
+  return {states, deltas};
+}
+
+Transition get_transition(const State s1, const State s2, double delta = 0.) {
+  auto multipolarity = std::max(2, std::abs(s2.two_J - s1.two_J));
+  if (s1.parity == parity_unknown || s2.parity == parity_unknown) {
+    return Transition(multipolarity, multipolarity + 2, delta);
+  } else if ((s1.parity != s2.parity) != !(multipolarity % 4)) {
+    return Transition(electric, multipolarity, magnetic, multipolarity + 2,
+                      delta);
+  } else {
+    return Transition(magnetic, multipolarity, electric, multipolarity + 2,
+                      delta);
+  }
+}
+
+std::vector<AngularCorrelation>
+parse_angular_correlation(std::vector<State> states,
+                          std::vector<double> deltas) {
+  assert(states.size() >= 3);
+  if (deltas.size() == 0) {
+    deltas.resize(states.size() - 1, 0.);
+  }
+  assert(deltas.size() == states.size() - 1);
+
+  std::vector<AngularCorrelation> cascade;
+  cascade.reserve(states.size() - 1);
+
+  for (size_t i = 0; i + 2 < states.size(); ++i) {
+    cascade.emplace_back(AngularCorrelation{
+        states[i],
+        {{get_transition(states[i], states[i + 1], deltas[i]), states[i + 1]},
+         {get_transition(states[i + 1], states[i + 2], deltas[i + 1]),
+          states[i + 2]}}});
+  }
+  return cascade;
+}
+
+string cascade_key(const vector<State> &states, const vector<double> &deltas) {
+  std::stringstream ss;
+  ss.precision(17);
+  for (size_t i = 0; i < states.size(); ++i) {
+    ss << (i == 0 ? "" : " ") << states[i].str_rep();
+    if (i < deltas.size()) {
+      ss << " [" << deltas[i] << "]";
+    }
+  }
+  return ss.str();
+}
+} // namespace
+
+shared_ptr<const CascadeModel> CascadeModel::get(const string &cascade,
+                                                  const bool use_tables) {
+  // Parsing the string is cheap, and it makes the key independent of the
+  // formatting of the macro command.
+  auto [states, deltas] = parse_cascade(cascade);
+  const string key = cascade_key(states, deltas);
+
+  const lock_guard<mutex> lock(models_mutex);
+  const auto existing = models.find(key);
+  if (existing != models.end()) {
+    return existing->second;
+  }
+  shared_ptr<const CascadeModel> model(new CascadeModel(states, deltas));
+  model->report(use_tables);
+  models[key] = model;
+  return model;
+}
+
+CascadeModel::CascadeModel(const vector<State> &states,
+                           const vector<double> &deltas)
+    : angular_correlations(parse_angular_correlation(states, deltas)),
+      key(cascade_key(states, deltas)) {
+  std::stringstream ss;
+  ss << "Set alpaca cascade to";
+  for (auto &state : states) {
+    ss << " " << state.str_rep() << " ->";
+  }
+  ss.seekp(-3, ss.cur);
+  ss << ", with deltas";
+  for (auto delta : deltas) {
+    ss << " " << delta << ",";
+  }
+  ss.seekp(-1, ss.cur);
+  ss << ".";
+  description = ss.str();
+}
+
+void CascadeModel::report(const bool use_tables) const {
+  std::stringstream ss;
+  ss << description << "\n";
+  ss << "Acceptance probability of alpaca's rejection sampler per step:";
+  double n_evaluations = 0.;
+  double lowest_efficiency = 1.;
+  for (const auto &angular_correlation : angular_correlations) {
+    const double efficiency = rejection_efficiency(angular_correlation);
+    ss << " " << efficiency << ",";
+    n_evaluations += 1. / efficiency;
+    lowest_efficiency = std::min(lowest_efficiency, efficiency);
+  }
+  ss.seekp(-1, ss.cur);
+  ss << ".\nOn average, it evaluates the angular correlations " << n_evaluations
+     << " times per event.\n";
+  // Below this value, building the tables usually pays off within a few
+  // million events.
+  if (!use_tables && lowest_efficiency < 0.2) {
+    ss << "The table sampler (/alpaca/sampler table) is probably faster.\n";
+  }
+  std::cout << ss.str();
+}
+
+shared_ptr<const CascadeTables>
+CascadeModel::get_tables(const size_t n_bins_cos_theta,
+                         const string &cache_directory) const {
+  // Other threads that need the same tables wait until they are built.
+  const lock_guard<mutex> lock(tables_mutex);
+  auto &model_tables = tables[n_bins_cos_theta];
+  if (model_tables != nullptr) {
+    return model_tables;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  model_tables = CascadeTables::load_or_build(
+      angular_correlations, key, n_bins_cos_theta, cache_directory);
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << (model_tables->is_from_cache() ? "Read" : "Built")
+            << " alpaca sampling tables with "
+            << model_tables->get_n_bins_cos_theta() << " x "
+            << model_tables->get_n_bins_phi() << " cells per step in "
+            << elapsed.count() << " s.\n";
+  return model_tables;
+}
@@ -0,0 +1,245 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using std::ifstream;
+using std::ofstream;
+
+#include <unistd.h>
+
+#include "AngularCorrelation.hh"
+
+#include "CascadeTableSampler.hh"
+
+namespace {
+constexpr char magic[] = "nutr angular correlation tables";
+constexpr uint32_t version = 1;
+
+string cache_file_name(const string &cache_directory, const string &key) {
+  // 64-bit FNV-1a hash, which, unlike std::hash, is the same on all platforms.
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char c : key) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+  }
+  char hex[17];
+  snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+  return (std::filesystem::path(cache_directory) /
+          ("angcorr_tables_" + string(hex) + ".bin"))
+      .string();
+}
+
+// Evaluate W at the centers of equidistant bins in cos(theta) and phi.
+template <typename F>
+void for_each_cell(const size_t n_bins_cos_theta, const size_t n_bins_phi,
+                   F &&func) {
+  for (size_t i = 0; i < n_bins_cos_theta; ++i) {
+    const double theta =
+        acos(-1. + (i + 0.5) * 2. / static_cast<double>(n_bins_cos_theta));
+    for (size_t j = 0; j < n_bins_phi; ++j) {
+      func(theta, (j + 0.5) * 2. * M_PI / static_cast<double>(n_bins_phi));
+    }
+  }
+}
+} // namespace
+
+shared_ptr<const CascadeTables>
+CascadeTables::load_or_build(const vector<AngularCorrelation> &cascade,
+                             const string &key, const size_t n_bins_cos_theta,
+                             const string &cache_directory) {
+  shared_ptr<CascadeTables> tables(new CascadeTables(n_bins_cos_theta));
+  const string full_key = key + " bins " + std::to_string(n_bins_cos_theta);
+  const string file_name = cache_directory.empty()
+                               ? ""
+                               : cache_file_name(cache_directory, full_key);
+
+  if (!file_name.empty() && tables->read(file_name, full_key, cascade.size())) {
+    tables->from_cache = true;
+    return tables;
+  }
+
+  vector<double> weights(n_bins_cos_theta * tables->n_bins_phi);
+  for (const auto &angular_correlation : cascade) {
+    size_t n = 0;
+    for_each_cell(n_bins_cos_theta, tables->n_bins_phi,
+                  [&](const double theta, const double phi) {
+                    // Tiny negative values may occur due to rounding errors.
+                    weights[n++] =
+                        std::max(angular_correlation(theta, phi), 0.);
+                  });
+    tables->cells.emplace_back(weights);
+  }
+
+  if (!file_name.empty()) {
+    tables->write(file_name, full_key);
+  }
+  return tables;
+}
+
+bool CascadeTables::read(const string &file_name, const string &key,
+                         const size_t n_steps) {
+  ifstream file(file_name, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  string file_magic(sizeof(magic), '\0');
+  uint32_t file_version = 0;
+  uint64_t key_length = 0;
+  file.read(file_magic.data(), sizeof(magic));
+  file.read(reinterpret_cast<char *>(&file_version), sizeof(file_version));
+  file.read(reinterpret_cast<char *>(&key_length), sizeof(key_length));
+  if (!file || file_magic != string(magic, sizeof(magic)) ||
+      file_version != version || key_length != key.size()) {
+    return false;
+  }
+  string file_key(key_length, '\0');
+  uint64_t file_n_steps = 0;
+  file.read(file_key.data(), static_cast<std::streamsize>(key_length));
+  file.read(reinterpret_cast<char *>(&file_n_steps), sizeof(file_n_steps));
+  // The key is compared in full, so a collision of the hashes in the file
+  // names cannot return wrong tables.
+  if (!file || file_key != key || file_n_steps != n_steps) {
+    return false;
+  }
+
+  cells.resize(n_steps);
+  for (auto &step_cells : cells) {
+    if (!step_cells.read(file) ||
+        step_cells.size() != n_bins_cos_theta * n_bins_phi) {
+      cells.clear();
+      return false;
+    }
+  }
+  return true;
+}
+
+void CascadeTables::write(const string &file_name, const string &key) const {
+  // Several threads or processes may write the same file. Each writes a
+  // temporary file and renames it, which replaces the file atomically.
+  std::ostringstream temporary_file_name;
+  temporary_file_name << file_name << ".tmp" << getpid() << "_"
+                      << std::hash<std::thread::id>{}(
+                             std::this_thread::get_id());
+  {
+    ofstream file(temporary_file_name.str(), std::ios::binary);
+    const uint64_t key_length = key.size();
+    const uint64_t n_steps = cells.size();
+    file.write(magic, sizeof(magic));
+    file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    file.write(reinterpret_cast<const char *>(&key_length),
+               sizeof(key_length));
+    file.write(key.data(), static_cast<std::streamsize>(key_length));
+    file.write(reinterpret_cast<const char *>(&n_steps), sizeof(n_steps));
+    for (const auto &step_cells : cells) {
+      step_cells.write(file);
+    }
+    if (!file) {
+      // Without a cache, the tables are only built again in the next run.
+      std::cout << "Warning: CascadeTables: Could not write '"
+                << temporary_file_name.str() << "'.\n";
+      std::error_code error;
+      std::filesystem::remove(temporary_file_name.str(), error);
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_file_name.str(), file_name, error);
+}
+
+CascadeTableSampler::CascadeTableSampler(
+    shared_ptr<const CascadeTables> _tables, const int seed)
+    : tables(_tables), random_engine(seed), uniform_random(0., 1.) {}
+
+vector<array<double, 2>> CascadeTableSampler::operator()() {
+  Frame frame = lab_frame;
+  vector<array<double, 2>> theta_phi(tables->size());
+  for (size_t step = 0; step < tables->size(); ++step) {
+    const auto &direction = next_direction(frame, step);
+    double phi = atan2(direction[1], direction[0]);
+    if (phi < 0.) {
+      phi += 2. * M_PI;
+    }
+    theta_phi[step] = {acos(std::clamp(direction[2], -1., 1.)), phi};
+  }
+  return theta_phi;
+}
+
+void CascadeTableSampler::fill(CascadeBatch &batch) {
+  for (size_t i = 0; i < batch.size; ++i) {
+    Frame frame = lab_frame;
+    for (size_t step = 0; step < tables->size(); ++step) {
+      const auto &direction = next_direction(frame, step);
+      for (size_t axis = 0; axis < 3; ++axis) {
+        batch.directions[step][axis][i] = direction[axis];
+      }
+    }
+  }
+}
+
+const array<double, 3> &CascadeTableSampler::next_direction(Frame &frame,
+                                                            const size_t step) {
+  const size_t n_bins_cos_theta = tables->get_n_bins_cos_theta();
+  const size_t n_bins_phi = tables->get_n_bins_phi();
+
+  const size_t cell = tables->get_cells(step)(uniform_random(random_engine));
+  const double cos_theta =
+      -1. + (static_cast<double>(cell / n_bins_phi) +
+             uniform_random(random_engine)) *
+                2. / static_cast<double>(n_bins_cos_theta);
+  const double phi = (static_cast<double>(cell % n_bins_phi) +
+                      uniform_random(random_engine)) *
+                     2. * M_PI / static_cast<double>(n_bins_phi);
+  const double sin_theta = sqrt(std::max(1. - cos_theta * cos_theta, 0.));
+  const double cos_phi = cos(phi), sin_phi = sin(phi);
+
+  // Axes of the frame of the next step in the frame of the current step.
+  const Frame local{{{cos_theta * cos_phi, cos_theta * sin_phi, -sin_theta},
+                     {-sin_phi, cos_phi, 0.},
+                     {sin_theta * cos_phi, sin_theta * sin_phi, cos_theta}}};
+  Frame next{};
+  for (size_t axis = 0; axis < 3; ++axis) {
+    for (size_t i = 0; i < 3; ++i) {
+      next[axis][i] = local[axis][0] * frame[0][i] +
+                      local[axis][1] * frame[1][i] +
+                      local[axis][2] * frame[2][i];
+    }
+  }
+  frame = next;
+  return frame[2];
+}
+
+double rejection_efficiency(const AngularCorrelation &angular_correlation) {
+  constexpr size_t n_bins_cos_theta = 64, n_bins_phi = 128;
+  double sum = 0.;
+  for_each_cell(n_bins_cos_theta, n_bins_phi,
+                [&](const double theta, const double phi) {
+                  sum += angular_correlation(theta, phi);
+                });
+  return sum / (n_bins_cos_theta * n_bins_phi) /
+         angular_correlation.get_upper_limit();
+}
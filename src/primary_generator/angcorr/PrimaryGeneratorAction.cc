@@ -41,139 +41,42 @@ using std::vector;
 #include "G4UnitsTable.hh"
 
 #include "AngularCorrelation.hh"
+#include "CascadeModel.hh"
 #include "CascadeRejectionSampler.hh"
+#include "CascadeTableSampler.hh"
+#include "Checkpoint.hh"
 #include "NDetectorConstruction.hh"
+#include "PerfCounters.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "SourceVolume.hh"
+#include "SourceVoxels.hh"
 #include "State.hh"
 
-template <typename F>
-void split_string_foreach(const std::string &str, const std::string &delim,
-                          F &&func) {
-  size_t start = 0;
-  size_t end = str.find(delim);
-
-  while (end != std::string::npos) {
-    func(str.substr(start, end - start));
-    start = end + delim.length();
-    end = str.find(delim, start);
-  }
-  func(str.substr(start));
-}
-
-std::pair<std::vector<State>, std::vector<double>>
-parse_cascade(const std::string &cascade) {
-  std::vector<State> states;
-  std::vector<double> deltas;
-  double last_delta = 0.;
-  bool is_first_state = true;
-
-  split_string_foreach(cascade, " ", [&](std::string_view str) {
-    str.remove_prefix(std::min(str.find_first_not_of(" "), str.size()));
-    str.remove_suffix(
-        std::min(str.size() - str.find_last_not_of(" ") - 1, str.size()));
-
-    if (str.starts_with("[") && str.ends_with("]")) {
-      str.remove_suffix(1);
-      str.remove_prefix(1);
-
-      last_delta = std::stod(std::string{str});
-    } else {
-      Parity par = parity_unknown;
-      switch (str.back()) {
-      case '+':
-        par = positive;
-        str.remove_suffix(1);
-        break;
-      case '-':
-        par = negative;
-        str.remove_suffix(1);
-        break;
-      default:
-        break;
-      }
-
-      int two_J_factor = 2;
-      if (str.ends_with("/2")) {
-        str.remove_suffix(2);
-        two_J_factor = 1;
-      }
-      int two_J = std::stoi(std::string{str});
-
-      states.emplace_back(two_J * two_J_factor, par);
-      if (!is_first_state) {
-        deltas.push_back(last_delta);
-      }
-      is_first_state = false;
-      last_delta = 0.;
-    }
-  });
-  return {states, deltas};
-}
-
-Transition get_transition(const State s1, const State s2, double delta = 0.) {
-  auto multipolarity = std::max(2, std::abs(s2.two_J - s1.two_J));
-  if (s1.parity == parity_unknown || s2.parity == parity_unknown) {
-    return Transition(multipolarity, multipolarity + 2, delta);
-  } else if ((s1.parity != s2.parity) != !(multipolarity % 4)) {
-    return Transition(electric, multipolarity, magnetic, multipolarity + 2,
-                      delta);
-  } else {
-    return Transition(magnetic, multipolarity, electric, multipolarity + 2,
-                      delta);
-  }
-}
-
-std::vector<AngularCorrelation>
-parse_angular_correlation(std::vector<State> states,
-                          std::vector<double> deltas) {
-  assert(states.size() >= 3);
-  if (deltas.size() == 0) {
-    deltas.resize(states.size() - 1, 0.);
-  }
-  assert(deltas.size() == states.size() - 1);
-
-  std::vector<AngularCorrelation> cascade;
-  cascade.reserve(states.size() - 1);
-
-  for (size_t i = 0; i + 2 < states.size(); ++i) {
-    cascade.emplace_back(AngularCorrelation{
-        states[i],
-        {{get_transition(states[i], states[i + 1], deltas[i]), states[i + 1]},
-         {get_transition(states[i + 1], states[i + 2], deltas[i + 1]),
-          states[i + 2]}}});
-  }
-  return cascade;
-}
-
 PrimaryGeneratorAction::PrimaryGeneratorAction(const long seed)
     : G4VUserPrimaryGeneratorAction(),
       particle_gun(make_unique<G4ParticleGun>(1)), cas_rej_sam(nullptr),
-      force_point_source(false),
+      cas_tab_sam(nullptr), use_tables(false), table_bins(256),
+      table_cache("."), force_point_source(false), batch_size(1),
       source_volumes(((NDetectorConstruction *)G4RunManager::GetRunManager()
                           ->GetUserDetectorConstruction())
                          ->GetSourceVolumes()),
-      messenger(this), random_number_seed(seed + G4Threading::G4GetThreadId()),
+      activity_map_voxel(1. * mm, 1. * mm, 1. * mm), messenger(this),
+      thread_seed(seed + G4Threading::G4GetThreadId()), seed_segment(0),
+      random_number_seed(thread_seed),
       random_engine(random_number_seed +
                     2 * G4Threading::GetNumberOfRunningWorkerThreads()) {
 
   particle_gun->SetParticleDefinition(
       G4ParticleTable::GetParticleTable()->FindParticle("gamma"));
 
-  normalize_intensities();
-  if (!force_point_source && source_volumes.size() > 0) {
-    for (size_t i = 0; i < source_volumes.size(); ++i) {
-      source_volumes[i]->initialize(
-          random_number_seed +
-          (10 + i) * G4Threading::GetNumberOfRunningWorkerThreads());
-    }
-  }
+  initialize_sources();
 }
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event *event) {
+  const PerfCounters::Scope scope(PerfCounters::Phase::primary_generation);
 
-  if (cascade.size() != cascade_energies.size() || cascade.size() == 0)
-      [[unlikely]] {
+  if (cascade == nullptr || cascade->size() != cascade_energies.size() ||
+      cascade->size() == 0) [[unlikely]] {
     std::cerr
         << "Alpaca not initialized. Use the macro commands /alpaca/cascade and "
            "/alpaca/energies, and make sure that the number of given energies "
@@ -182,18 +85,40 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event *event) {
     return;
   }
 
-  if (!force_point_source) {
-    const double ran_uni = uniform_random(random_engine);
-    for (size_t i = 0; i < source_volumes.size(); ++i) {
-      if (ran_uni <= relative_intensities_normalized[i]) {
-        auto position = source_volumes[i]->operator()();
-        particle_gun->SetParticlePosition(position);
-        break;
+  if (Checkpoint::GetSegment() != seed_segment) [[unlikely]] {
+    seed_engines(Checkpoint::GetSegment());
+  }
+
+  if (batch_size > 1) {
+    if (batch.is_exhausted()) {
+      fill_batch();
+    }
+    const size_t i = batch.next++;
+    if (!force_point_source) {
+      particle_gun->SetParticlePosition(G4ThreeVector(
+          batch.positions[0][i], batch.positions[1][i], batch.positions[2][i]));
+    }
+    for (size_t n_transition = 0; n_transition < cascade->size();
+         ++n_transition) {
+      if (cascade_energies[n_transition] > 0.) {
+        const auto &direction = batch.directions[n_transition];
+        particle_gun->SetParticleMomentumDirection(
+            G4ThreeVector(direction[0][i], direction[1][i], direction[2][i]));
+        particle_gun->SetParticleEnergy(cascade_energies[n_transition]);
+        particle_gun->GeneratePrimaryVertex(event);
       }
     }
+    return;
+  }
+
+  if (!force_point_source) {
+    G4ThreeVector position = particle_gun->GetParticlePosition();
+    sample_position(position);
+    particle_gun->SetParticlePosition(position);
   }
 
-  vector<array<double, 2>> transitions_theta_phi = cas_rej_sam->operator()();
+  vector<array<double, 2>> transitions_theta_phi =
+      cas_tab_sam ? cas_tab_sam->operator()() : cas_rej_sam->operator()();
 
   double sine_theta;
   for (size_t n_transition = 0; n_transition < transitions_theta_phi.size();
@@ -211,20 +136,66 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event *event) {
   }
 }
 
-void PrimaryGeneratorAction::normalize_intensities() {
+void PrimaryGeneratorAction::sample_position(G4ThreeVector &position) {
+  if (source_volumes.empty()) {
+    return;
+  }
+  const auto &source_volume =
+      source_volumes[source_selection(uniform_random(random_engine))];
+  position = source_volume->operator()(random_engine);
+}
+
+void PrimaryGeneratorAction::fill_batch() {
+  batch.resize(batch_size, cascade->size());
+
+  // The random number engines of the source positions and the cascade
+  // samplers are independent, so the random numbers are drawn in the same
+  // order as without batches. The directions only agree up to rounding,
+  // because the batched conversion of the angles is compiled with fast math,
+  // and the table sampler writes the directions without the detour over
+  // theta and phi.
+  if (!force_point_source) {
+    G4ThreeVector position = particle_gun->GetParticlePosition();
+    for (size_t i = 0; i < batch.size; ++i) {
+      sample_position(position);
+      batch.positions[0][i] = position.x();
+      batch.positions[1][i] = position.y();
+      batch.positions[2][i] = position.z();
+    }
+  }
 
-  double unnormalized_intensities_sum = 0.;
-  for (size_t i = 0; i < source_volumes.size(); ++i) {
-    unnormalized_intensities_sum += source_volumes[i]->get_relative_intensity();
-    relative_intensities_normalized.push_back(unnormalized_intensities_sum);
+  if (cas_tab_sam) {
+    cas_tab_sam->fill(batch);
+  } else {
+    for (size_t i = 0; i < batch.size; ++i) {
+      const auto transitions_theta_phi = cas_rej_sam->operator()();
+      for (size_t step = 0; step < transitions_theta_phi.size(); ++step) {
+        batch.angles[step][0][i] = transitions_theta_phi[step][0];
+        batch.angles[step][1][i] = transitions_theta_phi[step][1];
+      }
+    }
+    for (size_t step = 0; step < cascade->size(); ++step) {
+      batch.angles_to_directions(step);
+    }
   }
+  batch.next = 0;
+}
+
+void PrimaryGeneratorAction::initialize_sources() {
+  // Discard the positions that were sampled from the previous sources.
+  batch.next = batch.size;
 
-  double norm_factor = 1. / unnormalized_intensities_sum;
+  if (source_volumes.empty()) {
+    source_selection = AliasTable();
+    return;
+  }
 
-  for (size_t i = 0; i < source_volumes.size(); ++i) {
-    relative_intensities_normalized[i] =
-        norm_factor * relative_intensities_normalized[i];
+  vector<double> relative_intensities;
+  relative_intensities.reserve(source_volumes.size());
+  for (const auto &source_volume : source_volumes) {
+    relative_intensities.push_back(source_volume->get_relative_intensity());
   }
+  source_selection = AliasTable(relative_intensities);
 }
 
 void PrimaryGeneratorAction::set_energies(const std::string &s_energies) {
@@ -259,29 +230,37 @@ void PrimaryGeneratorAction::set_energies(const std::string &s_energies) {
 }
 
 void PrimaryGeneratorAction::set_cascade(const std::string &s_cascade) {
-  auto [states, deltas] = parse_cascade(s_cascade);
-  cascade = parse_angular_correlation(states, deltas);
+  cascade = CascadeModel::get(s_cascade, use_tables);
+  initialize_sampler();
+}
 
-  if (G4Threading::G4GetThreadId() == 0) {
-    std::stringstream ss;
-    ss << "Set alpaca cascade to";
-    for (auto &state : states) {
-      ss << " " << state.str_rep() << " ->";
-    }
-    ss.seekp(-3, ss.cur);
-    ss << ", with deltas";
-    for (auto delta : deltas) {
-      ss << " " << delta << ",";
-    }
-    ss.seekp(-1, ss.cur);
-    ss << ".\n";
-    std::cout << ss.str();
+void PrimaryGeneratorAction::initialize_sampler() {
+  // Discard the events that were sampled with the previous sampler.
+  batch.next = batch.size;
+
+  const int seed =
+      random_number_seed + 3 * G4Threading::GetNumberOfRunningWorkerThreads();
+
+  if (!use_tables) {
+    cas_tab_sam = nullptr;
+    cas_rej_sam =
+        unique_ptr<CascadeRejectionSampler>(new CascadeRejectionSampler(
+            cascade->get_angular_correlations(), seed, {0., 0., 0.}, false));
+    return;
   }
 
-  cas_rej_sam = unique_ptr<CascadeRejectionSampler>(new CascadeRejectionSampler(
-      cascade,
-      random_number_seed + 3 * G4Threading::GetNumberOfRunningWorkerThreads(),
-      {0., 0., 0.}, false));
+  cas_rej_sam = nullptr;
+  cas_tab_sam = make_unique<CascadeTableSampler>(
+      cascade->get_tables(table_bins, table_cache), seed);
+}
+
+void PrimaryGeneratorAction::seed_engines(const int segment) {
+  seed_segment = segment;
+  random_number_seed = Checkpoint::SegmentSeed(thread_seed);
+  random_engine.seed(random_number_seed +
+                     2 * G4Threading::GetNumberOfRunningWorkerThreads());
+  // Also discards the events that were sampled with the previous seed.
+  initialize_sampler();
 }
 
 void PrimaryGeneratorAction::set_particle(const std::string &particle) {
@@ -291,4 +270,43 @@ void PrimaryGeneratorAction::set_particle(const std::string &particle) {
 
 void PrimaryGeneratorAction::set_force_point_source(bool force) {
   force_point_source = force;
+  batch.next = batch.size;
+}
+
+void PrimaryGeneratorAction::set_sampler(const std::string &sampler) {
+  use_tables = sampler == "table";
+  if (cascade != nullptr) {
+    initialize_sampler();
+  }
+}
+
+void PrimaryGeneratorAction::set_table_bins(int bins) {
+  table_bins = static_cast<size_t>(bins);
+  if (use_tables && cascade != nullptr) {
+    initialize_sampler();
+  }
+}
+
+void PrimaryGeneratorAction::set_batch_size(int size) {
+  batch_size = static_cast<size_t>(size);
+  batch.next = batch.size;
+}
+
+void PrimaryGeneratorAction::set_table_cache(const std::string &directory) {
+  table_cache = directory;
+}
+
+void PrimaryGeneratorAction::set_activity_map(const std::string &file_name) {
+  if (file_name.empty()) {
+    source_volumes = ((NDetectorConstruction *)G4RunManager::GetRunManager()
+                          ->GetUserDetectorConstruction())
+                         ->GetSourceVolumes();
+  } else {
+    source_volumes = {SourceVoxels::load(file_name, activity_map_voxel)};
+  }
+  initialize_sources();
+}
+
+void PrimaryGeneratorAction::set_activity_map_voxel(const G4ThreeVector &size) {
+  activity_map_voxel = size;
 }
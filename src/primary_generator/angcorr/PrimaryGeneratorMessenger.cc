@@ -29,7 +29,13 @@ PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(
     cmd_cascade("/alpaca/cascade", this),
     cmd_energies("/alpaca/energies", this),
     cmd_particle("/alpaca/particle", this),
-    cmd_point_source("/alpaca/point_source", this) {
+    cmd_point_source("/alpaca/point_source", this),
+    cmd_sampler("/alpaca/sampler", this),
+    cmd_table_bins("/alpaca/table_bins", this),
+    cmd_table_cache("/alpaca/table_cache", this),
+    cmd_batch_size("/alpaca/batch_size", this),
+    cmd_activity_map("/alpaca/activity_map", this),
+    cmd_activity_map_voxel("/alpaca/activity_map_voxel", this) {
   // dir = new G4UIdirectory("/alpaca/");
   dir.SetGuidance("Settings specific to the angular correlation simulation");
 
@@ -63,6 +69,57 @@ PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(
   cmd_point_source.SetGuidance("Default: false");
   cmd_point_source.SetParameterName("force_point_source", true);
   cmd_point_source.SetDefaultValue("false");
+
+  cmd_sampler.SetGuidance("Select how the directions of the cascade are sampled.");
+  cmd_sampler.SetGuidance("rejection: Rejection sampling, whose efficiency "
+                          "decreases for strongly anisotropic correlations.");
+  cmd_sampler.SetGuidance("table: Precomputed tables with a constant cost per "
+                          "event, see /alpaca/table_bins and /alpaca/table_cache.");
+  cmd_sampler.SetGuidance("Default: rejection");
+  cmd_sampler.SetParameterName("sampler", true);
+  cmd_sampler.SetCandidates("rejection table");
+  cmd_sampler.SetDefaultValue("rejection");
+
+  cmd_table_bins.SetGuidance("Number of bins in cos(theta) of the tables, which "
+                             "have twice as many bins in phi.");
+  cmd_table_bins.SetGuidance("Default: 256");
+  cmd_table_bins.SetParameterName("table_bins", true);
+  cmd_table_bins.SetRange("table_bins > 0");
+  cmd_table_bins.SetDefaultValue(256);
+
+  cmd_table_cache.SetGuidance("Directory in which tables are cached for later runs. "
+                              "Must be set before /alpaca/cascade.");
+  cmd_table_cache.SetGuidance("'none' disables the cache.");
+  cmd_table_cache.SetGuidance("Default: .");
+  cmd_table_cache.SetParameterName("table_cache", true);
+  cmd_table_cache.SetDefaultValue(".");
+
+  cmd_batch_size.SetGuidance("Number of events whose source positions and directions are "
+                             "generated at once.");
+  cmd_batch_size.SetGuidance("Batches reduce the cost per event if the generation of "
+                             "primaries dominates, for example for thin targets.");
+  cmd_batch_size.SetGuidance("A value of 1 generates each event on its own.");
+  cmd_batch_size.SetGuidance("Default: 1");
+  cmd_batch_size.SetParameterName("batch_size", true);
+  cmd_batch_size.SetRange("batch_size > 0");
+  cmd_batch_size.SetDefaultValue(1);
+
+  cmd_activity_map.SetGuidance("Emit particles from the voxels of an activity map instead of "
+                               "the source volumes of the geometry.");
+  cmd_activity_map.SetGuidance("Each line of the file contains the center of a voxel in mm "
+                               "and its activity: x y z activity");
+  cmd_activity_map.SetGuidance("Lines that start with '#' are ignored.");
+  cmd_activity_map.SetGuidance("An empty string restores the source volumes of the geometry.");
+  cmd_activity_map.SetGuidance("Default: \"\"");
+  cmd_activity_map.SetParameterName("activity_map", true);
+  cmd_activity_map.SetDefaultValue("");
+
+  cmd_activity_map_voxel.SetGuidance("Edge lengths of the voxels of the activity map. "
+                                     "Must be set before /alpaca/activity_map.");
+  cmd_activity_map_voxel.SetGuidance("Default: 1 1 1 mm");
+  cmd_activity_map_voxel.SetParameterName("dx", "dy", "dz", true);
+  cmd_activity_map_voxel.SetDefaultValue(G4ThreeVector(1., 1., 1.));
+  cmd_activity_map_voxel.SetDefaultUnit("mm");
 }
 
 void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand *command,
@@ -75,5 +132,18 @@ void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand *command,
     action->set_particle(str);
   } else if (command == &cmd_point_source) {
     action->set_force_point_source(cmd_point_source.GetNewBoolValue(str));
+  } else if (command == &cmd_sampler) {
+    action->set_sampler(str);
+  } else if (command == &cmd_table_bins) {
+    action->set_table_bins(cmd_table_bins.GetNewIntValue(str));
+  } else if (command == &cmd_table_cache) {
+    action->set_table_cache(str == "none" ? "" : str);
+  } else if (command == &cmd_batch_size) {
+    action->set_batch_size(cmd_batch_size.GetNewIntValue(str));
+  } else if (command == &cmd_activity_map) {
+    action->set_activity_map(str);
+  } else if (command == &cmd_activity_map_voxel) {
+    action->set_activity_map_voxel(
+        cmd_activity_map_voxel.GetNew3VectorValue(str));
   }
 }
@@ -22,6 +22,8 @@
 #include "G4Event.hh"
 #include "G4GeneralParticleSource.hh"
 
+#include "PerfCounters.hh"
+
 PrimaryGeneratorAction::PrimaryGeneratorAction([[maybe_unused]] const long seed)
     : G4VUserPrimaryGeneratorAction(), fParticleGun(nullptr) {
   fParticleGun = new G4GeneralParticleSource();
@@ -30,5 +32,6 @@ PrimaryGeneratorAction::PrimaryGeneratorAction([[maybe_unused]] const long seed)
 PrimaryGeneratorAction::~PrimaryGeneratorAction() { delete fParticleGun; }
 
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event *anEvent) {
+  const PerfCounters::Scope scope(PerfCounters::Phase::primary_generation);
   fParticleGun->GeneratePrimaryVertex(anEvent);
 }
\ No newline at end of file
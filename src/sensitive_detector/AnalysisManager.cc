@@ -1,23 +1,54 @@
+#include <algorithm>
 #include <ctime>
 #include <filesystem>
+#include <fstream>
+#include <thread>
 
+using std::lock_guard;
+using std::runtime_error;
+using std::ofstream;
+using std::filesystem::path;
 using std::time;
 
 #include "G4Threading.hh"
 
 #include "AnalysisManager.hh"
+#include "Checkpoint.hh"
+#include "ColumnarMerger.hh"
 #include "NutrMessenger.hh"
 #include "SensitiveDetectorBuildOptions.hh"
 
-AnalysisManager::AnalysisManager() : fFactoryOn(false) {}
+AnalysisManager::AnalysisManager()
+    : fFactoryOn(false), output_format(OutputFormat::geant4),
+      g4_analysis_manager(nullptr), ncol_file_name(""), shard_index(0),
+      max_shard_size(0), n_rows(0), backend_name(""), first_backend(true),
+      backend_detectors_complement(true), backend_file_name("") {}
 
-string AnalysisManager::create_default_file_name() const {
+void AnalysisManager::SetBackendDetectors(const vector<size_t> &detector_ids,
+                                          const bool complement) {
+  backend_detector_ids = detector_ids;
+  std::sort(backend_detector_ids.begin(), backend_detector_ids.end());
+  backend_detectors_complement = complement;
+}
+
+vector<size_t>
+AnalysisManager::GetBackendDetectors(const size_t n_detectors) const {
+  vector<size_t> detector_ids;
+  for (size_t i = 0; i < n_detectors; ++i) {
+    if (UsesDetector(i)) {
+      detector_ids.push_back(i);
+    }
+  }
+  return detector_ids;
+}
+
+string AnalysisManager::create_default_file_name(const string suffix) const {
   string prefix = to_string(time(nullptr));
-  string file_name_proposal = prefix + ".root";
+  string file_name_proposal = prefix + suffix;
   if (std::filesystem::exists(file_name_proposal)) {
     unsigned int i = 0;
     while (true) {
-      file_name_proposal = prefix + "_" + to_string(i) + ".root";
+      file_name_proposal = prefix + "_" + to_string(i) + suffix;
       if (!std::filesystem::exists(file_name_proposal)) {
         break;
       }
@@ -28,72 +59,276 @@ string AnalysisManager::create_default_file_name() const {
   return file_name_proposal;
 }
 
+string AnalysisManager::thread_local_file_name(const string file_name) const {
+  if (!G4Threading::IsWorkerThread()) {
+    return file_name;
+  }
+
+  const path file_path(file_name);
+  return (file_path.parent_path() /
+          (file_path.stem().string() + "_t" +
+           to_string(G4Threading::G4GetThreadId()) +
+           file_path.extension().string()))
+      .string();
+}
+
+string AnalysisManager::shard_file_name(const size_t index) const {
+  const string file_name = thread_local_file_name(ncol_file_name);
+  if (max_shard_size == 0) {
+    return file_name;
+  }
+
+  const path file_path(file_name);
+  return (file_path.parent_path() /
+          (file_path.stem().string() + "_" + to_string(index) +
+           file_path.extension().string()))
+      .string();
+}
+
+void AnalysisManager::open_shard() {
+  columnar_writer.Open(
+      shard_file_name(shard_index), NutrMessenger::GetChunkSize(),
+      NutrMessenger::GetCompressionLevel(), NutrMessenger::GetWriterQueue());
+}
+
+void AnalysisManager::close_shard() {
+  columnar_writer.Close();
+  thread_shards.push_back({columnar_writer.GetFileName(),
+                           G4Threading::G4GetThreadId(),
+                           columnar_writer.GetNumberOfRows(),
+                           columnar_writer.GetNumberOfBytesWritten()});
+  register_shard(thread_shards.back());
+  ++shard_index;
+  G4cout << "Created output file '" << columnar_writer.GetFileName() << "' ("
+         << columnar_writer.GetNumberOfRows() << " rows, "
+         << columnar_writer.GetNumberOfBytesWritten() << " bytes)." << G4endl;
+}
+
+void AnalysisManager::register_shard(const Shard &shard) const {
+  lock_guard<mutex> lock(shards_mutex);
+  shards[backend_name].push_back(shard);
+}
+
+string
+AnalysisManager::resolve_output_file_name(string output_file_name,
+                                          const string default_suffix) {
+
+  // The output file name is determined by the master thread. Worker threads
+  // are started after the master has booked its output, so they can simply
+  // reuse the name. This ensures that all threads of a run agree on the name
+  // even if it is derived from a time stamp.
+  if (G4Threading::IsMasterThread() && first_backend) {
+    if (!backend_name.empty() &&
+        (Checkpoint::IsPeriodic() || Checkpoint::IsResuming())) {
+      throw runtime_error("AnalysisManager: Checkpoints are not supported if "
+                          "several back-ends are combined.");
+    }
+    auto output_file_name_macro = NutrMessenger::GetFilename();
+    if (output_file_name_macro != "") {
+      output_file_name = output_file_name_macro;
+    } else if (output_file_name == "") {
+      output_file_name = create_default_file_name(default_suffix);
+    }
+    master_output_file_name = output_file_name;
+    if (Checkpoint::IsEnabled()) {
+      for (const auto &shard : Checkpoint::BeginSegment(output_file_name)) {
+        register_shard(shard);
+      }
+    }
+  }
+
+  backend_file_name = master_output_file_name;
+  if (!backend_name.empty()) {
+    const path file_path(master_output_file_name);
+    // A back-end that does not use the native columnar format keeps its own
+    // suffix.
+    const string extension = file_path.extension() == ".ncol"
+                                 ? default_suffix
+                                 : file_path.extension().string();
+    backend_file_name = (file_path.parent_path() /
+                         (file_path.stem().string() + "_" + backend_name +
+                          extension))
+                            .string();
+  }
+
+  return backend_file_name;
+}
+
 void AnalysisManager::Book(string output_file_name) {
 
-  auto output_file_name_macro = NutrMessenger::GetFilename();
-  if (output_file_name_macro != "") {
-    output_file_name = output_file_name_macro;
-  } else if (output_file_name == "") {
-    output_file_name = create_default_file_name();
-  }
-
-  G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-  // The command below merges the output created by different threads into a
-  // single file. This does not work for some file formats. Geant4 will print a
-  // warning during execution and refuse to merge the files. In principle, one
-  // could use SetNtupleMerging only if OUTPUT_FORMAT="root". However, it was
-  // chosen to keep the warning message here so that a user who has been working
-  // with OUTPUT_FORMAT="root" and switches to OUTPUT_FORMAT="csv" will not
-  // wonder why the files are not merged any more.
-  analysisManager->SetNtupleMerging(true);
-  analysisManager->OpenFile(output_file_name);
-  CreateNtupleColumns(analysisManager);
-  analysisManager->FinishNtuple();
+  output_file_name = resolve_output_file_name(
+      output_file_name,
+      NutrMessenger::GetFormat() == "ncol" ? ".ncol" : ".root");
+  n_rows = 0;
+  thread_shards.clear();
+
+  if (NutrMessenger::GetFormat() == "ncol" ||
+      path(output_file_name).extension() == ".ncol") {
+    output_format = OutputFormat::ncol;
+    columnar_writer.ResetColumns();
+    CreateNtupleColumns();
+    // Each thread that processes events writes its own file. The master
+    // thread of a multithreaded application does not process any events.
+    if (!(G4Threading::IsMultithreadedApplication() &&
+          G4Threading::IsMasterThread())) {
+      ncol_file_name = Checkpoint::SegmentFileName(
+          path(output_file_name).replace_extension(".ncol").string());
+      shard_index = 0;
+      max_shard_size = NutrMessenger::GetShardSize() * 1024 * 1024;
+      open_shard();
+    }
+    fFactoryOn = true;
+    return;
+  }
+
+  if (Checkpoint::IsPeriodic()) {
+    throw runtime_error("AnalysisManager: Periodic checkpoints require the "
+                        "native columnar output format (/analysis/format "
+                        "ncol).");
+  }
+  // There is only a single G4AnalysisManager per thread.
+  if (!backend_name.empty()) {
+    throw runtime_error("AnalysisManager: Several back-ends can only be "
+                        "combined with the native columnar output format "
+                        "(/analysis/format ncol).");
+  }
+  output_format = OutputFormat::geant4;
+  g4_analysis_manager = G4AnalysisManager::Instance();
+  // Unless sharding was requested, the command below merges the output
+  // created by different threads into a single file. This does not work for
+  // some file formats. Geant4 will print a warning during execution and refuse
+  // to merge the files. In principle, one could use SetNtupleMerging only if
+  // OUTPUT_FORMAT="root". However, it was chosen to keep the warning message
+  // here so that a user who has been working with OUTPUT_FORMAT="root" and
+  // switches to OUTPUT_FORMAT="csv" will not wonder why the files are not
+  // merged any more.
+  // In sharded mode, each worker thread writes its rows to its own file
+  // NAME_tN, which avoids that the master thread collects all rows.
+  g4_analysis_manager->SetNtupleMerging(!NutrMessenger::GetSharding());
+  g4_analysis_manager->OpenFile(Checkpoint::SegmentFileName(output_file_name));
+  CreateNtupleColumns();
+  g4_analysis_manager->FinishNtuple();
 
   fFactoryOn = true;
 }
 
-void AnalysisManager::CreateNtupleColumns(G4AnalysisManager *analysisManager) {
+void AnalysisManager::CreateNtuple(const string &name, const string &title) {
+  if (output_format == OutputFormat::geant4) {
+    g4_analysis_manager->CreateNtuple(name, title);
+  }
+}
+
+void AnalysisManager::CreateNtupleIColumn(const string &name) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.CreateColumn(name, ncol::ColumnType::Int);
+  } else {
+    g4_analysis_manager->CreateNtupleIColumn(name);
+  }
+}
+
+void AnalysisManager::CreateNtupleDColumn(const string &name) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.CreateColumn(name, ncol::ColumnType::Double);
+  } else {
+    g4_analysis_manager->CreateNtupleDColumn(name);
+  }
+}
 
-  analysisManager->CreateNtupleIColumn("evid");
+void AnalysisManager::CreateNtupleFColumn(const string &name) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.CreateColumn(name, ncol::ColumnType::Float);
+  } else {
+    g4_analysis_manager->CreateNtupleFColumn(name);
+  }
+}
+
+void AnalysisManager::CreateNtupleIVColumn(const string &name,
+                                           vector<int> &values) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.CreateColumn(name, ncol::ColumnType::IntVector);
+  } else {
+    g4_analysis_manager->CreateNtupleIColumn(name, values);
+  }
+}
+
+void AnalysisManager::CreateNtupleDVColumn(const string &name,
+                                           vector<double> &values) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.CreateColumn(name, ncol::ColumnType::DoubleVector);
+  } else {
+    g4_analysis_manager->CreateNtupleDColumn(name, values);
+  }
+}
+
+void AnalysisManager::FillNtupleDColumns(const size_t first_col,
+                                         const double *values,
+                                         const size_t n_values) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.FillD(first_col, values, n_values);
+  } else {
+    for (size_t i = 0; i < n_values; ++i) {
+      g4_analysis_manager->FillNtupleDColumn(0, first_col + i, values[i]);
+    }
+  }
+}
+
+void AnalysisManager::CreateNtupleColumns() {
+
+  CreateNtupleIColumn("evid");
 
   if constexpr (sensitive_detector_build_options.track_primary) {
-    analysisManager->CreateNtupleDColumn("pos0x");
-    analysisManager->CreateNtupleDColumn("pos0y");
-    analysisManager->CreateNtupleDColumn("pos0z");
-    analysisManager->CreateNtupleDColumn("mom0x");
-    analysisManager->CreateNtupleDColumn("mom0y");
-    analysisManager->CreateNtupleDColumn("mom0z");
+    CreateNtupleDColumn("pos0x");
+    CreateNtupleDColumn("pos0y");
+    CreateNtupleDColumn("pos0z");
+    CreateNtupleDColumn("mom0x");
+    CreateNtupleDColumn("mom0y");
+    CreateNtupleDColumn("mom0z");
   }
 }
 
-void AnalysisManager::FillNtuple(const G4Event *event, vector<G4VHit *> hits) {
+void AnalysisManager::FillNtuple(const G4Event *event,
+                                 const vector<G4VHit *> &hits) {
+
+  FillNtupleColumns(event, hits);
+  AddNtupleRow();
+}
 
-  G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-  FillNtupleColumns(analysisManager, event, hits);
-  analysisManager->AddNtupleRow(0);
+void AnalysisManager::AddNtupleRow(const bool end_of_event) {
+  if (output_format == OutputFormat::ncol) {
+    columnar_writer.AddRow();
+    // The number of bytes written only changes when a chunk is flushed, so a
+    // shard is always closed after a complete chunk. With a writer thread, the
+    // number lags behind by the chunks that are still queued.
+    if (end_of_event && max_shard_size &&
+        columnar_writer.GetNumberOfBytesWritten() >= max_shard_size) {
+      close_shard();
+      open_shard();
+    }
+  } else {
+    g4_analysis_manager->AddNtupleRow(0);
+    ++n_rows;
+  }
 }
 
-size_t
-AnalysisManager::FillNtupleColumns(G4AnalysisManager *analysisManager,
-                                   const G4Event *event,
-                                   [[maybe_unused]] vector<G4VHit *> hits) {
+size_t AnalysisManager::FillNtupleColumns(
+    const G4Event *event, [[maybe_unused]] const vector<G4VHit *> &hits) {
 
   size_t col = 0;
-  analysisManager->FillNtupleIColumn(0, col++, event->GetEventID());
+  FillNtupleIColumn(col++,
+                    event->GetEventID() + Checkpoint::GetEventIDOffset());
 
   if constexpr (sensitive_detector_build_options.track_primary) {
     const G4PrimaryVertex *primary_vertex = event->GetPrimaryVertex(0);
     if (primary_vertex != nullptr) {
-      analysisManager->FillNtupleDColumn(0, col++, primary_vertex->GetX0());
-      analysisManager->FillNtupleDColumn(0, col++, primary_vertex->GetY0());
-      analysisManager->FillNtupleDColumn(0, col++, primary_vertex->GetZ0());
+      FillNtupleDColumn(col++, primary_vertex->GetX0());
+      FillNtupleDColumn(col++, primary_vertex->GetY0());
+      FillNtupleDColumn(col++, primary_vertex->GetZ0());
 
       const G4PrimaryParticle *primary_particle = primary_vertex->GetPrimary();
       if (primary_particle != nullptr) {
-        analysisManager->FillNtupleDColumn(0, col++, primary_particle->GetPx());
-        analysisManager->FillNtupleDColumn(0, col++, primary_particle->GetPy());
-        analysisManager->FillNtupleDColumn(0, col++, primary_particle->GetPz());
+        FillNtupleDColumn(col++, primary_particle->GetPx());
+        FillNtupleDColumn(col++, primary_particle->GetPy());
+        FillNtupleDColumn(col++, primary_particle->GetPz());
       } else {
         col += 3;
       }
@@ -110,14 +345,135 @@ void AnalysisManager::Save() {
   if (!fFactoryOn)
     return;
 
-  G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-  analysisManager->Write();
-  analysisManager->CloseFile();
+  if (output_format == OutputFormat::ncol) {
+    if (columnar_writer.IsOpen()) {
+      // A shard that was opened by a rollover directly before the end of the
+      // run may be empty.
+      if (shard_index > 0 && columnar_writer.GetNumberOfRows() == 0) {
+        columnar_writer.Close();
+        std::filesystem::remove(columnar_writer.GetFileName());
+      } else {
+        close_shard();
+      }
+    }
+    fFactoryOn = false;
+    return;
+  }
+
+  g4_analysis_manager->Write();
+  g4_analysis_manager->CloseFile();
+
+  if (NutrMessenger::GetSharding() &&
+      !(G4Threading::IsMultithreadedApplication() &&
+        G4Threading::IsMasterThread())) {
+    // Geant4 appends the default file type if the file name has no suffix.
+    path file_path(Checkpoint::SegmentFileName(backend_file_name));
+    if (!file_path.has_extension()) {
+      file_path += "." + g4_analysis_manager->GetFileType();
+    }
+    const string file_name = thread_local_file_name(file_path.string());
+    thread_shards.push_back({file_name, G4Threading::G4GetThreadId(), n_rows,
+                             std::filesystem::exists(file_name)
+                                 ? std::filesystem::file_size(file_name)
+                                 : 0});
+    register_shard(thread_shards.back());
+  }
 
   if (G4Threading::G4GetThreadId() == 0) {
-    G4cout << "Created output file '" << analysisManager->GetFileName() << "'."
-           << G4endl;
+    G4cout << "Created output file '" << g4_analysis_manager->GetFileName()
+           << "'." << G4endl;
   }
 
   fFactoryOn = false;
 }
+
+void AnalysisManager::WriteCheckpoint() {
+  // The master thread of a multithreaded application does not process any
+  // events. It only needs a checkpoint for the output files that it writes
+  // itself, like the spectra of the 'histogram' back-end.
+  if (G4Threading::IsMultithreadedApplication() &&
+      G4Threading::IsMasterThread() && thread_shards.empty()) {
+    return;
+  }
+
+  vector<Shard> checkpoint_shards = thread_shards;
+  if (fFactoryOn) {
+    if (output_format != OutputFormat::ncol) {
+      return;
+    }
+    columnar_writer.Sync();
+    checkpoint_shards.push_back({columnar_writer.GetFileName(),
+                                 G4Threading::G4GetThreadId(),
+                                 columnar_writer.GetNumberOfRows(),
+                                 columnar_writer.GetNumberOfBytesWritten()});
+  }
+  Checkpoint::Write(checkpoint_shards);
+}
+
+namespace {
+string json_string(const string &str) {
+  string escaped = "\"";
+  for (const auto c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped + "\"";
+}
+} // namespace
+
+void AnalysisManager::FinishRun(const int run_id) {
+
+  vector<Shard> run_shards;
+  {
+    lock_guard<mutex> lock(shards_mutex);
+    run_shards.swap(shards[backend_name]);
+  }
+  if (run_shards.empty()) {
+    return;
+  }
+  std::sort(run_shards.begin(), run_shards.end(),
+            [](const Shard &a, const Shard &b) {
+              return a.thread_id != b.thread_id ? a.thread_id < b.thread_id
+                                                : a.file_name < b.file_name;
+            });
+
+  const path output_file_path(backend_file_name);
+  const bool ncol = output_format == OutputFormat::ncol;
+
+  if (ncol && NutrMessenger::GetMerge() && run_shards.size() > 1) {
+    const string merged_file_name =
+        path(output_file_path).replace_extension(".ncol").string();
+    vector<string> file_names;
+    for (const auto &shard : run_shards) {
+      file_names.push_back(shard.file_name);
+    }
+    const uint64_t n_merged_rows = ncol::merge(
+        file_names, merged_file_name, std::thread::hardware_concurrency());
+    for (const auto &file_name : file_names) {
+      std::filesystem::remove(file_name);
+    }
+    run_shards = {{merged_file_name, -1, n_merged_rows,
+                   std::filesystem::file_size(merged_file_name)}};
+    G4cout << "Merged " << file_names.size() << " output files into '"
+           << merged_file_name << "' (" << n_merged_rows << " rows)." << G4endl;
+  }
+
+  const string manifest_file_name =
+      (output_file_path.parent_path() /
+       (output_file_path.stem().string() + "_manifest.json"))
+          .string();
+  ofstream manifest(manifest_file_name);
+  manifest << "{\n  \"run\": " << run_id << ",\n  \"format\": "
+           << json_string(ncol ? "ncol" : "geant4") << ",\n  \"shards\": [";
+  for (size_t i = 0; i < run_shards.size(); ++i) {
+    manifest << (i ? "," : "") << "\n    {\"file\": "
+             << json_string(run_shards[i].file_name)
+             << ", \"thread\": " << run_shards[i].thread_id
+             << ", \"rows\": " << run_shards[i].n_rows
+             << ", \"bytes\": " << run_shards[i].n_bytes << "}";
+  }
+  manifest << "\n  ]\n}\n";
+  G4cout << "Created manifest '" << manifest_file_name << "'." << G4endl;
+}
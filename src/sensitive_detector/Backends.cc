@@ -0,0 +1,217 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <iterator>
+#include <stdexcept>
+
+using std::runtime_error;
+using std::to_string;
+
+#include "G4ios.hh"
+
+#include "Backends.hh"
+#include "EnergySensitiveDetector.hh"
+#include "SensitiveDetectorBuildOptions.hh"
+#include "edep/EventAction.hh"
+#include "edep/TupleManager.hh"
+#include "event/EventAction.hh"
+#include "event/TupleManager.hh"
+#include "flux/EventAction.hh"
+#include "flux/SensitiveDetector.hh"
+#include "flux/TupleManager.hh"
+#include "histogram/EventAction.hh"
+#include "histogram/TupleManager.hh"
+#include "tracker/EventAction.hh"
+#include "tracker/SensitiveDetector.hh"
+#include "tracker/TupleManager.hh"
+
+namespace {
+// Names of the back-ends in the order of Backends::Type.
+const string type_names[] = {"edep", "event", "flux", "histogram", "tracker"};
+} // namespace
+
+Backends::Type Backends::ParseType(const string &name) {
+  for (size_t i = 0; i < std::size(type_names); ++i) {
+    if (type_names[i] == name) {
+      return static_cast<Type>(i);
+    }
+  }
+  throw runtime_error("Backends: Unknown back-end '" + name +
+                      "'. Possible choices: edep, event, flux, histogram, "
+                      "tracker.");
+}
+
+void Backends::Add(const string &name, const vector<size_t> &detector_ids) {
+  const Type type = ParseType(name);
+  for (const auto &backend : backends) {
+    if (backend.type == type) {
+      throw runtime_error("Backends: The back-end '" + name +
+                          "' was already selected.");
+    }
+  }
+  backends.push_back({type, name, detector_ids});
+}
+
+void Backends::Reset() { backends.clear(); }
+
+void Backends::Print() {
+  G4cout << "Sensitive-detector back-ends:";
+  for (const auto &backend : Get()) {
+    G4cout << " " << backend.name << " (detectors";
+    if (backend.detector_ids.empty()) {
+      G4cout << " all remaining";
+    }
+    for (const auto detector_id : backend.detector_ids) {
+      G4cout << " " << detector_id;
+    }
+    G4cout << ")";
+  }
+  G4cout << G4endl;
+}
+
+vector<Backends::Backend> Backends::Get() {
+  if (backends.empty()) {
+    const string name = sensitive_detector_build_options.default_backend;
+    return {{ParseType(name), name, {}}};
+  }
+  return backends;
+}
+
+vector<int> Backends::Assign(const size_t n_detectors) {
+  const vector<Backend> selected = Get();
+  vector<int> assignment(n_detectors, -1);
+  int remaining = -1;
+
+  for (size_t i = 0; i < selected.size(); ++i) {
+    if (selected[i].detector_ids.empty()) {
+      if (remaining >= 0) {
+        throw runtime_error("Backends: Only one back-end can be used for all "
+                            "remaining detectors, but both '" +
+                            selected[remaining].name + "' and '" +
+                            selected[i].name + "' are.");
+      }
+      remaining = static_cast<int>(i);
+      continue;
+    }
+    for (const auto detector_id : selected[i].detector_ids) {
+      if (detector_id >= n_detectors) {
+        throw runtime_error("Backends: Detector " + to_string(detector_id) +
+                            " of back-end '" + selected[i].name +
+                            "' does not exist.");
+      }
+      if (assignment[detector_id] >= 0) {
+        throw runtime_error("Backends: Detector " + to_string(detector_id) +
+                            " is used by both back-ends '" +
+                            selected[assignment[detector_id]].name +
+                            "' and '" + selected[i].name + "'.");
+      }
+      assignment[detector_id] = static_cast<int>(i);
+    }
+  }
+
+  if (remaining >= 0) {
+    for (auto &backend_index : assignment) {
+      if (backend_index < 0) {
+        backend_index = remaining;
+      }
+    }
+  }
+
+  return assignment;
+}
+
+NSensitiveDetector *Backends::CreateSensitiveDetector(const size_t index,
+                                                      const string &name) {
+  switch (Get()[index].type) {
+  case Type::edep:
+  case Type::event:
+  case Type::histogram:
+    return new EnergySensitiveDetector(name, name);
+  case Type::flux:
+    return new flux::SensitiveDetector(name, name);
+  case Type::tracker:
+    return new tracker::SensitiveDetector(name, name);
+  }
+  return nullptr;
+}
+
+AnalysisManager *Backends::CreateTupleManager(const size_t index) {
+  const vector<Backend> selected = Get();
+
+  AnalysisManager *tuple_manager = nullptr;
+  switch (selected[index].type) {
+  case Type::edep:
+    tuple_manager = new edep::TupleManager();
+    break;
+  case Type::event:
+    tuple_manager = new event::TupleManager();
+    break;
+  case Type::flux:
+    tuple_manager = new flux::TupleManager();
+    break;
+  case Type::histogram:
+    tuple_manager = new histogram::TupleManager();
+    break;
+  case Type::tracker:
+    tuple_manager = new tracker::TupleManager();
+    break;
+  }
+  tuple_manager->SetBackend(selected.size() > 1 ? selected[index].name : "",
+                            index == 0);
+
+  // A back-end for all remaining detectors excludes the detectors of all
+  // other back-ends.
+  if (!selected[index].detector_ids.empty()) {
+    tuple_manager->SetBackendDetectors(selected[index].detector_ids, false);
+  } else {
+    vector<size_t> other_detector_ids;
+    for (size_t i = 0; i < selected.size(); ++i) {
+      if (i != index) {
+        other_detector_ids.insert(other_detector_ids.end(),
+                                  selected[i].detector_ids.begin(),
+                                  selected[i].detector_ids.end());
+      }
+    }
+    tuple_manager->SetBackendDetectors(other_detector_ids, true);
+  }
+
+  return tuple_manager;
+}
+
+NEventAction *Backends::CreateEventAction(const size_t index,
+                                          AnalysisManager *tuple_manager) {
+  switch (Get()[index].type) {
+  case Type::edep:
+    return new edep::EventAction(
+        static_cast<edep::TupleManager *>(tuple_manager));
+  case Type::event:
+    return new event::EventAction(
+        static_cast<event::TupleManager *>(tuple_manager));
+  case Type::flux:
+    return new flux::EventAction(
+        static_cast<flux::TupleManager *>(tuple_manager));
+  case Type::histogram:
+    return new histogram::EventAction(
+        static_cast<histogram::TupleManager *>(tuple_manager));
+  case Type::tracker:
+    return new tracker::EventAction(
+        static_cast<tracker::TupleManager *>(tuple_manager));
+  }
+  return nullptr;
+}
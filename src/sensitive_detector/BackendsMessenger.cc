@@ -0,0 +1,90 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::istringstream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+#include "G4ApplicationState.hh"
+
+#include "Backends.hh"
+#include "BackendsMessenger.hh"
+
+BackendsMessenger::BackendsMessenger()
+    : dir("/nutr/backend/"), cmd_add("/nutr/backend/add", this),
+      cmd_reset("/nutr/backend/reset", this),
+      cmd_print("/nutr/backend/print", this) {
+  dir.SetGuidance(
+      "Selection of the sensitive-detector back-ends. By default, all "
+      "detectors use the back-end of the SENSITIVE_DETECTOR_DIR build option. "
+      "Back-ends must be selected before /run/initialize.");
+
+  cmd_add.SetGuidance(
+      "Use a back-end (edep, event, flux, histogram, or tracker) for the "
+      "given detectors, or for all detectors that do not use any other "
+      "back-end if no detector is given. Parameters: NAME [DETECTOR_ID ...], "
+      "for example 'flux 12'.");
+  cmd_add.SetParameterName("backend", false);
+  cmd_add.AvailableForStates(G4State_PreInit);
+
+  cmd_reset.SetGuidance("Use the default back-end for all detectors again.");
+  cmd_reset.AvailableForStates(G4State_PreInit);
+
+  cmd_print.SetGuidance("Print the current selection.");
+}
+
+void BackendsMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  istringstream stream(str);
+
+  if (command == &cmd_add) {
+    string name;
+    stream >> name;
+    vector<size_t> detector_ids;
+    size_t detector_id;
+    while (stream >> detector_id) {
+      detector_ids.push_back(detector_id);
+    }
+    if (!stream.eof()) {
+      G4ExceptionDescription description;
+      description << "/nutr/backend/add: Expected NAME [DETECTOR_ID ...], got '"
+                  << str << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    // An exception would terminate the application, even in an interactive
+    // session.
+    try {
+      Backends::Add(name, detector_ids);
+    } catch (const runtime_error &error) {
+      G4ExceptionDescription description;
+      description << error.what();
+      command->CommandFailed(description);
+    }
+  } else if (command == &cmd_reset) {
+    Backends::Reset();
+  } else if (command == &cmd_print) {
+    Backends::Print();
+  }
+}
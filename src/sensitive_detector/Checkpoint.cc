@@ -0,0 +1,273 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+using std::ifstream;
+using std::istringstream;
+using std::ofstream;
+using std::runtime_error;
+using std::filesystem::path;
+using std::chrono::duration;
+using std::chrono::steady_clock;
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include "Checkpoint.hh"
+
+namespace {
+const steady_clock::time_point program_start = steady_clock::now();
+G4ThreadLocal double next_checkpoint = 0.;
+// Events are counted when they start. Since checkpoints are only written
+// between events, all counted events are completed when a checkpoint is
+// written.
+G4ThreadLocal uint64_t n_events_completed = 0;
+
+double seconds_since_start() {
+  return duration<double>(steady_clock::now() - program_start).count();
+}
+
+void handle_signal(int) { Checkpoint::RequestStop(); }
+
+// splitmix64
+long mix_seed(const long seed, const int segment) {
+  uint64_t z = static_cast<uint64_t>(seed) + 0x9e3779b97f4a7c15 * segment;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+  return static_cast<long>((z ^ (z >> 31)) >> 33);
+}
+} // namespace
+
+void Checkpoint::InstallSignalHandler() { std::signal(SIGTERM, handle_signal); }
+
+long Checkpoint::SegmentSeed(const long seed) {
+  return segment == 0 ? seed : mix_seed(seed, segment);
+}
+
+void Checkpoint::BeginRun(const int n_events) {
+  n_events_requested = n_events;
+  n_events_remaining = n_events;
+  n_events_claimed = 0;
+}
+
+string Checkpoint::ThreadFileName(const string &suffix) {
+  if (!G4Threading::IsWorkerThread()) {
+    return base_name + "_checkpoint_main" + suffix;
+  }
+  return base_name + "_checkpoint_t" +
+         std::to_string(G4Threading::G4GetThreadId()) + suffix;
+}
+
+vector<string> Checkpoint::ThreadFileNames() {
+  const path base_path(base_name);
+  const path directory =
+      base_path.has_parent_path() ? base_path.parent_path() : path(".");
+  const string prefix = base_path.filename().string() + "_checkpoint_";
+
+  vector<string> file_names;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    const string file_name = entry.path().filename().string();
+    if (file_name.starts_with(prefix) && entry.path().extension() == ".txt") {
+      file_names.push_back(entry.path().string());
+    }
+  }
+  std::sort(file_names.begin(), file_names.end());
+  return file_names;
+}
+
+Checkpoint::Record Checkpoint::Read(const string &file_name) {
+  ifstream file(file_name);
+  string line, key;
+  if (!std::getline(file, line) || line != "nutr_checkpoint 1") {
+    throw runtime_error("Checkpoint: '" + file_name +
+                        "' is not a checkpoint file.");
+  }
+
+  Record record;
+  while (std::getline(file, line)) {
+    istringstream stream(line);
+    stream >> key;
+    if (key == "segment") {
+      stream >> record.segment;
+    } else if (key == "events") {
+      stream >> record.n_events;
+    } else if (key == "event_ids") {
+      stream >> record.n_event_ids;
+    } else if (key == "shard") {
+      Shard shard;
+      stream >> shard.thread_id >> shard.n_rows >> shard.n_bytes >> std::ws;
+      std::getline(stream, shard.file_name);
+      record.shards.push_back(shard);
+    }
+    if (stream.fail()) {
+      throw runtime_error("Checkpoint: Corrupt line '" + line + "' in '" +
+                          file_name + "'.");
+    }
+  }
+  return record;
+}
+
+void Checkpoint::Write(const string &file_name, const Record &record) {
+  // Write to a temporary file first, so that an interruption never leaves an
+  // incomplete checkpoint behind.
+  const string temporary_file_name = file_name + ".tmp";
+  {
+    ofstream file(temporary_file_name);
+    file << "nutr_checkpoint 1\nsegment " << record.segment << "\nevents "
+         << record.n_events << "\nevent_ids " << record.n_event_ids << "\n";
+    for (const auto &shard : record.shards) {
+      file << "shard " << shard.thread_id << " " << shard.n_rows << " "
+           << shard.n_bytes << " " << shard.file_name << "\n";
+    }
+    if (!file) {
+      throw runtime_error("Checkpoint: Could not write '" +
+                          temporary_file_name + "'.");
+    }
+  }
+  std::filesystem::rename(temporary_file_name, file_name);
+}
+
+vector<Shard> Checkpoint::BeginSegment(const string &output_file_name) {
+  const path output_path(output_file_name);
+  base_name = (output_path.parent_path() / output_path.stem()).string();
+  const string base_file_name = base_name + "_checkpoint.txt";
+
+  Record record;
+  if (resume) {
+    if (!std::filesystem::exists(base_file_name)) {
+      throw runtime_error("Checkpoint: Cannot resume, because there is no "
+                          "checkpoint '" +
+                          base_file_name + "'.");
+    }
+    const Record previous = Read(base_file_name);
+    record = previous;
+    ++record.segment;
+    for (const auto &file_name : ThreadFileNames()) {
+      const Record thread_record = Read(file_name);
+      if (thread_record.segment != previous.segment) {
+        continue;
+      }
+      record.n_events += thread_record.n_events;
+      record.shards.insert(record.shards.end(), thread_record.shards.begin(),
+                           thread_record.shards.end());
+    }
+
+    // Remove the events after the last checkpoint from the output files.
+    for (const auto &shard : record.shards) {
+      if (std::filesystem::exists(shard.file_name) &&
+          std::filesystem::file_size(shard.file_name) > shard.n_bytes) {
+        std::filesystem::resize_file(shard.file_name, shard.n_bytes);
+      }
+    }
+
+    if (G4Threading::IsMultithreadedApplication()) {
+      G4Random::setTheSeed(mix_seed(G4Random::getTheSeed(), record.segment));
+    } else if (std::filesystem::exists(ThreadFileName(".rndm"))) {
+      G4Random::restoreEngineStatus(ThreadFileName(".rndm").c_str());
+    }
+
+    G4cout << "Resuming run from checkpoint '" << base_file_name << "' ("
+           << record.n_events << " events completed)." << G4endl;
+    resume = false;
+  }
+
+  segment = record.segment;
+  event_id_offset = static_cast<int>(record.n_event_ids);
+  n_events_remaining =
+      std::max(n_events_requested - static_cast<int64_t>(record.n_events),
+               int64_t(0));
+  record.n_event_ids += n_events_requested;
+  Write(base_file_name, record);
+
+  // The checkpoints of the threads are only valid for a single segment.
+  for (const auto &file_name : ThreadFileNames()) {
+    std::filesystem::remove(file_name);
+    std::filesystem::remove(path(file_name).replace_extension(".rndm"));
+  }
+
+  return record.shards;
+}
+
+string Checkpoint::SegmentFileName(const string &file_name) {
+  if (segment == 0) {
+    return file_name;
+  }
+
+  const path file_path(file_name);
+  return (file_path.parent_path() /
+          (file_path.stem().string() + "_r" + std::to_string(segment) +
+           file_path.extension().string()))
+      .string();
+}
+
+void Checkpoint::BeginThread() {
+  n_events_completed = 0;
+  next_checkpoint = seconds_since_start() + interval;
+}
+
+bool Checkpoint::ClaimEvent() {
+  if (stop_requested.load(std::memory_order_relaxed) ||
+      (max_wallclock > 0. && seconds_since_start() > max_wallclock)) {
+    if (!stop_reported.exchange(true)) {
+      G4cout << "Ending the run early after "
+             << static_cast<long>(seconds_since_start()) << " s, because "
+             << (stop_requested ? "SIGTERM was received."
+                                : "the wall-clock limit was reached.")
+             << G4endl;
+    }
+    stop_requested = true;
+    return false;
+  }
+  // Only a resumed run needs to count the events of all threads.
+  if (n_events_remaining < n_events_requested &&
+      n_events_claimed.fetch_add(1, std::memory_order_relaxed) >=
+          n_events_remaining) {
+    return false;
+  }
+  ++n_events_completed;
+  return true;
+}
+
+bool Checkpoint::IsDue() {
+  if (interval <= 0. || seconds_since_start() < next_checkpoint) {
+    return false;
+  }
+  next_checkpoint = seconds_since_start() + interval;
+  return true;
+}
+
+void Checkpoint::Write(const vector<Shard> &shards) {
+  if (base_name.empty()) {
+    return;
+  }
+  Record record;
+  record.segment = segment;
+  record.n_events = n_events_completed;
+  record.shards = shards;
+  Write(ThreadFileName(".txt"), record);
+  G4Random::saveEngineStatus(ThreadFileName(".rndm").c_str());
+}
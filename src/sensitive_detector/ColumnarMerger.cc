@@ -0,0 +1,133 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+using std::atomic;
+using std::exception_ptr;
+using std::make_unique;
+using std::mutex;
+using std::runtime_error;
+using std::thread;
+using std::unique_ptr;
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ColumnarMerger.hh"
+#include "ColumnarReader.hh"
+
+namespace {
+void write_at(const int file_descriptor, const char *data, size_t size,
+              off_t offset) {
+  while (size > 0) {
+    const ssize_t written = pwrite(file_descriptor, data, size, offset);
+    if (written <= 0) {
+      throw runtime_error("ncol::merge(): Could not write to output file.");
+    }
+    data += written;
+    size -= written;
+    offset += written;
+  }
+}
+} // namespace
+
+uint64_t ncol::merge(const vector<string> &input_file_names,
+                     const string &output_file_name,
+                     const unsigned int n_threads) {
+  if (input_file_names.empty()) {
+    throw runtime_error("ncol::merge() called with an empty list.");
+  }
+
+  vector<unique_ptr<ColumnarReader>> readers;
+  vector<off_t> offsets;
+  uint64_t n_rows = 0;
+  for (const auto &input_file_name : input_file_names) {
+    readers.push_back(make_unique<ColumnarReader>(input_file_name));
+    if (!readers.back()->HasSameSchema(*readers[0])) {
+      throw runtime_error("ncol::merge(): '" + input_file_name + "' and '" +
+                          input_file_names[0] +
+                          "' have different column schemas.");
+    }
+    n_rows += readers.back()->GetNumberOfRows();
+  }
+
+  off_t offset = readers[0]->GetHeader().size();
+  for (const auto &reader : readers) {
+    offsets.push_back(offset);
+    offset += reader->GetPayload().size();
+  }
+
+  const int file_descriptor =
+      open(output_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (file_descriptor < 0) {
+    throw runtime_error("ncol::merge(): Could not open output file '" +
+                        output_file_name + "'.");
+  }
+  if (ftruncate(file_descriptor, offset) != 0) {
+    close(file_descriptor);
+    throw runtime_error("ncol::merge(): Could not allocate output file '" +
+                        output_file_name + "'.");
+  }
+
+  atomic<size_t> next_reader(0);
+  mutex error_mutex;
+  exception_ptr error = nullptr;
+  auto copy = [&]() {
+    try {
+      for (size_t i = next_reader++; i < readers.size(); i = next_reader++) {
+        const auto payload = readers[i]->GetPayload();
+        write_at(file_descriptor, payload.data(), payload.size(), offsets[i]);
+      }
+    } catch (...) {
+      std::lock_guard<mutex> lock(error_mutex);
+      error = std::current_exception();
+    }
+  };
+
+  const auto header = readers[0]->GetHeader();
+  const unsigned int n_copy_threads =
+      std::clamp(n_threads, 1u, static_cast<unsigned int>(readers.size()));
+  vector<thread> threads;
+  try {
+    write_at(file_descriptor, header.data(), header.size(), 0);
+    for (unsigned int i = 0; i < n_copy_threads; ++i) {
+      threads.emplace_back(copy);
+    }
+  } catch (...) {
+    std::lock_guard<mutex> lock(error_mutex);
+    error = std::current_exception();
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  close(file_descriptor);
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  return n_rows;
+}
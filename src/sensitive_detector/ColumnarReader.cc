@@ -0,0 +1,229 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <cstring>
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "ColumnarReader.hh"
+
+ColumnarReader::ColumnarReader(const string &_file_name)
+    : file_name(_file_name), file_descriptor(-1), data(nullptr), size(0),
+      payload_begin(0), payload_end(0) {
+
+  file_descriptor = open(file_name.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    throw runtime_error("ColumnarReader: Could not open file '" + file_name +
+                        "'.");
+  }
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) != 0) {
+    close(file_descriptor);
+    throw runtime_error("ColumnarReader: Could not determine the size of "
+                        "file '" +
+                        file_name + "'.");
+  }
+  size = file_status.st_size;
+
+  if (size < sizeof(ncol::magic) + 2 * sizeof(uint32_t)) {
+    close(file_descriptor);
+    throw runtime_error("ColumnarReader: '" + file_name +
+                        "' is not a nutr columnar file.");
+  }
+  void *mapped =
+      mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+  if (mapped == MAP_FAILED) {
+    close(file_descriptor);
+    throw runtime_error("ColumnarReader: Could not map file '" + file_name +
+                        "' into memory.");
+  }
+  data = static_cast<const char *>(mapped);
+  madvise(mapped, size, MADV_SEQUENTIAL);
+
+  try {
+    Parse();
+  } catch (...) {
+    munmap(mapped, size);
+    close(file_descriptor);
+    throw;
+  }
+}
+
+void ColumnarReader::Parse() {
+  if (memcmp(data, ncol::magic, sizeof(ncol::magic)) != 0) {
+    throw runtime_error("ColumnarReader: '" + file_name +
+                        "' is not a nutr columnar file.");
+  }
+  size_t position = sizeof(ncol::magic);
+  uint32_t version, n_columns;
+  memcpy(&version, data + position, sizeof(version));
+  position += sizeof(version);
+  memcpy(&n_columns, data + position, sizeof(n_columns));
+  position += sizeof(n_columns);
+  if (version < 1 || version > ncol::version) {
+    throw runtime_error("ColumnarReader: '" + file_name +
+                        "' has an unsupported format version.");
+  }
+
+  const size_t schema_start = position;
+  for (uint32_t i = 0; i < n_columns; ++i) {
+    uint8_t type;
+    uint16_t name_length;
+    if (position + sizeof(type) + sizeof(name_length) > size) {
+      throw runtime_error("ColumnarReader: Corrupt column schema in file '" +
+                          file_name + "'.");
+    }
+    memcpy(&type, data + position, sizeof(type));
+    position += sizeof(type);
+    memcpy(&name_length, data + position, sizeof(name_length));
+    position += sizeof(name_length);
+    if (type > static_cast<uint8_t>(ncol::ColumnType::Float)) {
+      throw runtime_error("ColumnarReader: Unknown column type in file '" +
+                          file_name + "'.");
+    }
+    column_types.push_back(static_cast<ncol::ColumnType>(type));
+    if (position + name_length > size) {
+      throw runtime_error("ColumnarReader: Corrupt column schema in file '" +
+                          file_name + "'.");
+    }
+    column_names.emplace_back(data + position, name_length);
+    position += name_length;
+  }
+  position = schema_start + ncol::padded_size(position - schema_start);
+  decompression_buffers.resize(n_columns);
+  payload_begin = position;
+  payload_end = position;
+
+  const size_t chunk_header_size = (2 + 2 * n_columns) * sizeof(uint64_t);
+  while (position + chunk_header_size <= size) {
+    const uint64_t *chunk_header =
+        reinterpret_cast<const uint64_t *>(data + position);
+    if (chunk_header[0] != ncol::chunk_magic) {
+      throw runtime_error("ColumnarReader: Corrupt chunk header in file '" +
+                          file_name + "'.");
+    }
+    position += chunk_header_size;
+
+    Chunk chunk;
+    chunk.n_rows = chunk_header[1];
+    for (uint32_t i = 0; i < n_columns; ++i) {
+      chunk.stored_sizes.push_back(chunk_header[2 + 2 * i]);
+      chunk.raw_sizes.push_back(chunk_header[3 + 2 * i]);
+      chunk.column_data.push_back(data + position);
+      position += ncol::padded_size(chunk.stored_sizes.back());
+    }
+    if (position > size) {
+      // Incomplete chunk at the end of the file, for example because the
+      // simulation was aborted while writing it.
+      break;
+    }
+    chunks.push_back(chunk);
+    payload_end = position;
+  }
+}
+
+ColumnarReader::~ColumnarReader() {
+  munmap(const_cast<char *>(data), size);
+  close(file_descriptor);
+}
+
+size_t ColumnarReader::GetColumnIndex(const string &name) const {
+  for (size_t i = 0; i < column_names.size(); ++i) {
+    if (column_names[i] == name) {
+      return i;
+    }
+  }
+  throw runtime_error("ColumnarReader: No column '" + name + "' in file '" +
+                      file_name + "'.");
+}
+
+uint64_t ColumnarReader::GetNumberOfRows() const {
+  uint64_t n_rows = 0;
+  for (const auto &chunk : chunks) {
+    n_rows += chunk.n_rows;
+  }
+  return n_rows;
+}
+
+const char *ColumnarReader::ColumnData(const size_t col, const size_t chunk,
+                                       const ncol::ColumnType expected_type) {
+  if (column_types[col] != expected_type) {
+    throw runtime_error("ColumnarReader: Column '" + column_names[col] +
+                        "' requested with wrong type.");
+  }
+
+  const Chunk &c = chunks[chunk];
+  if (c.stored_sizes[col] == c.raw_sizes[col]) {
+    return c.column_data[col];
+  }
+
+  vector<char> &decompression_buffer = decompression_buffers[col];
+  decompression_buffer.resize(c.raw_sizes[col]);
+  uLongf raw_size = c.raw_sizes[col];
+  if (uncompress(reinterpret_cast<Bytef *>(decompression_buffer.data()),
+                 &raw_size,
+                 reinterpret_cast<const Bytef *>(c.column_data[col]),
+                 c.stored_sizes[col]) != Z_OK ||
+      raw_size != c.raw_sizes[col]) {
+    throw runtime_error("ColumnarReader: Could not decompress column '" +
+                        column_names[col] + "' in file '" + file_name + "'.");
+  }
+  return decompression_buffer.data();
+}
+
+vector<double> ColumnarReader::ExpandVectorColumns(const size_t index_col,
+                                                   const size_t value_col,
+                                                   const size_t n_indices) {
+  vector<double> table(GetNumberOfRows() * n_indices, 0.);
+
+  size_t row = 0;
+  for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+    const auto indices = GetVectorColumnChunk<int32_t>(index_col, chunk);
+    const auto values = GetVectorColumnChunk<double>(value_col, chunk);
+    if (indices.values.size() != values.values.size()) {
+      throw runtime_error("ColumnarReader: Columns '" +
+                          column_names[index_col] + "' and '" +
+                          column_names[value_col] +
+                          "' have different numbers of values.");
+    }
+
+    size_t offset = 0;
+    for (const auto length : indices.lengths) {
+      for (uint32_t i = 0; i < length; ++i, ++offset) {
+        const auto index = indices.values[offset];
+        if (index < 0 || static_cast<size_t>(index) >= n_indices) {
+          throw runtime_error("ColumnarReader: Index " + std::to_string(index) +
+                              " in column '" + column_names[index_col] +
+                              "' is out of range.");
+        }
+        table[row * n_indices + index] += values.values[offset];
+      }
+      ++row;
+    }
+  }
+
+  return table;
+}
@@ -0,0 +1,443 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+using std::cerr;
+using std::fill;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::runtime_error;
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "ColumnarWriter.hh"
+#include "Trace.hh"
+
+size_t ncol::column_type_size(const ColumnType type) {
+  switch (type) {
+  case ColumnType::Int:
+  case ColumnType::IntVector:
+    return sizeof(int32_t);
+  case ColumnType::Double:
+  case ColumnType::DoubleVector:
+    return sizeof(double);
+  case ColumnType::Float:
+    return sizeof(float);
+  }
+  return 0;
+}
+
+bool ncol::is_vector(const ColumnType type) {
+  return type == ColumnType::IntVector || type == ColumnType::DoubleVector;
+}
+
+size_t ncol::padded_size(const size_t size) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+ColumnarWriter::ColumnarWriter()
+    : file(nullptr), file_name(""), chunk_size(0), compression_level(0),
+      n_rows_in_chunk(0), n_rows_total(0), n_bytes_written(0),
+      n_chunks_queued(0), n_chunks_written(0), writer_failed(false) {}
+
+ColumnarWriter::~ColumnarWriter() {
+  // A destructor must not throw, so errors that were not reported by an
+  // explicit call of Close() can only be printed here.
+  try {
+    Close();
+  } catch (const std::exception &error) {
+    cerr << "Warning: ColumnarWriter: Could not close file '" << file_name
+         << "': " << error.what() << "\n";
+  }
+}
+
+size_t ColumnarWriter::CreateColumn(const string &name,
+                                    const ncol::ColumnType type) {
+  if (IsOpen()) {
+    throw runtime_error("ColumnarWriter::CreateColumn() called after the "
+                        "output file '" +
+                        file_name + "' was opened.");
+  }
+
+  column_names.push_back(name);
+  column_types.push_back(type);
+  switch (type) {
+  case ncol::ColumnType::Int:
+    column_buffer_index.push_back(chunk.int_buffers.size());
+    chunk.int_buffers.emplace_back();
+    break;
+  case ncol::ColumnType::Double:
+    column_buffer_index.push_back(chunk.double_buffers.size());
+    chunk.double_buffers.emplace_back();
+    break;
+  case ncol::ColumnType::Float:
+    column_buffer_index.push_back(chunk.float_buffers.size());
+    chunk.float_buffers.emplace_back();
+    break;
+  case ncol::ColumnType::IntVector:
+  case ncol::ColumnType::DoubleVector:
+    column_buffer_index.push_back(chunk.vector_buffers.size());
+    chunk.vector_buffers.emplace_back();
+    break;
+  }
+
+  return column_names.size() - 1;
+}
+
+void ColumnarWriter::ResetColumns() {
+  if (IsOpen()) {
+    throw runtime_error("ColumnarWriter::ResetColumns() called while the "
+                        "output file '" +
+                        file_name + "' is open.");
+  }
+
+  column_names.clear();
+  column_types.clear();
+  column_buffer_index.clear();
+  chunk = Chunk();
+}
+
+void ColumnarWriter::Open(const string &_file_name, const size_t _chunk_size,
+                          const int _compression_level,
+                          const size_t n_queued_chunks) {
+  if (IsOpen()) {
+    Close();
+  }
+
+  file_name = _file_name;
+  chunk_size = std::max(_chunk_size, size_t(1));
+  compression_level = std::clamp(_compression_level, 0, 9);
+  n_rows_in_chunk = 0;
+  n_rows_total = 0;
+  n_bytes_written = 0;
+
+  for (auto &buffer : chunk.int_buffers) {
+    buffer.assign(chunk_size, 0);
+  }
+  for (auto &buffer : chunk.double_buffers) {
+    buffer.assign(chunk_size, 0.);
+  }
+  for (auto &buffer : chunk.float_buffers) {
+    buffer.assign(chunk_size, 0.f);
+  }
+  for (auto &buffer : chunk.vector_buffers) {
+    buffer.lengths.assign(chunk_size, 0);
+    buffer.int_values.clear();
+    buffer.double_values.clear();
+  }
+  compressed_buffers.resize(column_names.size());
+
+  file = fopen(file_name.c_str(), "wb");
+  if (file == nullptr) {
+    throw runtime_error(
+        "ColumnarWriter::Open(): Could not open output file '" + file_name +
+        "'.");
+  }
+
+  WriteHeader();
+
+  queue.assign(n_queued_chunks, chunk);
+  n_chunks_queued = 0;
+  n_chunks_written = 0;
+  writer_failed = false;
+  writer_error = nullptr;
+  if (!queue.empty()) {
+    writer_thread = thread(&ColumnarWriter::WriterLoop, this);
+  }
+}
+
+void ColumnarWriter::FillD(const size_t first_col, const double *values,
+                           const size_t n_values) {
+  for (size_t i = 0; i < n_values; ++i) {
+    vector<double> &buffer =
+        chunk.double_buffers[column_buffer_index[first_col + i]];
+    buffer[n_rows_in_chunk] = values[i];
+  }
+}
+
+void ColumnarWriter::Write(const void *data, const size_t size) {
+  if (fwrite(data, 1, size, file) != size) {
+    throw runtime_error("ColumnarWriter::Write(): Could not write to file '" +
+                        file_name + "'.");
+  }
+  n_bytes_written.fetch_add(size, memory_order_relaxed);
+}
+
+void ColumnarWriter::WritePadding(const size_t size) {
+  constexpr char zeros[ncol::alignment] = {};
+  const size_t padding = ncol::padded_size(size) - size;
+  if (padding) {
+    Write(zeros, padding);
+  }
+}
+
+void ColumnarWriter::WriteHeader() {
+  Write(ncol::magic, sizeof(ncol::magic));
+  const uint32_t version = ncol::version;
+  Write(&version, sizeof(version));
+  const uint32_t n_columns = static_cast<uint32_t>(column_names.size());
+  Write(&n_columns, sizeof(n_columns));
+
+  size_t schema_size = 0;
+  for (size_t i = 0; i < column_names.size(); ++i) {
+    const uint8_t type = static_cast<uint8_t>(column_types[i]);
+    const uint16_t name_length = static_cast<uint16_t>(column_names[i].size());
+    Write(&type, sizeof(type));
+    Write(&name_length, sizeof(name_length));
+    Write(column_names[i].data(), name_length);
+    schema_size += sizeof(type) + sizeof(name_length) + name_length;
+  }
+  WritePadding(schema_size);
+}
+
+void ColumnarWriter::CompressColumn(const void *data, const size_t size,
+                                    vector<char> &out) {
+  if (compression_level > 0) {
+    uLongf compressed_size = compressBound(size);
+    out.resize(compressed_size);
+    if (compress2(reinterpret_cast<Bytef *>(out.data()), &compressed_size,
+                  static_cast<const Bytef *>(data), size,
+                  compression_level) == Z_OK &&
+        compressed_size < size) {
+      out.resize(compressed_size);
+      return;
+    }
+  }
+  // Store the raw data if compression is switched off or did not pay off.
+  out.resize(size);
+  memcpy(out.data(), data, size);
+}
+
+const void *ColumnarWriter::SerializeVectorColumn(const Chunk &c,
+                                                  const size_t col,
+                                                  size_t &size) {
+  const VectorBuffer &buffer = c.vector_buffers[column_buffer_index[col]];
+  const void *values = buffer.double_values.data();
+  size_t values_size = buffer.double_values.size() * sizeof(double);
+  if (column_types[col] == ncol::ColumnType::IntVector) {
+    values = buffer.int_values.data();
+    values_size = buffer.int_values.size() * sizeof(int32_t);
+  }
+  const size_t lengths_size = c.n_rows * sizeof(uint32_t);
+  const size_t values_offset = ncol::padded_size(lengths_size);
+
+  size = values_offset + values_size;
+  serialization_buffer.assign(size, 0);
+  memcpy(serialization_buffer.data(), buffer.lengths.data(), lengths_size);
+  if (values_size) {
+    memcpy(serialization_buffer.data() + values_offset, values, values_size);
+  }
+  return serialization_buffer.data();
+}
+
+void ColumnarWriter::WriteChunk(const Chunk &c) {
+  const Trace::Span span("write chunk", "io");
+  vector<uint64_t> chunk_header;
+  chunk_header.reserve(2 + 2 * column_names.size());
+  chunk_header.push_back(ncol::chunk_magic);
+  chunk_header.push_back(c.n_rows);
+
+  for (size_t i = 0; i < column_names.size(); ++i) {
+    const void *data = nullptr;
+    size_t raw_size = c.n_rows * ncol::column_type_size(column_types[i]);
+    switch (column_types[i]) {
+    case ncol::ColumnType::Int:
+      data = c.int_buffers[column_buffer_index[i]].data();
+      break;
+    case ncol::ColumnType::Double:
+      data = c.double_buffers[column_buffer_index[i]].data();
+      break;
+    case ncol::ColumnType::Float:
+      data = c.float_buffers[column_buffer_index[i]].data();
+      break;
+    case ncol::ColumnType::IntVector:
+    case ncol::ColumnType::DoubleVector:
+      data = SerializeVectorColumn(c, i, raw_size);
+      break;
+    }
+    CompressColumn(data, raw_size, compressed_buffers[i]);
+    chunk_header.push_back(compressed_buffers[i].size());
+    chunk_header.push_back(raw_size);
+  }
+
+  Write(chunk_header.data(), chunk_header.size() * sizeof(uint64_t));
+  for (size_t i = 0; i < column_names.size(); ++i) {
+    Write(compressed_buffers[i].data(), compressed_buffers[i].size());
+    WritePadding(compressed_buffers[i].size());
+  }
+}
+
+void ColumnarWriter::ClearChunk(Chunk &c) {
+  for (auto &buffer : c.int_buffers) {
+    fill(buffer.begin(), buffer.begin() + c.n_rows, 0);
+  }
+  for (auto &buffer : c.double_buffers) {
+    fill(buffer.begin(), buffer.begin() + c.n_rows, 0.);
+  }
+  for (auto &buffer : c.float_buffers) {
+    fill(buffer.begin(), buffer.begin() + c.n_rows, 0.f);
+  }
+  for (auto &buffer : c.vector_buffers) {
+    fill(buffer.lengths.begin(), buffer.lengths.begin() + c.n_rows, 0);
+    buffer.int_values.clear();
+    buffer.double_values.clear();
+  }
+  c.n_rows = 0;
+}
+
+void ColumnarWriter::Flush() {
+  if (!IsOpen() || n_rows_in_chunk == 0) {
+    return;
+  }
+
+  chunk.n_rows = n_rows_in_chunk;
+  if (writer_thread.joinable()) {
+    Enqueue();
+    if (writer_failed.load(memory_order_acquire)) {
+      // The rows of the chunk were discarded by the writer thread.
+      StopWriterThread();
+      writer_failed = false;
+      n_rows_in_chunk = 0;
+      std::rethrow_exception(writer_error);
+    }
+  } else {
+    WriteChunk(chunk);
+    ClearChunk(chunk);
+  }
+  n_rows_total += n_rows_in_chunk;
+  n_rows_in_chunk = 0;
+}
+
+void ColumnarWriter::Sync() {
+  if (!IsOpen()) {
+    return;
+  }
+
+  const Trace::Span span("sync", "io");
+  Flush();
+  if (writer_thread.joinable()) {
+    const uint64_t n_queued = n_chunks_queued.load(memory_order_relaxed);
+    uint64_t n_written = n_chunks_written.load(memory_order_acquire);
+    while (n_written != n_queued) {
+      n_chunks_written.wait(n_written, memory_order_acquire);
+      n_written = n_chunks_written.load(memory_order_acquire);
+    }
+    if (writer_failed.load(memory_order_acquire)) {
+      StopWriterThread();
+      writer_failed = false;
+      std::rethrow_exception(writer_error);
+    }
+  }
+  if (fflush(file) != 0 || fsync(fileno(file)) != 0) {
+    throw runtime_error("ColumnarWriter::Sync(): Could not write to file '" +
+                        file_name + "'.");
+  }
+}
+
+void ColumnarWriter::Enqueue() {
+  const uint64_t n_queued = n_chunks_queued.load(memory_order_relaxed);
+  uint64_t n_written = n_chunks_written.load(memory_order_acquire);
+  // Wait until the writer thread has released a slot.
+  if (n_queued - n_written == queue.size()) {
+    const Trace::Span span("wait for writer thread", "io");
+    while (n_queued - n_written == queue.size()) {
+      n_chunks_written.wait(n_written, memory_order_acquire);
+      n_written = n_chunks_written.load(memory_order_acquire);
+    }
+  }
+  // The slot contains the empty buffers of a chunk that was already written,
+  // which are reused for the next chunk.
+  std::swap(chunk, queue[n_queued % queue.size()]);
+  n_chunks_queued.store(n_queued + 1, memory_order_release);
+  n_chunks_queued.notify_one();
+}
+
+void ColumnarWriter::StopWriterThread() {
+  if (!writer_thread.joinable()) {
+    return;
+  }
+  chunk.n_rows = 0;
+  Enqueue();
+  writer_thread.join();
+}
+
+void ColumnarWriter::WriterLoop() {
+  Trace::SetThreadName("ncol writer " + file_name);
+  uint64_t n_written = n_chunks_written.load(memory_order_relaxed);
+  while (true) {
+    uint64_t n_queued = n_chunks_queued.load(memory_order_acquire);
+    while (n_queued == n_written) {
+      n_chunks_queued.wait(n_queued, memory_order_acquire);
+      n_queued = n_chunks_queued.load(memory_order_acquire);
+    }
+
+    Chunk &queued_chunk = queue[n_written % queue.size()];
+    if (queued_chunk.n_rows == 0) {
+      return;
+    }
+    // After an error, the chunks are discarded, so that the filling thread
+    // does not wait forever.
+    if (!writer_failed.load(memory_order_relaxed)) {
+      try {
+        WriteChunk(queued_chunk);
+      } catch (...) {
+        writer_error = std::current_exception();
+        writer_failed.store(true, memory_order_release);
+      }
+    }
+    ClearChunk(queued_chunk);
+
+    n_chunks_written.store(++n_written, memory_order_release);
+    n_chunks_written.notify_one();
+  }
+}
+
+void ColumnarWriter::Close() {
+  if (!IsOpen()) {
+    return;
+  }
+
+  // The writer thread is stopped and the file is closed even if the last
+  // chunk could not be written, so that the writer can be reused.
+  std::exception_ptr error;
+  try {
+    Flush();
+  } catch (...) {
+    error = std::current_exception();
+  }
+  StopWriterThread();
+  fclose(file);
+  file = nullptr;
+  if (writer_failed.load(memory_order_acquire)) {
+    writer_failed = false;
+    if (!error) {
+      error = writer_error;
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
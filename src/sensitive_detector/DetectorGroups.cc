@@ -0,0 +1,67 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "G4RunManager.hh"
+
+#include "DetectorGroups.hh"
+#include "NutrMessenger.hh"
+
+void DetectorGroups::Initialize(
+    const function<bool(size_t)> &uses_detector) {
+  const string output = NutrMessenger::GetGroupOutput();
+  write_detectors = output != "groups";
+  threshold = NutrMessenger::GetGroupThreshold();
+
+  groups.clear();
+  if (output != "detectors") {
+    const auto detector_construction =
+        (NDetectorConstruction *)G4RunManager::GetRunManager()
+            ->GetUserDetectorConstruction();
+    for (const auto &full_group : detector_construction->GetDetectorGroups()) {
+      DetectorGroup group{full_group.name, {}};
+      for (const auto detector_id : full_group.detector_ids) {
+        if (uses_detector(detector_id)) {
+          group.detector_ids.push_back(detector_id);
+        }
+      }
+      // Groups with a single detector would duplicate its energy deposition.
+      if (!group.detector_ids.empty() &&
+          (!write_detectors || group.detector_ids.size() > 1)) {
+        groups.push_back(group);
+      }
+    }
+  }
+  add_back.assign(groups.size(), 0.);
+  sum.assign(groups.size(), 0.);
+}
+
+void DetectorGroups::Compute(const vector<double> &edep) {
+  for (size_t i = 0; i < groups.size(); ++i) {
+    add_back[i] = 0.;
+    sum[i] = 0.;
+    for (const auto detector_id : groups[i].detector_ids) {
+      if (detector_id < edep.size()) {
+        sum[i] += edep[detector_id];
+        if (edep[detector_id] > threshold) {
+          add_back[i] += edep[detector_id];
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,245 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <numbers>
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include "Digitizer.hh"
+
+void GaussianGenerator::SetSeed(uint64_t seed) {
+  // Initialize the state with the splitmix64 algorithm, as recommended by the
+  // authors of xoshiro256+.
+  for (auto &s : state) {
+    seed += 0x9e3779b97f4a7c15;
+    uint64_t z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    s = z ^ (z >> 31);
+  }
+  position = block_size;
+}
+
+void GaussianGenerator::Refill() {
+  // The upper 53 bits of a random number are converted to a double in (0, 1].
+  for (size_t i = 0; i < block_size; ++i) {
+    uniform[i] = ((Next() >> 11) + 1) * 0x1.0p-53;
+  }
+  for (size_t i = 0; i < block_size; i += 2) {
+    const double r = std::sqrt(-2. * std::log(uniform[i]));
+    const double phi = 2. * std::numbers::pi * uniform[i + 1];
+    block[i] = r * std::cos(phi);
+    block[i + 1] = r * std::sin(phi);
+  }
+  position = 0;
+}
+
+Digitizer::Parameters Digitizer::default_parameters;
+vector<Digitizer::Parameters> Digitizer::channel_parameters;
+
+Digitizer::Digitizer()
+    : local_revision(0), seeded(false), time(0.) {}
+
+template <typename Setter>
+void Digitizer::SetParameters(const int channel, Setter setter) {
+  if (channel < 0) {
+    setter(default_parameters);
+    for (auto &parameters : channel_parameters) {
+      setter(parameters);
+    }
+  } else {
+    if (static_cast<size_t>(channel) >= channel_parameters.size()) {
+      channel_parameters.resize(channel + 1, default_parameters);
+    }
+    setter(channel_parameters[channel]);
+  }
+  active = true;
+  ++revision;
+}
+
+void Digitizer::SetResolution(const int channel, const double _a,
+                              const double _b, const double _c) {
+  SetParameters(channel, [&](Parameters &parameters) {
+    parameters.a = _a;
+    parameters.b = _b;
+    parameters.c = _c;
+  });
+}
+
+void Digitizer::SetNonLinearity(const int channel, const double _p1,
+                                const double _p2) {
+  SetParameters(channel, [&](Parameters &parameters) {
+    parameters.p1 = _p1;
+    parameters.p2 = _p2;
+  });
+}
+
+void Digitizer::SetThreshold(const int channel, const double _threshold) {
+  SetParameters(channel, [&](Parameters &parameters) {
+    parameters.threshold = _threshold;
+  });
+}
+
+void Digitizer::SetDeadTime(const int channel, const double _dead_time) {
+  SetParameters(channel, [&](Parameters &parameters) {
+    parameters.dead_time = _dead_time;
+  });
+}
+
+void Digitizer::SetEventRate(const double rate) {
+  event_rate = rate;
+  active = true;
+  ++revision;
+}
+
+void Digitizer::Reset() {
+  active = false;
+  default_parameters = Parameters();
+  channel_parameters.clear();
+  event_rate = 0.;
+  ++revision;
+}
+
+void Digitizer::Print() {
+  if (!active) {
+    G4cout << "Digitizer: inactive, energy depositions are not modified."
+           << G4endl;
+    return;
+  }
+
+  G4cout << "Digitizer: event rate " << event_rate * second << " / s"
+         << G4endl;
+  auto print = [](const string &channel, const Parameters &parameters) {
+    G4cout << "  " << channel << ": FWHM^2 = " << parameters.a / (keV * keV)
+           << " keV^2 + " << parameters.b / keV << " keV * E + "
+           << parameters.c << " * E^2, E -> " << parameters.p1 << " * E + "
+           << parameters.p2 * MeV << " / MeV * E^2, threshold "
+           << parameters.threshold / keV << " keV, dead time "
+           << parameters.dead_time / ns << " ns" << G4endl;
+  };
+  print("default", default_parameters);
+  for (size_t i = 0; i < channel_parameters.size(); ++i) {
+    print("channel " + std::to_string(i), channel_parameters[i]);
+  }
+}
+
+void Digitizer::Update(const size_t n_channels) {
+  const size_t n = std::max(n_channels, channel_parameters.size());
+  a.resize(n);
+  b.resize(n);
+  c.resize(n);
+  p1.resize(n);
+  p2.resize(n);
+  threshold.resize(n);
+  dead_time.resize(n);
+  dead_until.resize(n, 0.);
+  for (size_t i = 0; i < n; ++i) {
+    const Parameters &parameters = i < channel_parameters.size()
+                                       ? channel_parameters[i]
+                                       : default_parameters;
+    // Convert the FWHM to a standard deviation.
+    constexpr double fwhm_to_sigma_squared = 1. / (8. * std::numbers::ln2);
+    a[i] = parameters.a * fwhm_to_sigma_squared;
+    b[i] = parameters.b * fwhm_to_sigma_squared;
+    c[i] = parameters.c * fwhm_to_sigma_squared;
+    p1[i] = parameters.p1;
+    p2[i] = parameters.p2;
+    threshold[i] = parameters.threshold;
+    dead_time[i] = parameters.dead_time;
+  }
+}
+
+void Digitizer::Process(vector<double> &edep) {
+  if (!active) {
+    return;
+  }
+
+  // The settings can only change between runs, so it is sufficient to check
+  // once per event whether the local copy is up to date.
+  if (local_revision != revision || edep.size() > a.size()) {
+    local_revision = revision;
+    Update(edep.size());
+  }
+  if (!seeded) {
+    // The random number engine of Geant4 is seeded reproducibly for each
+    // thread, so the digitizer inherits the reproducibility.
+    gaussian.SetSeed(static_cast<uint64_t>(G4UniformRand() * 0x1.0p53) ^
+                     (static_cast<uint64_t>(G4UniformRand() * 0x1.0p53)
+                      << 11));
+    seeded = true;
+  }
+
+  if (event_rate > 0.) {
+    time += -std::log(1. - G4UniformRand()) / event_rate;
+  }
+
+  hit_channels.clear();
+  hit_energies.clear();
+  hit_a.clear();
+  hit_b.clear();
+  hit_c.clear();
+  hit_p1.clear();
+  hit_p2.clear();
+  for (size_t i = 0; i < edep.size(); ++i) {
+    if (edep[i] > 0.) {
+      hit_channels.push_back(i);
+      hit_energies.push_back(edep[i]);
+      hit_a.push_back(a[i]);
+      hit_b.push_back(b[i]);
+      hit_c.push_back(c[i]);
+      hit_p1.push_back(p1[i]);
+      hit_p2.push_back(p2[i]);
+    }
+  }
+
+  const size_t n_hits = hit_channels.size();
+  hit_noise.resize(n_hits);
+  for (size_t i = 0; i < n_hits; ++i) {
+    hit_noise[i] = gaussian();
+  }
+
+  // Apply non-linearity and resolution to the compacted data. The loop reads
+  // only contiguous arrays and has no branches, so that it can be
+  // vectorized.
+  for (size_t i = 0; i < n_hits; ++i) {
+    const double e = hit_energies[i];
+    const double e_nonlinear = e * (hit_p1[i] + hit_p2[i] * e);
+    const double sigma = std::sqrt(std::max(
+        hit_a[i] + e_nonlinear * (hit_b[i] + hit_c[i] * e_nonlinear), 0.));
+    hit_energies[i] = e_nonlinear + sigma * hit_noise[i];
+  }
+
+  for (size_t i = 0; i < n_hits; ++i) {
+    const size_t channel = hit_channels[i];
+    double e = hit_energies[i];
+    if (e < threshold[channel] || e <= 0.) {
+      e = 0.;
+    } else if (event_rate > 0.) {
+      if (time < dead_until[channel]) {
+        e = 0.;
+      } else {
+        dead_until[channel] = time + dead_time[channel];
+      }
+    }
+    edep[channel] = e;
+  }
+}
@@ -0,0 +1,146 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <sstream>
+#include <string>
+
+using std::istringstream;
+using std::string;
+
+#include "G4SystemOfUnits.hh"
+
+#include "Digitizer.hh"
+#include "DigitizerMessenger.hh"
+
+namespace {
+/**
+ * \brief Read a channel from a command, where 'all' is mapped to -1
+ */
+bool read_channel(istringstream &stream, int &channel) {
+  string token;
+  if (!(stream >> token)) {
+    return false;
+  }
+  if (token == "all") {
+    channel = -1;
+    return true;
+  }
+  istringstream token_stream(token);
+  return static_cast<bool>(token_stream >> channel) && channel >= 0;
+}
+} // namespace
+
+DigitizerMessenger::DigitizerMessenger()
+    : dir("/nutr/digitizer/"),
+      cmd_resolution("/nutr/digitizer/resolution", this),
+      cmd_nonlinearity("/nutr/digitizer/nonlinearity", this),
+      cmd_threshold("/nutr/digitizer/threshold", this),
+      cmd_dead_time("/nutr/digitizer/dead_time", this),
+      cmd_event_rate("/nutr/digitizer/event_rate", this),
+      cmd_reset("/nutr/digitizer/reset", this),
+      cmd_print("/nutr/digitizer/print", this) {
+  dir.SetGuidance(
+      "Response of the data acquisition, which is applied to the energy "
+      "depositions in the detectors before the trigger and the output. As "
+      "long as no parameter is set, the energy depositions are not modified.");
+
+  cmd_resolution.SetGuidance(
+      "Set the energy resolution FWHM(E) = sqrt(A + B*E + C*E^2) of a "
+      "detector. Parameters: DETECTOR_ID A B C, with A in keV^2 and B in keV. "
+      "DETECTOR_ID may be 'all'.");
+  cmd_resolution.SetParameterName("resolution", false);
+
+  cmd_nonlinearity.SetGuidance(
+      "Set the non-linearity E -> P1*E + P2*E^2 of a detector. Parameters: "
+      "DETECTOR_ID P1 P2, with P2 in 1/MeV. DETECTOR_ID may be 'all'.");
+  cmd_nonlinearity.SetParameterName("nonlinearity", false);
+
+  cmd_threshold.SetGuidance(
+      "Set the threshold of a detector, below which energies are set to zero. "
+      "Parameters: DETECTOR_ID VALUE UNIT, for example '3 50 keV'. "
+      "DETECTOR_ID may be 'all'.");
+  cmd_threshold.SetParameterName("threshold", false);
+
+  cmd_dead_time.SetGuidance(
+      "Set the non-paralyzable dead time of a detector after it registered an "
+      "energy. Parameters: DETECTOR_ID VALUE UNIT, for example 'all 2 us'. "
+      "Only effective if an event rate is set.");
+  cmd_dead_time.SetParameterName("dead_time", false);
+
+  cmd_event_rate.SetGuidance(
+      "Set the rate of events in 1/s, which is used to assign times to the "
+      "events for the dead-time model (default: 0, i.e. no dead time).");
+  cmd_event_rate.SetParameterName("event_rate", false);
+  cmd_event_rate.SetRange("event_rate >= 0.");
+
+  cmd_reset.SetGuidance("Reset all parameters of the digitizer.");
+
+  cmd_print.SetGuidance("Print the current parameters of the digitizer.");
+}
+
+void DigitizerMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  istringstream stream(str);
+  int channel;
+
+  if (command == &cmd_resolution) {
+    double a, b, c;
+    if (!read_channel(stream, channel) || !(stream >> a >> b >> c)) {
+      G4ExceptionDescription description;
+      description << "/nutr/digitizer/resolution: Expected DETECTOR_ID A B C, "
+                     "got '"
+                  << str << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    Digitizer::SetResolution(channel, a * keV * keV, b * keV, c);
+  } else if (command == &cmd_nonlinearity) {
+    double p1, p2;
+    if (!read_channel(stream, channel) || !(stream >> p1 >> p2)) {
+      G4ExceptionDescription description;
+      description << "/nutr/digitizer/nonlinearity: Expected DETECTOR_ID P1 "
+                     "P2, got '"
+                  << str << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    Digitizer::SetNonLinearity(channel, p1, p2 / MeV);
+  } else if (command == &cmd_threshold || command == &cmd_dead_time) {
+    double value;
+    string unit;
+    if (!read_channel(stream, channel) || !(stream >> value >> unit)) {
+      G4ExceptionDescription description;
+      description << command->GetCommandPath()
+                  << ": Expected DETECTOR_ID VALUE UNIT, got '" << str << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    value *= G4UIcommand::ValueOf(unit.c_str());
+    if (command == &cmd_threshold) {
+      Digitizer::SetThreshold(channel, value);
+    } else {
+      Digitizer::SetDeadTime(channel, value);
+    }
+  } else if (command == &cmd_event_rate) {
+    Digitizer::SetEventRate(cmd_event_rate.GetNewDoubleValue(str) / second);
+  } else if (command == &cmd_reset) {
+    Digitizer::Reset();
+  } else if (command == &cmd_print) {
+    Digitizer::Print();
+  }
+}
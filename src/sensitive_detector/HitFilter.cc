@@ -0,0 +1,81 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include "HitFilter.hh"
+
+void HitFilter::SetDetectors(const vector<size_t> &detector_ids) {
+  selected_detectors.clear();
+  for (const auto detector_id : detector_ids) {
+    if (detector_id >= selected_detectors.size()) {
+      selected_detectors.resize(detector_id + 1, false);
+    }
+    selected_detectors[detector_id] = true;
+  }
+}
+
+void HitFilter::SetParticles(const vector<int> &_particle_ids) {
+  particle_ids = _particle_ids;
+}
+
+void HitFilter::SetEnergyRange(const double _e_min, const double _e_max) {
+  if (_e_min > _e_max) {
+    throw runtime_error("HitFilter: Lower limit of the energy range is larger "
+                        "than the upper limit.");
+  }
+  e_min = _e_min;
+  e_max = _e_max;
+}
+
+void HitFilter::Reset() {
+  selected_detectors.clear();
+  particle_ids.clear();
+  e_min = 0.;
+  e_max = numeric_limits<double>::max();
+}
+
+void HitFilter::Print() {
+  G4cout << "Hit filter: detectors";
+  if (selected_detectors.empty()) {
+    G4cout << " all";
+  }
+  for (size_t i = 0; i < selected_detectors.size(); ++i) {
+    if (selected_detectors[i]) {
+      G4cout << " " << i;
+    }
+  }
+  G4cout << ", particles";
+  if (particle_ids.empty()) {
+    G4cout << " all";
+  }
+  for (const auto particle_id : particle_ids) {
+    G4cout << " " << particle_id;
+  }
+  G4cout << ", kinetic energy >= " << e_min / keV << " keV";
+  if (e_max < numeric_limits<double>::max()) {
+    G4cout << " and <= " << e_max / keV << " keV";
+  }
+  G4cout << G4endl;
+}
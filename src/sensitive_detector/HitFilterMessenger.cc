@@ -0,0 +1,138 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::istringstream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+#include "G4UnitsTable.hh"
+
+#include "HitFilter.hh"
+#include "HitFilterMessenger.hh"
+
+HitFilterMessenger::HitFilterMessenger()
+    : dir("/nutr/hit_filter/"),
+      cmd_detectors("/nutr/hit_filter/detectors", this),
+      cmd_particles("/nutr/hit_filter/particles", this),
+      cmd_energy_range("/nutr/hit_filter/energy_range", this),
+      cmd_reset("/nutr/hit_filter/reset", this),
+      cmd_print("/nutr/hit_filter/print", this) {
+  dir.SetGuidance("Selection of the particles that are recorded by the 'flux' "
+                  "and 'tracker' sensitive detectors. By default, all "
+                  "particles in all detectors are recorded.");
+
+  cmd_detectors.SetGuidance(
+      "Record only particles in the given detectors. Parameters: DETECTOR_ID "
+      "[DETECTOR_ID ...], or 'all'.");
+  cmd_detectors.SetParameterName("detectors", false);
+
+  cmd_particles.SetGuidance(
+      "Record only the given particles. Parameters: PDG_CODE [PDG_CODE ...], "
+      "for example '22 2112' for photons and neutrons, or 'all'.");
+  cmd_particles.SetParameterName("particles", false);
+
+  cmd_energy_range.SetGuidance(
+      "Record only particles with a kinetic energy inside the given range. "
+      "Parameters: LOWER UPPER UNIT, for example '100 10000 keV'.");
+  cmd_energy_range.SetParameterName("energy_range", false);
+
+  cmd_reset.SetGuidance("Record all particles again.");
+
+  cmd_print.SetGuidance("Print the current selection.");
+}
+
+void HitFilterMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  istringstream stream(str);
+
+  if (command == &cmd_detectors) {
+    vector<size_t> detector_ids;
+    if (str != "all") {
+      size_t detector_id;
+      while (stream >> detector_id) {
+        detector_ids.push_back(detector_id);
+      }
+      if (!stream.eof()) {
+        G4ExceptionDescription description;
+        description << "/nutr/hit_filter/detectors: Expected DETECTOR_ID "
+                       "[DETECTOR_ID ...] or 'all', got '"
+                    << str << "'.";
+        command->CommandFailed(description);
+        return;
+      }
+    }
+    HitFilter::SetDetectors(detector_ids);
+  } else if (command == &cmd_particles) {
+    vector<int> particle_ids;
+    if (str != "all") {
+      int particle_id;
+      while (stream >> particle_id) {
+        particle_ids.push_back(particle_id);
+      }
+      if (!stream.eof()) {
+        G4ExceptionDescription description;
+        description << "/nutr/hit_filter/particles: Expected PDG_CODE "
+                       "[PDG_CODE ...] or 'all', got '"
+                    << str << "'.";
+        command->CommandFailed(description);
+        return;
+      }
+    }
+    HitFilter::SetParticles(particle_ids);
+  } else if (command == &cmd_energy_range) {
+    double lower, upper;
+    string unit;
+    if (!(stream >> lower >> upper >> unit)) {
+      G4ExceptionDescription description;
+      description << "/nutr/hit_filter/energy_range: Expected LOWER UPPER "
+                     "UNIT, got '"
+                  << str << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    // G4UIcommand::ValueOf() would silently return 0 for an unknown unit.
+    if (!G4UnitDefinition::IsUnitDefined(unit) ||
+        G4UnitDefinition::GetCategory(unit) != "Energy") {
+      G4ExceptionDescription description;
+      description << "/nutr/hit_filter/energy_range: Unknown energy unit '"
+                  << unit << "'.";
+      command->CommandFailed(description);
+      return;
+    }
+    const double unit_value = G4UnitDefinition::GetValueOf(unit);
+    // An exception would terminate the application, even in an interactive
+    // session.
+    try {
+      HitFilter::SetEnergyRange(lower * unit_value, upper * unit_value);
+    } catch (const runtime_error &error) {
+      G4ExceptionDescription description;
+      description << error.what();
+      command->CommandFailed(description);
+    }
+  } else if (command == &cmd_reset) {
+    HitFilter::Reset();
+  } else if (command == &cmd_print) {
+    HitFilter::Print();
+  }
+}
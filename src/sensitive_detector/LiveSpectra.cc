@@ -0,0 +1,224 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+using std::atomic_ref;
+using std::atomic_thread_fence;
+using std::memory_order_acquire;
+using std::memory_order_relaxed;
+using std::memory_order_release;
+using std::min;
+using std::runtime_error;
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LiveSpectra.hh"
+
+namespace {
+// Positions of the fields in the header of a live spectra file.
+constexpr size_t version_offset = 8;
+constexpr size_t n_spectra_offset = 12;
+constexpr size_t n_bins_offset = 16;
+constexpr size_t e_max_offset = 24;
+constexpr size_t sequence_offset = 32;
+constexpr size_t n_events_offset = 40;
+
+// A reader gives up after this many attempts, which are separated by a
+// millisecond. An update takes much less time than that, so an odd sequence
+// number that persists means that the writer was terminated during an update.
+constexpr unsigned int max_read_attempts = 1000;
+
+size_t file_size(const size_t n_spectra, const size_t n_bins) {
+  return live::header_size + n_spectra * live::name_length +
+         n_spectra * n_bins * sizeof(uint64_t);
+}
+} // namespace
+
+LiveSpectra::LiveSpectra(const string &_file_name,
+                         const vector<string> &_spectrum_names,
+                         const size_t _n_bins, const double _e_max)
+    : file_name(_file_name), file_descriptor(-1), data(nullptr), size(0),
+      spectrum_names(_spectrum_names), n_bins(_n_bins), e_max(_e_max),
+      sequence(nullptr), n_events_total(nullptr), counts(nullptr) {
+
+  // A viewer may still map the file of a previous run, so the file is replaced
+  // instead of being truncated.
+  unlink(file_name.c_str());
+  file_descriptor = open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file_descriptor < 0) {
+    throw runtime_error("LiveSpectra: Could not create file '" + file_name +
+                        "'.");
+  }
+  size = file_size(spectrum_names.size(), n_bins);
+  // Resizing fills the file with zeros, i.e. the spectra are empty.
+  if (ftruncate(file_descriptor, size) != 0) {
+    close(file_descriptor);
+    throw runtime_error("LiveSpectra: Could not resize file '" + file_name +
+                        "'.");
+  }
+  Map(true);
+
+  const uint32_t n_spectra = static_cast<uint32_t>(spectrum_names.size());
+  const uint64_t n_bins_in_file = n_bins;
+  memcpy(data + version_offset, &live::version, sizeof(live::version));
+  memcpy(data + n_spectra_offset, &n_spectra, sizeof(n_spectra));
+  memcpy(data + n_bins_offset, &n_bins_in_file, sizeof(n_bins_in_file));
+  memcpy(data + e_max_offset, &e_max, sizeof(e_max));
+  for (size_t i = 0; i < spectrum_names.size(); ++i) {
+    memcpy(data + live::header_size + i * live::name_length,
+           spectrum_names[i].data(),
+           min(spectrum_names[i].size(), live::name_length - 1));
+  }
+  // The magic string is written last, so that a viewer never accepts a file
+  // with an incomplete header.
+  uint64_t magic;
+  memcpy(&magic, live::magic, sizeof(magic));
+  atomic_ref<uint64_t>(*reinterpret_cast<uint64_t *>(data))
+      .store(magic, memory_order_release);
+}
+
+LiveSpectra::LiveSpectra(const string &_file_name)
+    : file_name(_file_name), file_descriptor(-1), data(nullptr), size(0),
+      n_bins(0), e_max(0.), sequence(nullptr), n_events_total(nullptr),
+      counts(nullptr) {
+
+  file_descriptor = open(file_name.c_str(), O_RDONLY);
+  if (file_descriptor < 0) {
+    throw runtime_error("LiveSpectra: Could not open file '" + file_name +
+                        "'.");
+  }
+  struct stat file_status;
+  if (fstat(file_descriptor, &file_status) != 0) {
+    close(file_descriptor);
+    throw runtime_error("LiveSpectra: Could not determine the size of file '" +
+                        file_name + "'.");
+  }
+  size = file_status.st_size;
+  if (size < live::header_size) {
+    close(file_descriptor);
+    throw runtime_error("LiveSpectra: '" + file_name +
+                        "' is not a live spectra file.");
+  }
+  Map(false);
+
+  uint32_t version, n_spectra;
+  uint64_t n_bins_in_file;
+  memcpy(&version, data + version_offset, sizeof(version));
+  memcpy(&n_spectra, data + n_spectra_offset, sizeof(n_spectra));
+  memcpy(&n_bins_in_file, data + n_bins_offset, sizeof(n_bins_in_file));
+  memcpy(&e_max, data + e_max_offset, sizeof(e_max));
+  n_bins = n_bins_in_file;
+  if (memcmp(data, live::magic, sizeof(live::magic)) != 0 ||
+      version != live::version || size != file_size(n_spectra, n_bins)) {
+    munmap(data, size);
+    close(file_descriptor);
+    throw runtime_error("LiveSpectra: '" + file_name +
+                        "' is not a valid live spectra file.");
+  }
+  for (uint32_t i = 0; i < n_spectra; ++i) {
+    const char *name = data + live::header_size + i * live::name_length;
+    spectrum_names.emplace_back(name, strnlen(name, live::name_length));
+  }
+  counts = reinterpret_cast<uint64_t *>(data + live::header_size +
+                                        n_spectra * live::name_length);
+}
+
+LiveSpectra::~LiveSpectra() {
+  munmap(data, size);
+  close(file_descriptor);
+}
+
+void LiveSpectra::Map(const bool writable) {
+  void *mapped =
+      mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+           MAP_SHARED, file_descriptor, 0);
+  if (mapped == MAP_FAILED) {
+    close(file_descriptor);
+    throw runtime_error("LiveSpectra: Could not map file '" + file_name +
+                        "' into memory.");
+  }
+  data = static_cast<char *>(mapped);
+  sequence = reinterpret_cast<uint64_t *>(data + sequence_offset);
+  n_events_total = reinterpret_cast<uint64_t *>(data + n_events_offset);
+  counts = reinterpret_cast<uint64_t *>(
+      data + live::header_size + spectrum_names.size() * live::name_length);
+}
+
+void LiveSpectra::BeginUpdate() {
+  update_mutex.lock();
+  atomic_ref<uint64_t> seq(*sequence);
+  seq.store(seq.load(memory_order_relaxed) + 1, memory_order_relaxed);
+  // The odd sequence number must be visible before any of the new counts.
+  atomic_thread_fence(memory_order_release);
+}
+
+void LiveSpectra::Add(const size_t index, const uint64_t n) {
+  atomic_ref<uint64_t> count(counts[index]);
+  count.store(count.load(memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+void LiveSpectra::EndUpdate(const uint64_t n_events) {
+  atomic_ref<uint64_t> n_events_in_file(*n_events_total);
+  n_events_in_file.store(n_events_in_file.load(memory_order_relaxed) +
+                             n_events,
+                         memory_order_relaxed);
+  atomic_ref<uint64_t> seq(*sequence);
+  seq.store(seq.load(memory_order_relaxed) + 1, memory_order_release);
+  update_mutex.unlock();
+}
+
+uint64_t LiveSpectra::Read(vector<uint64_t> &snapshot) const {
+  const size_t n_counts = spectrum_names.size() * n_bins;
+  snapshot.resize(n_counts);
+  atomic_ref<uint64_t> seq(*sequence);
+  atomic_ref<uint64_t> n_events_in_file(*n_events_total);
+
+  for (unsigned int attempt = 0; attempt < max_read_attempts; ++attempt) {
+    if (attempt > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const uint64_t sequence_before = seq.load(memory_order_acquire);
+    if (sequence_before % 2 == 1) {
+      continue;
+    }
+    for (size_t i = 0; i < n_counts; ++i) {
+      snapshot[i] = atomic_ref<uint64_t>(counts[i]).load(memory_order_relaxed);
+    }
+    const uint64_t n_events = n_events_in_file.load(memory_order_relaxed);
+    // None of the loads above may be reordered after the second load of the
+    // sequence number.
+    atomic_thread_fence(memory_order_acquire);
+    if (seq.load(memory_order_relaxed) == sequence_before) {
+      return n_events;
+    }
+  }
+  throw runtime_error("LiveSpectra: Could not read a consistent snapshot of '" +
+                      file_name +
+                      "'. The writing process may have been terminated "
+                      "during an update.");
+}
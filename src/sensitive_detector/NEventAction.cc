@@ -17,41 +17,54 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <chrono>
-
-using std::chrono::duration;
-using std::chrono::system_clock;
-using std::chrono::time_point;
-
-#include <ctime>
-
-using std::localtime;
-
-#include <iomanip>
-
-using std::put_time;
-using std::scientific;
-using std::setprecision;
-using std::setw;
-
 #include "G4RunManager.hh"
 
+#include "Checkpoint.hh"
+#include "EnergyAccumulator.hh"
 #include "NEventAction.hh"
-#include "NRunAction.hh"
+#include "PerfCounters.hh"
+#include "Progress.hh"
+#include "Trace.hh"
 
 void NEventAction::BeginOfEventAction(const G4Event *event) {
 
-  const int eventID = event->GetEventID();
+  if (run_action == nullptr) {
+    return;
+  }
+
+  EnergyAccumulator::Reset();
 
-  if (eventID % update_frequency == 0) {
-    NRunAction *run_action =
-        (NRunAction *)G4RunManager::GetRunManager()->GetUserRunAction();
+  if (Checkpoint::IsDue()) {
+    const Trace::Span span("checkpoint", "io");
+    analysis_manager->WriteCheckpoint();
+  }
+  if (!Checkpoint::ClaimEvent()) {
+    // Aborted events are not processed, and they are ignored by the
+    // EndOfEventAction.
+    G4RunManager::GetRunManager()->AbortRun();
+    return;
+  }
+
+  Progress::CountEvent();
+  Trace::BeginEvent(event->GetEventID());
+  PerfCounters::SetPhase(PerfCounters::Phase::tracking);
+}
+
+void NEventAction::EndOfEventAction(const G4Event *event) {
+  {
+    const Trace::Span span("EndOfEventAction", "analysis");
+    PerfCounters::SetPhase(PerfCounters::Phase::analysis);
+    ProcessEvent(event);
+  }
+  PerfCounters::SetPhase(PerfCounters::Phase::other);
+  // With several back-ends, the event ends with the last one.
+  Trace::EndEvent();
+}
 
-    const time_point<system_clock> current_time = system_clock::now();
-    const time_t current_time_t = system_clock::to_time_t(current_time);
-    duration<double> delta_t = current_time - run_action->get_start_time();
-    G4cout << put_time(localtime(&current_time_t), "%F %T") << " ( "
-           << scientific << setprecision(8) << delta_t.count()
-           << " s since start ) : Event #" << setw(10) << eventID << G4endl;
+vector<double> &NEventAction::DigitizedEdep() {
+  vector<double> &edep = EnergyAccumulator::GetEdep();
+  if (Digitizer::IsActive() && EnergyAccumulator::SetDigitized()) {
+    digitizer.Process(edep);
   }
+  return edep;
 }
@@ -17,31 +17,70 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <ctime>
-
-using std::localtime;
-using std::time;
-
-#include <iomanip>
-
-using std::put_time;
-
+#include "Checkpoint.hh"
 #include "NRunAction.hh"
+#include "PerfCounters.hh"
+#include "Progress.hh"
+#include "Trace.hh"
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
 #include "G4Threading.hh"
 
-NRunAction::NRunAction(const string _output_file_name, AnalysisManager *ana_man)
+NRunAction::NRunAction(const string _output_file_name, AnalysisManager *ana_man,
+                       const bool _first_backend)
     : G4UserRunAction(), output_file_name(_output_file_name),
-      analysis_manager(ana_man), start_time(system_clock::now()) {}
+      analysis_manager(ana_man), first_backend(_first_backend),
+      start_time(system_clock::now()) {}
+
+void NRunAction::BeginOfRunAction(const G4Run *run) {
+  if (!first_backend) {
+    analysis_manager->Book(output_file_name);
+    return;
+  }
 
-void NRunAction::BeginOfRunAction(const G4Run *) {
-  const time_t start_time_t = system_clock::to_time_t(start_time);
-  G4cout << "Run started on "
-         << put_time(localtime(&start_time_t), "%F %T (thread ID ")
-         << G4Threading::G4GetThreadId() << ")" << G4endl;
+  G4cout << "Run started on " << Progress::FormatTime(start_time)
+         << " (thread ID " << G4Threading::G4GetThreadId() << ")" << G4endl;
+  // The master thread books its output before the worker threads.
+  if (G4Threading::IsMasterThread()) {
+    Checkpoint::BeginRun(run->GetNumberOfEventToBeProcessed());
+  }
+  Checkpoint::BeginThread();
   analysis_manager->Book(output_file_name);
+  // The master thread knows the number of events only after the output was
+  // booked, which may resume an interrupted run.
+  if (G4Threading::IsMasterThread()) {
+    Progress::BeginRun(Checkpoint::GetEventsRemaining());
+    PerfCounters::BeginRun();
+  }
+  Progress::BeginThread();
+  PerfCounters::BeginThread();
 }
 
-void NRunAction::EndOfRunAction(const G4Run *) { analysis_manager->Save(); }
+void NRunAction::EndOfRunAction(const G4Run *run) {
+  {
+    const Trace::Span span("save output", "io");
+    const PerfCounters::Scope scope(PerfCounters::Phase::analysis);
+    analysis_manager->Save();
+  }
+  if (first_backend) {
+    if (Checkpoint::IsEnabled()) {
+      const Trace::Span span("checkpoint", "io");
+      analysis_manager->WriteCheckpoint();
+    }
+    Progress::EndThread();
+    PerfCounters::EndThread();
+    Trace::EndThread();
+  }
+  // The master thread finishes the run after all worker threads.
+  if (G4Threading::IsMasterThread()) {
+    if (first_backend) {
+      Progress::EndRun();
+      PerfCounters::Report();
+    }
+    {
+      const Trace::Span span("finish run", "io");
+      analysis_manager->FinishRun(run->GetRunID());
+    }
+  }
+}
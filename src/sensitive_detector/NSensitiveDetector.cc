@@ -31,4 +31,16 @@ NSensitiveDetector::NSensitiveDetector(const string &name,
   collectionName.insert(DetectorHitsCollectionName);
 }
 
-void NSensitiveDetector::EndOfEvent(G4HCofThisEvent *) {}
\ No newline at end of file
+void NSensitiveDetector::EndOfEvent(G4HCofThisEvent *) {}
+
+void NSensitiveDetector::SetLogicalVolumes(
+    const vector<G4LogicalVolume *> &logical_volumes) {
+  detector_ids.clear();
+  for (size_t i = 0; i < logical_volumes.size(); ++i) {
+    const size_t instance_id = logical_volumes[i]->GetInstanceID();
+    if (instance_id >= detector_ids.size()) {
+      detector_ids.resize(instance_id + 1, 0);
+    }
+    detector_ids[instance_id] = i;
+  }
+}
\ No newline at end of file
@@ -0,0 +1,327 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+using std::left;
+using std::lock_guard;
+using std::ostringstream;
+using std::right;
+using std::scientific;
+using std::setprecision;
+using std::setw;
+using std::string;
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include "PerfCounters.hh"
+
+G4ThreadLocal PerfCounters::ThreadCounters *PerfCounters::thread_counters =
+    nullptr;
+
+namespace {
+struct CounterDefinition {
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+};
+
+#ifndef __linux__
+// perf_event_open only exists on Linux. Elsewhere, the counters are never
+// opened, and the types and configurations below are placeholders.
+enum : uint32_t { PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE };
+enum : uint64_t {
+  PERF_COUNT_HW_CPU_CYCLES,
+  PERF_COUNT_HW_INSTRUCTIONS,
+  PERF_COUNT_HW_CACHE_MISSES,
+  PERF_COUNT_HW_BRANCH_MISSES,
+  PERF_COUNT_SW_TASK_CLOCK
+};
+#endif
+
+// The software counter comes last, so that a hardware counter leads the group
+// if there is one.
+constexpr CounterDefinition counter_definitions[] = {
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cache misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {"branch misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"CPU time / s", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+constexpr size_t cycles = 0, instructions = 1, cache_misses = 2,
+                 branch_misses = 3, cpu_time = 4;
+
+constexpr const char *phase_names[] = {"other", "primary generation",
+                                       "tracking", "sensitive detector",
+                                       "analysis/output"};
+} // namespace
+
+void PerfCounters::Counts::Add(const Counts &counts) {
+  for (size_t i = 0; i < n_counters; ++i) {
+    values[i] += counts.values[i];
+  }
+  time_enabled += counts.time_enabled;
+  time_running += counts.time_running;
+}
+
+#ifdef __linux__
+PerfCounters::ThreadCounters *PerfCounters::Open() {
+  static_assert(std::size(counter_definitions) == n_counters);
+
+  ThreadCounters *counters = new ThreadCounters;
+  counters->positions.fill(-1);
+  string errors;
+  for (size_t i = 0; i < n_counters; ++i) {
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = counter_definitions[i].type;
+    attributes.config = counter_definitions[i].config;
+    // The group is enabled as a whole when it is complete.
+    attributes.disabled = counters->leader == -1 ? 1 : 0;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_GROUP |
+                             PERF_FORMAT_TOTAL_TIME_ENABLED |
+                             PERF_FORMAT_TOTAL_TIME_RUNNING;
+    const int file_descriptor = static_cast<int>(
+        syscall(SYS_perf_event_open, &attributes, 0, -1, counters->leader, 0));
+    if (file_descriptor < 0) {
+      errors += string(errors.empty() ? "" : ", ") +
+                counter_definitions[i].name + " (" + strerror(errno) + ")";
+      continue;
+    }
+    if (counters->leader == -1) {
+      counters->leader = file_descriptor;
+    }
+    counters->positions[i] =
+        static_cast<int>(counters->file_descriptors.size());
+    counters->file_descriptors.push_back(file_descriptor);
+  }
+
+  if (!errors.empty() && !unavailable_reported.exchange(true)) {
+    G4cout << "PerfCounters: Not available: " << errors << "." << G4endl;
+  }
+  if (counters->leader == -1) {
+    delete counters;
+    return nullptr;
+  }
+  ioctl(counters->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return counters;
+}
+
+void PerfCounters::Close(ThreadCounters *counters) {
+  for (const int file_descriptor : counters->file_descriptors) {
+    close(file_descriptor);
+  }
+  delete counters;
+}
+
+PerfCounters::Counts PerfCounters::Read(const ThreadCounters &counters) {
+  // Layout of a group with PERF_FORMAT_TOTAL_TIME_ENABLED and
+  // PERF_FORMAT_TOTAL_TIME_RUNNING: number of counters, time enabled, time
+  // running, values.
+  array<uint64_t, 3 + n_counters> buffer{};
+  if (read(counters.leader, buffer.data(), sizeof(buffer)) <= 0) {
+    return counters.last;
+  }
+
+  Counts counts;
+  counts.time_enabled = buffer[1];
+  counts.time_running = buffer[2];
+  for (size_t i = 0; i < n_counters; ++i) {
+    if (counters.positions[i] >= 0) {
+      counts.values[i] = buffer[3 + counters.positions[i]];
+    }
+  }
+  return counts;
+}
+#else
+PerfCounters::ThreadCounters *PerfCounters::Open() {
+  static_assert(std::size(counter_definitions) == n_counters);
+
+  if (!unavailable_reported.exchange(true)) {
+    G4cout << "PerfCounters: Not available on this operating system."
+           << G4endl;
+  }
+  return nullptr;
+}
+
+void PerfCounters::Close(ThreadCounters *counters) { delete counters; }
+
+PerfCounters::Counts PerfCounters::Read(const ThreadCounters &counters) {
+  return counters.last;
+}
+#endif
+
+PerfCounters::Phase PerfCounters::Switch(const Phase phase) {
+  ThreadCounters &counters = *thread_counters;
+  const Counts now = Read(counters);
+  Counts &counts = counters.counts[static_cast<size_t>(counters.phase)];
+  for (size_t i = 0; i < n_counters; ++i) {
+    counts.values[i] += now.values[i] - counters.last.values[i];
+  }
+  counts.time_enabled += now.time_enabled - counters.last.time_enabled;
+  counts.time_running += now.time_running - counters.last.time_running;
+  counters.last = now;
+
+  const Phase previous = counters.phase;
+  counters.phase = phase;
+  return previous;
+}
+
+void PerfCounters::BeginRun() {
+  const lock_guard<mutex> lock(results_mutex);
+  results.clear();
+  available.fill(false);
+}
+
+void PerfCounters::BeginThread() {
+  // Only threads that process events are counted.
+  if (!enabled || (G4Threading::IsMultithreadedApplication() &&
+                   !G4Threading::IsWorkerThread())) {
+    if (thread_counters != nullptr) {
+      Close(thread_counters);
+      thread_counters = nullptr;
+    }
+    return;
+  }
+
+  if (thread_counters == nullptr) {
+    thread_counters = Open();
+    if (thread_counters == nullptr) {
+      return;
+    }
+  }
+  thread_counters->phase = Phase::other;
+  thread_counters->counts = {};
+  thread_counters->last = Read(*thread_counters);
+}
+
+void PerfCounters::EndThread() {
+  if (thread_counters == nullptr) {
+    return;
+  }
+  // Add the counts since the last change of the phase.
+  Switch(thread_counters->phase);
+
+  const lock_guard<mutex> lock(results_mutex);
+  results[std::max(G4Threading::G4GetThreadId(), 0)] =
+      thread_counters->counts;
+  for (size_t i = 0; i < n_counters; ++i) {
+    available[i] = available[i] || thread_counters->positions[i] >= 0;
+  }
+}
+
+void PerfCounters::Print(const char *title,
+                         const array<Counts, n_phases> &counts) {
+  ostringstream report;
+  report << "PerfCounters: " << title << "\n  " << left << setw(20) << "phase"
+         << right;
+  for (const auto &definition : counter_definitions) {
+    report << setw(15) << definition.name;
+  }
+  report << setw(8) << "IPC" << setw(16) << "cache misses" << setw(16)
+         << "branch misses"
+         << "\n  " << setw(20 + 15 * n_counters + 8) << ""
+         << setw(16) << "/ 1k instr." << setw(16) << "/ 1k instr." << "\n";
+
+  bool multiplexed = false;
+  for (size_t phase = 0; phase < n_phases; ++phase) {
+    const Counts &phase_counts = counts[phase];
+    // Extrapolate the counts if the counters were only running part of the
+    // time.
+    double scale = 1.;
+    if (phase_counts.time_running > 0 &&
+        phase_counts.time_running < phase_counts.time_enabled) {
+      scale = static_cast<double>(phase_counts.time_enabled) /
+              phase_counts.time_running;
+      multiplexed = true;
+    }
+    array<double, n_counters> values;
+    for (size_t i = 0; i < n_counters; ++i) {
+      values[i] = phase_counts.values[i] * scale;
+    }
+    values[cpu_time] *= 1e-9;
+
+    report << "  " << left << setw(20) << phase_names[phase] << right
+           << scientific << setprecision(3);
+    for (size_t i = 0; i < n_counters; ++i) {
+      if (available[i]) {
+        report << setw(15) << values[i];
+      } else {
+        report << setw(15) << "n/a";
+      }
+    }
+    auto ratio = [&](const size_t numerator, const size_t denominator,
+                     const double factor, const int width) {
+      if (available[numerator] && available[denominator] &&
+          values[denominator] > 0.) {
+        report << setw(width) << setprecision(2) << std::fixed
+               << factor * values[numerator] / values[denominator]
+               << scientific << setprecision(3);
+      } else {
+        report << setw(width) << "n/a";
+      }
+    };
+    ratio(instructions, cycles, 1., 8);
+    ratio(cache_misses, instructions, 1e3, 16);
+    ratio(branch_misses, instructions, 1e3, 16);
+    report << "\n";
+  }
+  if (multiplexed) {
+    report << "  The counters were multiplexed, the counts are extrapolated.\n";
+  }
+  G4cout << report.str() << G4endl;
+}
+
+void PerfCounters::Report() {
+  const lock_guard<mutex> lock(results_mutex);
+  if (results.empty()) {
+    return;
+  }
+
+  array<Counts, n_phases> total;
+  for (const auto &[thread_id, counts] : results) {
+    for (size_t phase = 0; phase < n_phases; ++phase) {
+      total[phase].Add(counts[phase]);
+    }
+  }
+  Print("all threads", total);
+
+  if (per_thread && results.size() > 1) {
+    for (const auto &[thread_id, counts] : results) {
+      Print(("thread " + std::to_string(thread_id)).c_str(), counts);
+    }
+  }
+}
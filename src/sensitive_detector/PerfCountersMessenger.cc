@@ -0,0 +1,49 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "PerfCounters.hh"
+#include "PerfCountersMessenger.hh"
+
+PerfCountersMessenger::PerfCountersMessenger()
+    : dir("/nutr/perf_counters/"),
+      cmd_enable("/nutr/perf_counters/enable", this),
+      cmd_per_thread("/nutr/perf_counters/per_thread", this) {
+  dir.SetGuidance("Hardware performance counters per phase of an event, "
+                  "which are printed at the end of a run (Linux only).");
+
+  cmd_enable.SetGuidance(
+      "If true, count CPU cycles, instructions, cache misses, and branch "
+      "misses of each thread in the following runs (default: false).");
+  cmd_enable.SetParameterName("enable", false);
+  cmd_enable.SetDefaultValue(false);
+
+  cmd_per_thread.SetGuidance(
+      "If true, the counts of each thread are printed in addition to the sum "
+      "of all threads (default: false).");
+  cmd_per_thread.SetParameterName("per_thread", false);
+  cmd_per_thread.SetDefaultValue(false);
+}
+
+void PerfCountersMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  if (command == &cmd_enable) {
+    PerfCounters::SetEnabled(cmd_enable.GetNewBoolValue(str));
+  } else if (command == &cmd_per_thread) {
+    PerfCounters::SetPerThread(cmd_per_thread.GetNewBoolValue(str));
+  }
+}
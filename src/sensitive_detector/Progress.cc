@@ -0,0 +1,254 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <sstream>
+#include <system_error>
+#include <time.h>
+#include <vector>
+
+using std::fixed;
+using std::ofstream;
+using std::ostringstream;
+using std::put_time;
+using std::scientific;
+using std::setprecision;
+using std::unique_lock;
+using std::vector;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+
+#include "G4Threading.hh"
+#include "G4ios.hh"
+
+#include "Progress.hh"
+
+G4ThreadLocal Progress::Slot *Progress::thread_slot = nullptr;
+
+namespace {
+struct ThreadRate {
+  int thread_id;
+  uint64_t n_events;
+  double rate;
+};
+} // namespace
+
+int64_t Progress::Now() {
+  return duration_cast<nanoseconds>(steady_clock::now() - start).count();
+}
+
+string Progress::FormatTime(const system_clock::time_point time,
+                            const char *format) {
+  const time_t time_t_value = system_clock::to_time_t(time);
+  tm local_time;
+  localtime_r(&time_t_value, &local_time);
+  ostringstream stream;
+  stream << put_time(&local_time, format);
+  return stream.str();
+}
+
+void Progress::BeginRun(const int64_t n_events_requested) {
+  start = steady_clock::now();
+  n_events_expected = n_events_requested;
+  n_events = 0;
+  next_report = static_cast<int64_t>(interval * 1e9);
+  for (auto &slot : slots) {
+    slot.n_events = 0;
+  }
+  n_slots = 0;
+  n_events_last_report = 0;
+  last_report = 0;
+}
+
+void Progress::BeginThread() {
+  thread_slot = nullptr;
+  if (G4Threading::IsMultithreadedApplication() &&
+      !G4Threading::IsWorkerThread()) {
+    return;
+  }
+
+  // Threads beyond max_threads are only included in the total.
+  const size_t index = n_slots.fetch_add(1);
+  if (index >= max_threads) {
+    return;
+  }
+  Slot &slot = slots[index];
+  slot.thread_id = std::max(G4Threading::G4GetThreadId(), 0);
+  slot.start = Now();
+  slot.end = 0;
+  thread_slot = &slot;
+}
+
+void Progress::EndThread() {
+  if (thread_slot != nullptr) {
+    thread_slot->end = Now();
+  }
+}
+
+void Progress::CountEvent() {
+  if (thread_slot != nullptr) {
+    // Only the owner of the slot writes to it.
+    thread_slot->n_events.store(
+        thread_slot->n_events.load(std::memory_order_relaxed) + 1,
+        std::memory_order_relaxed);
+  }
+  const uint64_t n = n_events.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  bool due = event_interval > 0 && n % event_interval == 0;
+  if (interval > 0.) {
+    const int64_t now = Now();
+    int64_t next = next_report.load(std::memory_order_relaxed);
+    // Of several threads that find a report due, only one updates the time of
+    // the next report.
+    if (now >= next &&
+        next_report.compare_exchange_strong(
+            next, now + static_cast<int64_t>(interval * 1e9))) {
+      due = true;
+    }
+  }
+  if (due) {
+    Report(false);
+  }
+}
+
+void Progress::EndRun() { Report(true); }
+
+void Progress::Report(const bool final) {
+  unique_lock<mutex> lock(report_mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    // Another thread is reporting at the moment.
+    if (!final) {
+      return;
+    }
+    lock.lock();
+  }
+
+  const int64_t now = Now();
+  const double elapsed = now * 1e-9;
+  const uint64_t n = n_events.load(std::memory_order_relaxed);
+  const double rate = elapsed > 0. ? n / elapsed : 0.;
+  // The ETA is based on the rate since the last report, which is not biased by
+  // the initialization of the threads.
+  const double current_rate =
+      now > last_report
+          ? (n - n_events_last_report) / ((now - last_report) * 1e-9)
+          : rate;
+  n_events_last_report = n;
+  last_report = now;
+  const int64_t n_missing = n_events_expected - static_cast<int64_t>(n);
+  const double eta = final ? 0.
+                     : n_missing > 0 && current_rate > 0.
+                         ? n_missing / current_rate
+                         : -1.;
+
+  vector<ThreadRate> thread_rates;
+  const size_t n_threads = std::min(n_slots.load(), max_threads);
+  double mean_rate = 0.;
+  size_t slowest = 0;
+  for (size_t i = 0; i < n_threads; ++i) {
+    const int64_t end = slots[i].end;
+    const double thread_elapsed =
+        ((end > 0 ? end : now) - slots[i].start) * 1e-9;
+    const uint64_t thread_n = slots[i].n_events.load(std::memory_order_relaxed);
+    thread_rates.push_back(
+        {slots[i].thread_id, thread_n,
+         thread_elapsed > 0. ? thread_n / thread_elapsed : 0.});
+    mean_rate += thread_rates.back().rate;
+    if (thread_rates.back().rate < thread_rates[slowest].rate) {
+      slowest = i;
+    }
+  }
+  if (n_threads > 0) {
+    mean_rate /= n_threads;
+  }
+  const double imbalance =
+      mean_rate > 0. ? 1. - thread_rates[slowest].rate / mean_rate : 0.;
+
+  const system_clock::time_point wall_time = system_clock::now();
+  ostringstream message;
+  message << FormatTime(wall_time) << " ( " << scientific << setprecision(8)
+          << elapsed << " s since start ) : " << (final ? "Finished " : "")
+          << n << " events";
+  if (n_events_expected > 0) {
+    message << " of " << n_events_expected << " ( " << fixed << setprecision(1)
+            << 100. * n / n_events_expected << " % )";
+  }
+  message << ", " << scientific << setprecision(3) << rate << " events/s";
+  if (eta >= 0. && !final) {
+    message << ", ETA "
+            << FormatTime(wall_time + duration_cast<system_clock::duration>(
+                                          duration<double>(eta)))
+            << " ( " << eta << " s )";
+  }
+  if (per_thread && n_threads > 1) {
+    message << "\n  events/s per thread:";
+    for (const auto &thread_rate : thread_rates) {
+      message << " t" << thread_rate.thread_id << " " << thread_rate.rate;
+    }
+    message << "\n  load imbalance " << fixed << setprecision(1)
+            << 100. * imbalance << " % ( slowest thread: t"
+            << thread_rates[slowest].thread_id << " )";
+  }
+  G4cout << message.str() << G4endl;
+
+  if (status_file.empty()) {
+    return;
+  }
+  // Write to a temporary file first, so that a reader never sees an
+  // incomplete status.
+  const string temporary_file_name = status_file + ".tmp";
+  {
+    ofstream file(temporary_file_name);
+    file << setprecision(std::numeric_limits<double>::max_digits10);
+    file << "{\n  \"state\": \"" << (final ? "finished" : "running")
+         << "\",\n  \"time\": \"" << FormatTime(wall_time, "%FT%T%z")
+         << "\",\n  \"elapsed_s\": " << elapsed << ",\n  \"events\": " << n
+         << ",\n  \"events_expected\": " << n_events_expected
+         << ",\n  \"events_per_s\": " << rate
+         << ",\n  \"current_events_per_s\": " << current_rate
+         << ",\n  \"eta_s\": " << eta << ",\n  \"load_imbalance\": "
+         << imbalance << ",\n  \"threads\": [";
+    for (size_t i = 0; i < thread_rates.size(); ++i) {
+      file << (i == 0 ? "\n" : ",\n") << "    {\"thread_id\": "
+           << thread_rates[i].thread_id
+           << ", \"events\": " << thread_rates[i].n_events
+           << ", \"events_per_s\": " << thread_rates[i].rate << "}";
+    }
+    file << "\n  ]\n}\n";
+    if (!file) {
+      // A monitoring file is not worth aborting the run.
+      G4cout << "Warning: Progress: Could not write '" << temporary_file_name
+             << "'." << G4endl;
+      return;
+    }
+  }
+  std::error_code error;
+  std::filesystem::rename(temporary_file_name, status_file, error);
+  if (error) {
+    G4cout << "Warning: Progress: Could not rename '" << temporary_file_name
+           << "' to '" << status_file << "': " << error.message() << "."
+           << G4endl;
+  }
+}
@@ -0,0 +1,73 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "G4SystemOfUnits.hh"
+
+#include "Progress.hh"
+#include "ProgressMessenger.hh"
+#include "SensitiveDetectorBuildOptions.hh"
+
+ProgressMessenger::ProgressMessenger()
+    : dir("/nutr/progress/"), cmd_events("/nutr/progress/events", this),
+      cmd_interval("/nutr/progress/interval", this),
+      cmd_per_thread("/nutr/progress/per_thread", this),
+      cmd_status_file("/nutr/progress/status_file", this) {
+  dir.SetGuidance("Reports about the progress of a run, which include the "
+                  "events of all threads.");
+
+  cmd_events.SetGuidance(
+      "Report after every given number of events of the run. A value of 0 "
+      "disables these reports (default: UPDATE_FREQUENCY build option).");
+  cmd_events.SetParameterName("events", false);
+  cmd_events.SetRange("events >= 0");
+  cmd_events.SetDefaultValue(sensitive_detector_build_options.update_frequency);
+
+  cmd_interval.SetGuidance(
+      "Report additionally after every given time interval. A value of 0 "
+      "disables these reports (default: 0 s).");
+  cmd_interval.SetParameterName("interval", false);
+  cmd_interval.SetRange("interval >= 0.");
+  cmd_interval.SetDefaultValue(0.);
+  cmd_interval.SetDefaultUnit("s");
+
+  cmd_per_thread.SetGuidance(
+      "If true, a report of a multithreaded run includes the events per "
+      "second of each thread and the load imbalance (default: true).");
+  cmd_per_thread.SetParameterName("per_thread", false);
+  cmd_per_thread.SetDefaultValue(true);
+
+  cmd_status_file.SetGuidance(
+      "Set name of a file into which each report is written in the JSON "
+      "format. The file is replaced atomically, so it can be read at any "
+      "time. An empty name disables the status file (default: '').");
+  cmd_status_file.SetParameterName("status_file", true);
+  cmd_status_file.SetDefaultValue("");
+}
+
+void ProgressMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  if (command == &cmd_events) {
+    Progress::SetEventInterval(cmd_events.GetNewIntValue(str));
+  } else if (command == &cmd_interval) {
+    Progress::SetInterval(cmd_interval.GetNewDoubleValue(str) / s);
+  } else if (command == &cmd_per_thread) {
+    Progress::SetPerThread(cmd_per_thread.GetNewBoolValue(str));
+  } else if (command == &cmd_status_file) {
+    Progress::SetStatusFile(str);
+  }
+}
@@ -0,0 +1,226 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using std::fixed;
+using std::lock_guard;
+using std::make_unique;
+using std::mutex;
+using std::ofstream;
+using std::runtime_error;
+using std::setprecision;
+using std::unique_ptr;
+using std::vector;
+using std::chrono::duration_cast;
+using std::chrono::nanoseconds;
+using std::chrono::steady_clock;
+
+#include "Trace.hh"
+
+namespace {
+struct Record {
+  const char *name;
+  const char *category;
+  int64_t start;
+  int64_t end;
+  int64_t first_event;
+  int64_t last_event;
+};
+
+struct Buffer {
+  // Only the owning thread adds records, but the master thread reads them
+  // when it writes the timeline.
+  mutex records_mutex;
+  size_t thread_id = 0;
+  string thread_name = "";
+  vector<Record> records;
+
+  // Span of events that is not recorded yet.
+  uint64_t n_events = 0;
+  int64_t events_start = 0;
+  int64_t events_end = 0;
+  int64_t first_event = 0;
+  int64_t last_event = 0;
+};
+
+const steady_clock::time_point application_start = steady_clock::now();
+
+mutex buffers_mutex;
+vector<unique_ptr<Buffer>> buffers;
+// Not G4ThreadLocal, because this class does not depend on Geant4.
+thread_local Buffer *thread_buffer = nullptr;
+
+Buffer &get_buffer() {
+  if (thread_buffer == nullptr) {
+    const lock_guard<mutex> lock(buffers_mutex);
+    buffers.push_back(make_unique<Buffer>());
+    buffers.back()->thread_id = buffers.size() - 1;
+    buffers.back()->thread_name =
+        "thread " + std::to_string(buffers.back()->thread_id);
+    thread_buffer = buffers.back().get();
+  }
+  return *thread_buffer;
+}
+
+string escape(const string &text) {
+  string escaped;
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+void add_events(Buffer &buffer) {
+  const lock_guard<mutex> lock(buffer.records_mutex);
+  buffer.records.push_back(
+      {buffer.n_events == 1 ? "event" : "events", "event", buffer.events_start,
+       buffer.events_end, buffer.first_event, buffer.last_event});
+  buffer.n_events = 0;
+}
+} // namespace
+
+void Trace::Enable(const string &_file_name) {
+  file_name = _file_name;
+  enabled = !file_name.empty();
+}
+
+void Trace::SetThreadName(const string &name) {
+  if (!enabled) {
+    return;
+  }
+  Buffer &buffer = get_buffer();
+  const lock_guard<mutex> lock(buffer.records_mutex);
+  buffer.thread_name = name;
+}
+
+int64_t Trace::Now() {
+  return duration_cast<nanoseconds>(steady_clock::now() - application_start)
+      .count();
+}
+
+void Trace::Add(const char *name, const char *category, const int64_t start,
+                const int64_t end, const int64_t first_event,
+                const int64_t last_event) {
+  if (!enabled) {
+    return;
+  }
+  Buffer &buffer = get_buffer();
+  const lock_guard<mutex> lock(buffer.records_mutex);
+  buffer.records.push_back(
+      {name, category, start, end, first_event, last_event});
+}
+
+void Trace::BeginEvent(const int64_t event_id) {
+  if (!enabled) {
+    return;
+  }
+  Buffer &buffer = get_buffer();
+  if (buffer.n_events == events_per_span) {
+    add_events(buffer);
+  }
+  const int64_t now = Now();
+  if (buffer.n_events == 0) {
+    buffer.events_start = now;
+    buffer.first_event = event_id;
+  }
+  buffer.events_end = now;
+  buffer.last_event = event_id;
+  ++buffer.n_events;
+}
+
+void Trace::EndEvent() {
+  if (!enabled) {
+    return;
+  }
+  get_buffer().events_end = Now();
+}
+
+void Trace::EndThread() {
+  if (!enabled) {
+    return;
+  }
+  Buffer &buffer = get_buffer();
+  if (buffer.n_events > 0) {
+    add_events(buffer);
+  }
+}
+
+void Trace::Write() {
+  if (!enabled) {
+    return;
+  }
+
+  // Write to a temporary file first, so that an interruption never leaves an
+  // incomplete timeline behind.
+  const string temporary_file_name = file_name + ".tmp";
+  {
+    ofstream file(temporary_file_name);
+    file << fixed << setprecision(3) << "{\"displayTimeUnit\": \"ms\", "
+         << "\"traceEvents\": [\n";
+    bool first = true;
+    const lock_guard<mutex> lock(buffers_mutex);
+    for (const auto &buffer : buffers) {
+      const lock_guard<mutex> records_lock(buffer->records_mutex);
+      file << (first ? "" : ",\n")
+           << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+              "\"tid\": "
+           << buffer->thread_id << ", \"args\": {\"name\": \""
+           << escape(buffer->thread_name) << "\"}}";
+      first = false;
+      // Timestamps are given in microseconds.
+      for (const auto &record : buffer->records) {
+        file << ",\n{\"name\": \"" << record.name << "\", \"cat\": \""
+             << record.category << "\", \"ph\": \"X\", \"ts\": "
+             << record.start * 1e-3
+             << ", \"dur\": " << (record.end - record.start) * 1e-3
+             << ", \"pid\": 1, \"tid\": " << buffer->thread_id;
+        if (record.first_event >= 0) {
+          file << ", \"args\": {\"first_event\": " << record.first_event
+               << ", \"last_event\": " << record.last_event << "}";
+        }
+        file << "}";
+      }
+    }
+    file << "\n]}\n";
+    if (!file) {
+      throw runtime_error("Trace: Could not write '" + temporary_file_name +
+                          "'.");
+    }
+  }
+  std::filesystem::rename(temporary_file_name, file_name);
+}
+
+void Trace::Clear() {
+  const lock_guard<mutex> lock(buffers_mutex);
+  for (const auto &buffer : buffers) {
+    const lock_guard<mutex> records_lock(buffer->records_mutex);
+    buffer->records.clear();
+  }
+}
@@ -0,0 +1,178 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <algorithm>
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include "Trigger.hh"
+
+bool Trigger::Accept(const vector<double> &edep) {
+  if (!active) {
+    return true;
+  }
+
+  size_t n_fired = 0;
+  for (size_t i = 0; i < edep.size(); ++i) {
+    if (Fires(edep, i)) {
+      ++n_fired;
+    }
+  }
+  if (n_fired < std::max(multiplicity, size_t(1))) {
+    return false;
+  }
+
+  for (const auto &coincidence : coincidences) {
+    for (const auto group : coincidence) {
+      const auto &detector_ids = groups[group].detector_ids;
+      if (std::none_of(detector_ids.begin(), detector_ids.end(),
+                       [&edep](const size_t detector_id) {
+                         return Fires(edep, detector_id);
+                       })) {
+        return false;
+      }
+    }
+  }
+
+  for (const auto &window : windows) {
+    double sum_edep = 0.;
+    for (const auto detector_id : groups[window.group].detector_ids) {
+      if (detector_id < edep.size()) {
+        sum_edep += edep[detector_id];
+      }
+    }
+    if (sum_edep < window.lower || sum_edep > window.upper) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void Trigger::SetThreshold(const double _threshold) {
+  threshold = _threshold;
+  active = true;
+}
+
+void Trigger::SetDetectorThreshold(const size_t detector_id,
+                                   const double _threshold) {
+  if (detector_id >= detector_thresholds.size()) {
+    detector_thresholds.resize(detector_id + 1, -1.);
+  }
+  detector_thresholds[detector_id] = _threshold;
+  active = true;
+}
+
+void Trigger::SetMultiplicity(const size_t _multiplicity) {
+  multiplicity = _multiplicity;
+  active = true;
+}
+
+size_t Trigger::GetGroupIndex(const string &name) {
+  for (size_t i = 0; i < groups.size(); ++i) {
+    if (groups[i].name == name) {
+      return i;
+    }
+  }
+  throw runtime_error("Trigger: No detector group with the name '" + name +
+                      "'.");
+}
+
+void Trigger::AddGroup(const string &name, const vector<size_t> &detector_ids) {
+  if (detector_ids.empty()) {
+    throw runtime_error("Trigger::AddGroup(): Detector group '" + name +
+                        "' is empty.");
+  }
+  for (auto &group : groups) {
+    if (group.name == name) {
+      group.detector_ids = detector_ids;
+      return;
+    }
+  }
+  groups.push_back({name, detector_ids});
+}
+
+void Trigger::AddCoincidence(const vector<string> &group_names) {
+  vector<size_t> coincidence;
+  for (const auto &group_name : group_names) {
+    coincidence.push_back(GetGroupIndex(group_name));
+  }
+  coincidences.push_back(coincidence);
+  active = true;
+}
+
+void Trigger::AddWindow(const string &group_name, const double lower,
+                        const double upper) {
+  if (lower > upper) {
+    throw runtime_error("Trigger::AddWindow(): Lower limit of the window for "
+                        "detector group '" +
+                        group_name + "' is larger than the upper limit.");
+  }
+  windows.push_back({GetGroupIndex(group_name), lower, upper});
+  active = true;
+}
+
+void Trigger::Reset() {
+  active = false;
+  threshold = 0.;
+  detector_thresholds.clear();
+  multiplicity = 1;
+  groups.clear();
+  coincidences.clear();
+  windows.clear();
+}
+
+void Trigger::Print() {
+  if (!active) {
+    G4cout << "Trigger: inactive, all events are accepted." << G4endl;
+    return;
+  }
+
+  G4cout << "Trigger: threshold " << threshold / keV << " keV, multiplicity "
+         << std::max(multiplicity, size_t(1)) << G4endl;
+  for (size_t i = 0; i < detector_thresholds.size(); ++i) {
+    if (detector_thresholds[i] >= 0.) {
+      G4cout << "  threshold of detector " << i << ": "
+             << detector_thresholds[i] / keV << " keV" << G4endl;
+    }
+  }
+  for (const auto &group : groups) {
+    G4cout << "  group '" << group.name << "':";
+    for (const auto detector_id : group.detector_ids) {
+      G4cout << " " << detector_id;
+    }
+    G4cout << G4endl;
+  }
+  for (const auto &coincidence : coincidences) {
+    G4cout << "  coincidence:";
+    for (const auto group : coincidence) {
+      G4cout << " '" << groups[group].name << "'";
+    }
+    G4cout << G4endl;
+  }
+  for (const auto &window : windows) {
+    G4cout << "  window for group '" << groups[window.group].name
+           << "': " << window.lower / keV << " keV to " << window.upper / keV
+           << " keV" << G4endl;
+  }
+}
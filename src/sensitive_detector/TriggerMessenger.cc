@@ -0,0 +1,157 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using std::istringstream;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+#include "Trigger.hh"
+#include "TriggerMessenger.hh"
+
+TriggerMessenger::TriggerMessenger()
+    : dir("/nutr/trigger/"), cmd_threshold("/nutr/trigger/threshold", this),
+      cmd_detector_threshold("/nutr/trigger/detector_threshold", this),
+      cmd_multiplicity("/nutr/trigger/multiplicity", this),
+      cmd_group("/nutr/trigger/group", this),
+      cmd_coincidence("/nutr/trigger/coincidence", this),
+      cmd_window("/nutr/trigger/window", this),
+      cmd_reset("/nutr/trigger/reset", this),
+      cmd_print("/nutr/trigger/print", this) {
+  dir.SetGuidance(
+      "Conditions for an event to be passed to the output. As long as no "
+      "condition is set, all events are passed.");
+
+  cmd_threshold.SetGuidance(
+      "Set the energy deposition above which a detector counts as hit by the "
+      "trigger (default: 0 keV).");
+  cmd_threshold.SetParameterName("threshold", false);
+  cmd_threshold.SetRange("threshold >= 0.");
+  cmd_threshold.SetDefaultUnit("keV");
+
+  cmd_detector_threshold.SetGuidance(
+      "Set the threshold of a single detector, which overrides the common "
+      "threshold. Parameters: DETECTOR_ID VALUE UNIT, for example '3 100 "
+      "keV'.");
+  cmd_detector_threshold.SetParameterName("detector_threshold", false);
+
+  cmd_multiplicity.SetGuidance(
+      "Set the minimum number of detectors above threshold (default: 1).");
+  cmd_multiplicity.SetParameterName("multiplicity", false);
+  cmd_multiplicity.SetRange("multiplicity >= 1");
+
+  cmd_group.SetGuidance("Define a named group of detectors. Parameters: NAME "
+                        "DETECTOR_ID [DETECTOR_ID ...].");
+  cmd_group.SetParameterName("group", false);
+
+  cmd_coincidence.SetGuidance(
+      "Require that at least one detector of each of the given groups is "
+      "above threshold. Parameters: GROUP GROUP [GROUP ...].");
+  cmd_coincidence.SetParameterName("coincidence", false);
+
+  cmd_window.SetGuidance(
+      "Require that the sum of the energy depositions in all detectors of a "
+      "group is inside an energy window. Parameters: GROUP LOWER UPPER UNIT, "
+      "for example 'clover 1100 1200 keV'.");
+  cmd_window.SetParameterName("window", false);
+
+  cmd_reset.SetGuidance(
+      "Remove all conditions, groups, and thresholds of the trigger.");
+
+  cmd_print.SetGuidance("Print the current conditions of the trigger.");
+}
+
+void TriggerMessenger::SetNewValue(G4UIcommand *command, G4String str) {
+  istringstream stream(str);
+
+  // The settings reject invalid values with an exception. An uncaught
+  // exception would terminate the application, even in an interactive
+  // session, so the command only fails.
+  try {
+    if (command == &cmd_threshold) {
+      Trigger::SetThreshold(cmd_threshold.GetNewDoubleValue(str));
+    } else if (command == &cmd_detector_threshold) {
+      size_t detector_id;
+      double value;
+      string unit;
+      if (!(stream >> detector_id >> value >> unit)) {
+        G4ExceptionDescription description;
+        description << "/nutr/trigger/detector_threshold: Expected DETECTOR_ID "
+                       "VALUE UNIT, got '"
+                    << str << "'.";
+        command->CommandFailed(description);
+        return;
+      }
+      Trigger::SetDetectorThreshold(detector_id,
+                                    value * G4UIcommand::ValueOf(unit.c_str()));
+    } else if (command == &cmd_multiplicity) {
+      Trigger::SetMultiplicity(cmd_multiplicity.GetNewIntValue(str));
+    } else if (command == &cmd_group) {
+      string name;
+      stream >> name;
+      vector<size_t> detector_ids;
+      size_t detector_id;
+      while (stream >> detector_id) {
+        detector_ids.push_back(detector_id);
+      }
+      if (!stream.eof()) {
+        G4ExceptionDescription description;
+        description << "/nutr/trigger/group: Expected NAME DETECTOR_ID "
+                       "[DETECTOR_ID ...], got '"
+                    << str << "'.";
+        command->CommandFailed(description);
+        return;
+      }
+      Trigger::AddGroup(name, detector_ids);
+    } else if (command == &cmd_coincidence) {
+      vector<string> group_names;
+      string group_name;
+      while (stream >> group_name) {
+        group_names.push_back(group_name);
+      }
+      Trigger::AddCoincidence(group_names);
+    } else if (command == &cmd_window) {
+      string group_name, unit;
+      double lower, upper;
+      if (!(stream >> group_name >> lower >> upper >> unit)) {
+        G4ExceptionDescription description;
+        description << "/nutr/trigger/window: Expected GROUP LOWER UPPER UNIT, "
+                       "got '"
+                    << str << "'.";
+        command->CommandFailed(description);
+        return;
+      }
+      const double unit_value = G4UIcommand::ValueOf(unit.c_str());
+      Trigger::AddWindow(group_name, lower * unit_value, upper * unit_value);
+    } else if (command == &cmd_reset) {
+      Trigger::Reset();
+    } else if (command == &cmd_print) {
+      Trigger::Print();
+    }
+  } catch (const runtime_error &error) {
+    G4ExceptionDescription description;
+    description << error.what();
+    command->CommandFailed(description);
+  }
+}
@@ -17,42 +17,30 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <memory>
-
-using std::make_unique;
-using std::unique_ptr;
-
 #include "G4Event.hh"
 #include "G4EventManager.hh"
 #include "G4ios.hh"
 
-#include "DetectorHit.hh"
 #include "EventAction.hh"
+#include "Trigger.hh"
 
-EventAction::EventAction(AnalysisManager *ana_man) : NEventAction(ana_man) {}
-
-void EventAction::EndOfEventAction(const G4Event *event) {
-  G4VHitsCollection *hc = nullptr;
-  unique_ptr<DetectorHit> cumulative_hit;
+namespace edep {
 
-  for (int n_hc = 0; n_hc < event->GetHCofThisEvent()->GetNumberOfCollections();
-       ++n_hc) {
+EventAction::EventAction(TupleManager *tuple_man)
+    : NEventAction(tuple_man), tuple_manager(tuple_man) {}
 
-    hc = event->GetHCofThisEvent()->GetHC(n_hc);
+void EventAction::ProcessEvent(const G4Event *event) {
+  if (event->IsAborted()) {
+    return;
+  }
 
-    if (hc->GetSize() > 0) {
-      double edep = 0.;
-      for (size_t i = 0; i < hc->GetSize(); ++i)
-        edep += ((DetectorHit *)hc->GetHit(i))->GetEdep();
+  vector<double> &edep = DigitizedEdep();
 
-      cumulative_hit = make_unique<DetectorHit>();
-      cumulative_hit->SetDetectorID(
-          ((DetectorHit *)hc->GetHit(0))->GetDetectorID());
-      cumulative_hit->SetEdep(edep);
-      vector<G4VHit *> hits{
-          cumulative_hit.get()}; // Wrap cumulative hit into a vector for
-                                 // compatibility with the AnalysisManager API.
-      analysis_manager->FillNtuple(event, hits);
-    }
+  if (!Trigger::Accept(edep)) {
+    return;
   }
+
+  tuple_manager->FillNtuple(event, edep);
 }
+
+} // namespace edep
@@ -18,27 +18,38 @@
 */
 
 #include "TupleManager.hh"
-#include "DetectorHit.hh"
 
-void TupleManager::CreateNtupleColumns(G4AnalysisManager *analysisManager) {
+namespace edep {
 
-  analysisManager->CreateNtuple("edep", "Energy Deposition");
+void TupleManager::CreateNtupleColumns() {
 
-  AnalysisManager::CreateNtupleColumns(analysisManager);
+  CreateNtuple("edep", "Energy Deposition");
 
-  analysisManager->CreateNtupleIColumn("deid");
-  analysisManager->CreateNtupleDColumn("edep");
-}
-
-size_t TupleManager::FillNtupleColumns(G4AnalysisManager *analysisManager,
-                                       [[maybe_unused]] const G4Event *event,
-                                       vector<G4VHit *> hits) {
+  AnalysisManager::CreateNtupleColumns();
 
-  auto col = AnalysisManager::FillNtupleColumns(analysisManager, event, hits);
+  CreateNtupleIColumn("deid");
+  CreateNtupleDColumn("edep");
+}
 
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetDetectorID());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetEdep());
-  return col;
+void TupleManager::FillNtuple(const G4Event *event,
+                              const vector<double> &edep) {
+
+  // A shard may only be closed after the last row of an event.
+  size_t last_row = edep.size();
+  for (size_t i = 0; i < edep.size(); ++i) {
+    if (edep[i] > 0. && UsesDetector(i)) {
+      last_row = i;
+    }
+  }
+
+  for (size_t i = 0; i < edep.size(); ++i) {
+    if (edep[i] > 0. && UsesDetector(i)) {
+      auto col = AnalysisManager::FillNtupleColumns(event, {});
+      FillNtupleIColumn(col++, static_cast<int>(i));
+      FillNtupleDColumn(col++, edep[i]);
+      AddNtupleRow(i == last_row);
+    }
+  }
 }
+
+} // namespace edep
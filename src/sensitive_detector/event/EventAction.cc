@@ -17,66 +17,40 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <algorithm>
-#include <memory>
-
-using std::make_unique;
-using std::unique_ptr;
-
 #include "G4Event.hh"
 #include "G4EventManager.hh"
 #include "G4ios.hh"
 
-#include "DetectorHit.hh"
 #include "EventAction.hh"
 #include "SensitiveDetectorBuildOptions.hh"
+#include "Trigger.hh"
 
-EventAction::EventAction(AnalysisManager *ana_man) : NEventAction(ana_man) {}
-
-void EventAction::EndOfEventAction(const G4Event *event) {
-  G4VHitsCollection *hc = nullptr;
-
-  vector<unique_ptr<DetectorHit>> hits_owned;
-  hits_owned.push_back(make_unique<DetectorHit>());
-
-  int current_deid{0};
-  int max_deid{0};
-  double sum_edep = 0.;
+namespace event {
 
-  for (int n_hc = 0; n_hc < event->GetHCofThisEvent()->GetNumberOfCollections();
-       ++n_hc) {
+EventAction::EventAction(TupleManager *tuple_man)
+    : NEventAction(tuple_man), tuple_manager(tuple_man) {}
 
-    hc = event->GetHCofThisEvent()->GetHC(n_hc);
-
-    if (hc->GetSize() > 0) {
-      current_deid = ((DetectorHit *)hc->GetHit(0))->GetDetectorID();
+void EventAction::ProcessEvent(const G4Event *event) {
+  if (event->IsAborted()) {
+    return;
+  }
 
-      // Fill the list of hits up to the current detector ID, if it is larger
-      // than the current maximum.
-      if (current_deid > max_deid) {
-        for (int i = 0; i < current_deid - max_deid; ++i) {
-          hits_owned.push_back(make_unique<DetectorHit>());
-        }
-        max_deid = current_deid;
-      }
+  vector<double> &edep = DigitizedEdep();
 
-      double edep = 0.;
-      for (size_t i = 0; i < hc->GetSize(); ++i) {
-        edep += ((DetectorHit *)hc->GetHit(i))->GetEdep();
-      }
+  if (!Trigger::Accept(edep)) {
+    return;
+  }
 
-      sum_edep += edep;
-      hits_owned[current_deid]->SetEdep(edep);
-    }
+  // Detectors of other back-ends are ignored (see
+  // AnalysisManager::SetBackendDetectors()).
+  bool hit = false;
+  for (size_t i = 0; i < edep.size() && !hit; ++i) {
+    hit = edep[i] > 0. && tuple_manager->UsesDetector(i);
   }
 
-  if (sensitive_detector_build_options.track_primary || sum_edep > 0.) {
-    vector<G4VHit *> hits_raw;
-    std::transform(hits_owned.begin(), hits_owned.end(),
-                   std::back_inserter(hits_raw),
-                   [](const std::unique_ptr<DetectorHit> &ptr) {
-                     return static_cast<G4VHit *>(ptr.get());
-                   });
-    analysis_manager->FillNtuple(event, hits_raw);
+  if (sensitive_detector_build_options.track_primary || hit) {
+    tuple_manager->FillNtuple(event, edep);
   }
 }
+
+} // namespace event
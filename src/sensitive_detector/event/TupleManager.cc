@@ -17,48 +17,89 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <memory>
-
-using std::dynamic_pointer_cast;
-
 #include "G4RunManager.hh"
 
-#include "DetectorHit.hh"
 #include "NDetectorConstruction.hh"
+#include "NutrMessenger.hh"
 #include "TupleManager.hh"
 
-void TupleManager::CreateNtupleColumns(G4AnalysisManager *analysisManager) {
+namespace event {
+
+void TupleManager::CreateNtupleColumns() {
 
-  analysisManager->CreateNtuple("edep", "Energy Deposition");
+  CreateNtuple("edep", "Energy Deposition");
 
-  AnalysisManager::CreateNtupleColumns(analysisManager);
+  AnalysisManager::CreateNtupleColumns();
 
   n_sensitive_detectors =
       ((NDetectorConstruction *)G4RunManager::GetRunManager()
            ->GetUserDetectorConstruction())
           ->GetNumberOfSensitiveDetectors();
+  backend_detectors = GetBackendDetectors(n_sensitive_detectors);
+
+  detector_groups.Initialize(
+      [this](const size_t detector_id) { return UsesDetector(detector_id); });
+
+  if (detector_groups.WriteDetectors()) {
+    // In the zero-suppressed layout, a row contains only the detectors with a
+    // non-zero energy deposition. Since only a few of many detectors are hit
+    // in a typical event, this is much more compact than one column per
+    // detector.
+    zero_suppression = NutrMessenger::GetZeroSuppression();
+    if (zero_suppression) {
+      CreateNtupleIVColumn("deid", detector_ids);
+      CreateNtupleDVColumn("edep", edeps);
+    } else {
+      for (const auto detector_id : backend_detectors) {
+        CreateNtupleDColumn("det" + to_string(detector_id));
+      }
+    }
+  }
 
-  for (size_t i = 0; i < n_sensitive_detectors; ++i) {
-    analysisManager->CreateNtupleDColumn("det" + to_string(i));
+  for (size_t i = 0; i < detector_groups.GetNumberOfGroups(); ++i) {
+    CreateNtupleDColumn(detector_groups.GetGroupName(i) + "_addback");
+    CreateNtupleDColumn(detector_groups.GetGroupName(i) + "_sum");
   }
 }
 
-size_t TupleManager::FillNtupleColumns(G4AnalysisManager *analysisManager,
-                                       const G4Event *event,
-                                       vector<G4VHit *> hits) {
-
-  auto col = AnalysisManager::FillNtupleColumns(analysisManager, event, hits);
-
-  for (size_t i = 0; i < hits.size(); ++i) {
-    analysisManager->FillNtupleDColumn(
-        0, col++, static_cast<DetectorHit *>(hits[i])->GetEdep());
+void TupleManager::FillNtuple(const G4Event *event,
+                              const vector<double> &edep) {
+
+  auto col = AnalysisManager::FillNtupleColumns(event, {});
+
+  if (detector_groups.WriteDetectors()) {
+    if (zero_suppression) {
+      detector_ids.clear();
+      edeps.clear();
+      for (size_t i = 0; i < edep.size(); ++i) {
+        if (edep[i] > 0. && UsesDetector(i)) {
+          detector_ids.push_back(static_cast<int>(i));
+          edeps.push_back(edep[i]);
+        }
+      }
+      FillNtupleIVColumn(col++, detector_ids);
+      FillNtupleDVColumn(col++, edeps);
+    } else {
+      // The energy deposition is only known up to the highest ID of all
+      // detectors that were hit. There may be detectors with an even higher
+      // ID which were not hit, whose columns are filled with zeros.
+      for (const auto detector_id : backend_detectors) {
+        FillNtupleDColumn(col++,
+                          detector_id < edep.size() ? edep[detector_id] : 0.);
+      }
+    }
   }
-  // The number of entries in std::vector hits will only be as large as highest
-  // ID of all detectors that were hit. There may be detectors with an even
-  // higher ID which were not hit. Fill all higher IDs than hits.size()-1 with
-  // zeros.
-  for (size_t i = hits.size(); i < n_sensitive_detectors; ++i) {
-    analysisManager->FillNtupleDColumn(0, col++, 0.);
+
+  // The groups only contain detectors of this back-end.
+  if (detector_groups.GetNumberOfGroups()) {
+    detector_groups.Compute(edep);
+    for (size_t i = 0; i < detector_groups.GetNumberOfGroups(); ++i) {
+      FillNtupleDColumn(col++, detector_groups.GetAddBack(i));
+      FillNtupleDColumn(col++, detector_groups.GetSum(i));
+    }
   }
-  return col;
+
+  AddNtupleRow();
 }
+
+} // namespace event
@@ -17,43 +17,34 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <memory>
-
-using std::make_shared;
-
 #include "G4Event.hh"
-#include "G4EventManager.hh"
 #include "G4ios.hh"
 
-#include "DetectorHit.hh"
+#include "DetectorHits.hh"
 #include "EventAction.hh"
 
-EventAction::EventAction(AnalysisManager *ana_man) : NEventAction(ana_man) {}
-
-void EventAction::EndOfEventAction(const G4Event *event) {
-  G4VHitsCollection *hc = nullptr;
-  int particleID{0}, trackID{0};
-  DetectorHit *hit;
-
-  for (int n_hc = 0; n_hc < event->GetHCofThisEvent()->GetNumberOfCollections();
-       ++n_hc) {
-    hc = event->GetHCofThisEvent()->GetHC(n_hc);
-
-    if (hc->GetSize() > 0) {
-      hit = (DetectorHit *)hc->GetHit(0);
-      analysis_manager->FillNtuple(event, {hit});
-      particleID = hit->GetParticleID();
-      trackID = hit->GetTrackID();
-
-      for (size_t i = 1; i < hc->GetSize(); ++i) {
-        hit = (DetectorHit *)hc->GetHit(i);
-        if (hit->GetParticleID() != particleID ||
-            hit->GetTrackID() != trackID) {
-          analysis_manager->FillNtuple(event, {hit});
-          particleID = hit->GetParticleID();
-          trackID = hit->GetTrackID();
-        }
-      }
-    }
+namespace flux {
+
+EventAction::EventAction(TupleManager *tuple_man)
+    : NEventAction(tuple_man), tuple_manager(tuple_man) {}
+
+void EventAction::ProcessEvent(const G4Event *event) {
+  if (event->IsAborted()) {
+    return;
+  }
+
+  // The sensitive detector only records the first entry of each particle into
+  // a detector, so all hits are written.
+  const DetectorHits &hits = DetectorHits::Instance();
+  for (size_t i = 0; i < hits.Size(); ++i) {
+    tuple_manager->FillHit(event, hits, i);
+  }
+
+  if (hits.GetNumberOfDroppedHits()) {
+    G4cout << "Warning: Event #" << event->GetEventID() << " truncated, "
+           << hits.GetNumberOfDroppedHits()
+           << " hits exceeded /analysis/hit_memory." << G4endl;
   }
 }
+
+} // namespace flux
@@ -17,32 +17,52 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include "G4SDManager.hh"
-
+#include "HitFilter.hh"
+#include "PerfCounters.hh"
 #include "SensitiveDetector.hh"
 
-void SensitiveDetector::Initialize(G4HCofThisEvent *hce) {
-
-  fDetectorHitsCollection = new G4THitsCollection<DetectorHit>(
-      SensitiveDetectorName, collectionName[0]);
+namespace flux {
 
-  int hcID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
-  hce->AddHitsCollection(hcID, fDetectorHitsCollection);
+void SensitiveDetector::Initialize(G4HCofThisEvent *) {
+  DetectorHits::Instance().Reset();
+  recorded_entries.clear();
 }
 
 G4bool SensitiveDetector::ProcessHits(G4Step *aStep, G4TouchableHistory *) {
-  DetectorHit *newDetectorHit = new DetectorHit();
+  const PerfCounters::Scope scope(PerfCounters::Phase::sensitive_detector);
+  const G4Track *track = aStep->GetTrack();
+  if (aStep->GetPreStepPoint()->GetStepStatus() != fGeomBoundary &&
+      track->GetCurrentStepNumber() != 1) {
+    return false;
+  }
+  if (!HitFilter::AcceptParticle(track->GetDynamicParticle()->GetPDGcode())) {
+    return false;
+  }
+  const unsigned int detector_id = GetDetectorID(aStep);
+  if (!HitFilter::AcceptDetector(detector_id)) {
+    return false;
+  }
+  if (!HitFilter::AcceptEnergy(track->GetKineticEnergy())) {
+    return false;
+  }
+  // A track that leaves a detector and enters it again is only recorded once.
+  // Entries that were rejected above do not count.
+  if (!recorded_entries
+           .insert(static_cast<uint64_t>(track->GetTrackID()) << 32 |
+                   detector_id)
+           .second) {
+    return false;
+  }
 
-  newDetectorHit->SetDetectorID(fDetectorID);
-  newDetectorHit->SetParticleID(
-      aStep->GetTrack()->GetDynamicParticle()->GetPDGcode());
-  newDetectorHit->SetParentID(aStep->GetTrack()->GetParentID());
-  newDetectorHit->SetTrackID(aStep->GetTrack()->GetTrackID());
-  newDetectorHit->SetEkin(aStep->GetTrack()->GetKineticEnergy());
-  newDetectorHit->SetPos(aStep->GetPostStepPoint()->GetPosition());
-  newDetectorHit->SetMom(aStep->GetTrack()->GetMomentum());
+  const G4ThreeVector &pos = aStep->GetPostStepPoint()->GetPosition();
+  const G4ThreeVector &mom = track->GetMomentum();
 
-  fDetectorHitsCollection->insert(newDetectorHit);
+  return DetectorHits::Instance().Add(
+      {static_cast<int32_t>(detector_id),
+       track->GetDynamicParticle()->GetPDGcode(), track->GetParentID(),
+       track->GetTrackID()},
+      {track->GetKineticEnergy(), pos.x(), pos.y(), pos.z(), mom.x(), mom.y(),
+       mom.z()});
+}
 
-  return true;
-}
\ No newline at end of file
+} // namespace flux
@@ -18,52 +18,39 @@
 */
 
 #include "TupleManager.hh"
-#include "DetectorHit.hh"
 
-void TupleManager::CreateNtupleColumns(G4AnalysisManager *analysisManager) {
-  analysisManager->CreateNtuple("part", "Particles");
-  AnalysisManager::CreateNtupleColumns(analysisManager);
-  analysisManager->CreateNtupleIColumn("deid");
-  analysisManager->CreateNtupleIColumn("pid");
-  analysisManager->CreateNtupleIColumn("paid");
-  analysisManager->CreateNtupleIColumn("trid");
-  analysisManager->CreateNtupleDColumn("ekin");
-  analysisManager->CreateNtupleDColumn("x");
-  analysisManager->CreateNtupleDColumn("y");
-  analysisManager->CreateNtupleDColumn("z");
-  analysisManager->CreateNtupleDColumn("px");
-  analysisManager->CreateNtupleDColumn("py");
-  analysisManager->CreateNtupleDColumn("pz");
+namespace flux {
+
+void TupleManager::CreateNtupleColumns() {
+  CreateNtuple("part", "Particles");
+  AnalysisManager::CreateNtupleColumns();
+  CreateNtupleIColumn("deid");
+  CreateNtupleIColumn("pid");
+  CreateNtupleIColumn("paid");
+  CreateNtupleIColumn("trid");
+  CreateNtupleDColumn("ekin");
+  CreateNtupleDColumn("x");
+  CreateNtupleDColumn("y");
+  CreateNtupleDColumn("z");
+  CreateNtupleDColumn("px");
+  CreateNtupleDColumn("py");
+  CreateNtupleDColumn("pz");
 }
 
-size_t TupleManager::FillNtupleColumns(G4AnalysisManager *analysisManager,
-                                       [[maybe_unused]] const G4Event *event,
-                                       vector<G4VHit *> hits) {
+void TupleManager::FillHit(const G4Event *event, const DetectorHits &hits,
+                           const size_t hit) {
 
-  auto col = AnalysisManager::FillNtupleColumns(analysisManager, event, hits);
+  auto col = AnalysisManager::FillNtupleColumns(event, {});
 
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetDetectorID());
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetParticleID());
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetParentID());
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetTrackID());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetEkin());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().x());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().y());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().z());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().x());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().y());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().z());
+  FillNtupleIColumn(col++, hits.GetI(hit::detector_id, hit));
+  FillNtupleIColumn(col++, hits.GetI(hit::particle_id, hit));
+  FillNtupleIColumn(col++, hits.GetI(hit::parent_id, hit));
+  FillNtupleIColumn(col++, hits.GetI(hit::track_id, hit));
+  for (size_t field = hit::ekin; field < hit::n_doubles; ++field) {
+    FillNtupleDColumn(col++, hits.GetD(field, hit));
+  }
 
-  return col;
+  AddNtupleRow(hit + 1 == hits.Size());
 }
+
+} // namespace flux
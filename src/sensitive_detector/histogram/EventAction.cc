@@ -0,0 +1,44 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include "G4Event.hh"
+
+#include "EventAction.hh"
+#include "Trigger.hh"
+
+namespace histogram {
+
+EventAction::EventAction(TupleManager *tuple_man)
+    : NEventAction(tuple_man), tuple_manager(tuple_man) {}
+
+void EventAction::ProcessEvent(const G4Event *event) {
+  if (event->IsAborted()) {
+    return;
+  }
+
+  vector<double> &edep = DigitizedEdep();
+
+  if (!Trigger::Accept(edep)) {
+    return;
+  }
+
+  tuple_manager->FillHistograms(edep);
+}
+
+} // namespace histogram
@@ -0,0 +1,312 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+
+using std::runtime_error;
+using std::filesystem::path;
+using std::chrono::duration;
+using std::chrono::duration_cast;
+
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+
+#include "Checkpoint.hh"
+#include "NDetectorConstruction.hh"
+#include "NutrMessenger.hh"
+#include "TupleManager.hh"
+
+namespace histogram {
+
+namespace {
+/**
+ * \brief Add n unweighted entries at x to a bin of a histogram
+ *
+ * Filling the bin once with the weight n would give it an uncertainty of n
+ * instead of sqrt(n).
+ *
+ * \param bin Bin index, where the underflow bin has the index 0.
+ */
+void add_entries(G4H1 *histogram, const unsigned int bin, const uint64_t n,
+                 const double x) {
+  const double w = static_cast<double>(n);
+  histogram->set_bin_content(bin, histogram->bins_entries()[bin] + n,
+                             histogram->bins_sum_w()[bin] + w,
+                             histogram->bins_sum_w2()[bin] + w,
+                             histogram->bins_sum_xw()[bin][0] + w * x,
+                             histogram->bins_sum_x2w()[bin][0] + w * x * x);
+}
+} // namespace
+
+TupleManager::TupleManager()
+    : AnalysisManager(), n_sensitive_detectors(0), n_bins(0), e_max(0.),
+      inverse_bin_width(0.), sparse(false), n_unpublished_events(0) {}
+
+void TupleManager::Book(string output_file_name) {
+
+  resolve_output_file_name(output_file_name, ".root");
+  // The spectra are only written at the end of a run.
+  if (Checkpoint::IsPeriodic()) {
+    throw runtime_error("histogram::TupleManager: Periodic checkpoints are "
+                        "not supported by the 'histogram' back-end.");
+  }
+  thread_shards.clear();
+
+  n_sensitive_detectors =
+      ((NDetectorConstruction *)G4RunManager::GetRunManager()
+           ->GetUserDetectorConstruction())
+          ->GetNumberOfSensitiveDetectors();
+  detector_groups.Initialize(
+      [this](const size_t detector_id) { return UsesDetector(detector_id); });
+  spectrum_names.clear();
+  detector_spectra.assign(n_sensitive_detectors, -1);
+  if (detector_groups.WriteDetectors()) {
+    for (const auto detector_id : GetBackendDetectors(n_sensitive_detectors)) {
+      detector_spectra[detector_id] = static_cast<int>(spectrum_names.size());
+      spectrum_names.push_back("det" + to_string(detector_id));
+    }
+  }
+  for (size_t i = 0; i < detector_groups.GetNumberOfGroups(); ++i) {
+    spectrum_names.push_back(detector_groups.GetGroupName(i) + "_addback");
+    spectrum_names.push_back(detector_groups.GetGroupName(i) + "_sum");
+  }
+
+  n_bins = NutrMessenger::GetHistogramBins();
+  e_max = NutrMessenger::GetHistogramMaximum();
+  inverse_bin_width = n_bins / e_max;
+  sparse = NutrMessenger::GetHistogramSparse();
+
+  // Including the overflow bin.
+  const size_t n_counts = spectrum_names.size() * (n_bins + 1);
+
+  counts.clear();
+  sparse_counts.clear();
+  published_counts.clear();
+  published_sparse_counts.clear();
+  n_unpublished_events = 0;
+  // The master thread of a multithreaded application does not process any
+  // events.
+  if (!(G4Threading::IsMultithreadedApplication() &&
+        G4Threading::IsMasterThread())) {
+    if (sparse) {
+      sparse_counts.resize(spectrum_names.size());
+    } else {
+      counts.assign(n_counts, 0);
+    }
+  }
+
+  // Worker threads are started after the master has booked its output, so
+  // the shared result is ready before any worker can add to it.
+  if (G4Threading::IsMasterThread()) {
+    merged_counts.reset(sparse ? nullptr : new atomic<uint64_t>[n_counts]());
+    merged_sparse_counts = nullptr;
+    live_spectra.reset();
+    if (NutrMessenger::GetHistogramLiveFile() != "") {
+      live_spectra = std::make_unique<LiveSpectra>(
+          Checkpoint::SegmentFileName(NutrMessenger::GetHistogramLiveFile()),
+          spectrum_names, n_bins + 1, e_max);
+    }
+  }
+
+  if (live_spectra) {
+    if (sparse) {
+      published_sparse_counts.resize(sparse_counts.size());
+    } else {
+      published_counts.assign(counts.size(), 0);
+    }
+    publication_interval = duration_cast<steady_clock::duration>(
+        duration<double>(NutrMessenger::GetHistogramLiveInterval() / s));
+    next_publication = steady_clock::now() + publication_interval;
+  }
+
+  fFactoryOn = true;
+}
+
+void TupleManager::FillHistograms(const vector<double> &edep) {
+  if (detector_groups.WriteDetectors()) {
+    for (size_t i = 0; i < std::min(edep.size(), detector_spectra.size());
+         ++i) {
+      if (edep[i] > 0. && detector_spectra[i] >= 0) {
+        FillHistogram(static_cast<size_t>(detector_spectra[i]), edep[i]);
+      }
+    }
+  }
+
+  // The spectra of the groups follow the spectra of the detectors.
+  size_t spectrum =
+      spectrum_names.size() - 2 * detector_groups.GetNumberOfGroups();
+
+  if (detector_groups.GetNumberOfGroups()) {
+    detector_groups.Compute(edep);
+    for (size_t i = 0; i < detector_groups.GetNumberOfGroups(); ++i) {
+      if (detector_groups.GetAddBack(i) > 0.) {
+        FillHistogram(spectrum, detector_groups.GetAddBack(i));
+      }
+      if (detector_groups.GetSum(i) > 0.) {
+        FillHistogram(spectrum + 1, detector_groups.GetSum(i));
+      }
+      spectrum += 2;
+    }
+  }
+
+  if (live_spectra) {
+    ++n_unpublished_events;
+    if (steady_clock::now() >= next_publication) {
+      Publish();
+    }
+  }
+}
+
+void TupleManager::Publish() {
+  live_spectra->BeginUpdate();
+  if (sparse) {
+    for (size_t i = 0; i < sparse_counts.size(); ++i) {
+      for (const auto &[bin, n] : sparse_counts[i]) {
+        uint64_t &published = published_sparse_counts[i][bin];
+        if (n != published) {
+          live_spectra->Add(i * (n_bins + 1) + bin, n - published);
+          published = n;
+        }
+      }
+    }
+  } else {
+    for (size_t i = 0; i < counts.size(); ++i) {
+      if (counts[i] != published_counts[i]) {
+        live_spectra->Add(i, counts[i] - published_counts[i]);
+        published_counts[i] = counts[i];
+      }
+    }
+  }
+  live_spectra->EndUpdate(n_unpublished_events);
+
+  n_unpublished_events = 0;
+  next_publication = steady_clock::now() + publication_interval;
+}
+
+void TupleManager::Save() {
+
+  if (!fFactoryOn)
+    return;
+
+  // After the final publication, the live spectra are identical to the
+  // spectra that are written to the output file.
+  if (live_spectra && n_unpublished_events) {
+    Publish();
+  }
+  Merge();
+  // The master thread finishes its run after all worker threads, i.e. after
+  // all spectra have been merged.
+  if (G4Threading::IsMasterThread()) {
+    Write();
+  }
+
+  fFactoryOn = false;
+}
+
+void TupleManager::Merge() {
+  if (sparse) {
+    if (sparse_counts.empty()) {
+      return;
+    }
+    SparseSpectra *spectra =
+        new SparseSpectra{std::move(sparse_counts), merged_sparse_counts};
+    while (!merged_sparse_counts.compare_exchange_weak(spectra->next,
+                                                       spectra)) {
+    }
+    sparse_counts.clear();
+    return;
+  }
+
+  for (size_t i = 0; i < counts.size(); ++i) {
+    if (counts[i]) {
+      merged_counts[i].fetch_add(counts[i], std::memory_order_relaxed);
+    }
+  }
+}
+
+void TupleManager::Write() {
+  G4AnalysisManager *g4_analysis_manager = G4AnalysisManager::Instance();
+
+  // Histograms cannot be deleted, so they are reused if there are several
+  // runs. The binning may have been changed between two runs.
+  for (size_t i = 0; i < spectrum_names.size(); ++i) {
+    if (i < histogram_ids.size()) {
+      g4_analysis_manager->SetH1(histogram_ids[i], n_bins, 0., e_max);
+    } else {
+      histogram_ids.push_back(g4_analysis_manager->CreateH1(
+          spectrum_names[i], "Energy Deposition (" + spectrum_names[i] + ")",
+          n_bins, 0., e_max));
+    }
+  }
+
+  // The counts of each bin are added as unweighted entries at its center.
+  // The last bin of the spectra is the overflow bin of the histograms.
+  const double bin_width = e_max / n_bins;
+  if (sparse) {
+    SparseSpectra *spectra = merged_sparse_counts.exchange(nullptr);
+    while (spectra != nullptr) {
+      for (size_t i = 0; i < spectra->counts.size(); ++i) {
+        G4H1 *histogram = g4_analysis_manager->GetH1(histogram_ids[i]);
+        for (const auto &[bin, n] : spectra->counts[i]) {
+          add_entries(histogram, bin + 1, n, (bin + 0.5) * bin_width);
+        }
+      }
+      SparseSpectra *next = spectra->next;
+      delete spectra;
+      spectra = next;
+    }
+  } else {
+    for (size_t i = 0; i < spectrum_names.size(); ++i) {
+      G4H1 *histogram = g4_analysis_manager->GetH1(histogram_ids[i]);
+      for (size_t bin = 0; bin <= n_bins; ++bin) {
+        const uint64_t n = merged_counts[i * (n_bins + 1) + bin];
+        if (n) {
+          add_entries(histogram, bin + 1, n, (bin + 0.5) * bin_width);
+        }
+      }
+    }
+  }
+
+  g4_analysis_manager->OpenFile(
+      Checkpoint::SegmentFileName(backend_file_name));
+  g4_analysis_manager->Write();
+  g4_analysis_manager->CloseFile();
+
+  // The file is listed in the checkpoint of the master thread and in the
+  // manifest. A file of histograms has no rows.
+  // Geant4 appends the default file type if the file name has no suffix.
+  path file_path(Checkpoint::SegmentFileName(backend_file_name));
+  if (!file_path.has_extension()) {
+    file_path += "." + g4_analysis_manager->GetFileType();
+  }
+  const string file_name = file_path.string();
+  thread_shards.push_back({file_name, G4Threading::G4GetThreadId(), 0,
+                           std::filesystem::exists(file_name)
+                               ? std::filesystem::file_size(file_name)
+                               : 0});
+  register_shard(thread_shards.back());
+
+  G4cout << "Created output file '" << g4_analysis_manager->GetFileName()
+         << "'." << G4endl;
+}
+
+} // namespace histogram
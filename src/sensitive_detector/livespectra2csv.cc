@@ -0,0 +1,65 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+// Print a snapshot of the spectra in a live spectra file, which is updated by
+// a running simulation, as comma-separated values on the standard output.
+// The first column contains the lower edge of each bin, the following columns
+// contain the counts of the spectra.
+// The last row is the overflow bin.
+// To follow a simulation, the program can be called periodically, for example
+// with 'watch'.
+
+#include <iostream>
+#include <vector>
+
+using std::cerr;
+using std::cout;
+using std::vector;
+
+#include "LiveSpectra.hh"
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    cerr << "Usage: " << argv[0] << " FILE\n";
+    return 1;
+  }
+
+  const LiveSpectra spectra(argv[1]);
+  vector<uint64_t> counts;
+  const uint64_t n_events = spectra.Read(counts);
+  const size_t n_spectra = spectra.GetNumberOfSpectra();
+  const size_t n_bins = spectra.GetNumberOfBins();
+  const double bin_width =
+      n_bins > 1 ? spectra.GetMaximumEnergy() / (n_bins - 1) : 0.;
+
+  cerr << n_events << " events\n";
+  cout << "e_min";
+  for (size_t i = 0; i < n_spectra; ++i) {
+    cout << "," << spectra.GetSpectrumName(i);
+  }
+  cout << "\n";
+  cout.precision(17);
+  for (size_t bin = 0; bin < n_bins; ++bin) {
+    cout << bin * bin_width;
+    for (size_t i = 0; i < n_spectra; ++i) {
+      cout << "," << counts[i * n_bins + bin];
+    }
+    cout << "\n";
+  }
+}
@@ -0,0 +1,99 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+// Convert a file in the nutr columnar output format to comma-separated values
+// on the standard output.
+// The values of a vector column in a row are separated by semicolons.
+
+#include <iostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+using std::cerr;
+using std::cout;
+using std::string;
+using std::variant;
+using std::vector;
+
+#include "ColumnarReader.hh"
+
+template <typename T>
+void print(const span<const T> &column, const size_t row, size_t &) {
+  cout << column[row];
+}
+
+template <typename T>
+void print(const ncol::VectorColumnChunk<T> &column, const size_t row,
+           size_t &offset) {
+  for (uint32_t i = 0; i < column.lengths[row]; ++i) {
+    cout << (i ? ";" : "") << column.values[offset++];
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc != 2) {
+    cerr << "Usage: " << argv[0] << " FILE.ncol\n";
+    return 1;
+  }
+
+  ColumnarReader reader(argv[1]);
+  const size_t n_columns = reader.GetNumberOfColumns();
+
+  for (size_t col = 0; col < n_columns; ++col) {
+    cout << reader.GetColumnName(col) << (col + 1 < n_columns ? "," : "\n");
+  }
+
+  cout.precision(17);
+  vector<variant<span<const int32_t>, span<const double>, span<const float>,
+                 ncol::VectorColumnChunk<int32_t>,
+                 ncol::VectorColumnChunk<double>>>
+      values(n_columns);
+  vector<size_t> offsets(n_columns);
+  for (size_t chunk = 0; chunk < reader.GetNumberOfChunks(); ++chunk) {
+    for (size_t col = 0; col < n_columns; ++col) {
+      switch (reader.GetColumnType(col)) {
+      case ncol::ColumnType::Int:
+        values[col] = reader.GetColumnChunk<int32_t>(col, chunk);
+        break;
+      case ncol::ColumnType::Double:
+        values[col] = reader.GetColumnChunk<double>(col, chunk);
+        break;
+      case ncol::ColumnType::Float:
+        values[col] = reader.GetColumnChunk<float>(col, chunk);
+        break;
+      case ncol::ColumnType::IntVector:
+        values[col] = reader.GetVectorColumnChunk<int32_t>(col, chunk);
+        break;
+      case ncol::ColumnType::DoubleVector:
+        values[col] = reader.GetVectorColumnChunk<double>(col, chunk);
+        break;
+      }
+      offsets[col] = 0;
+    }
+    for (size_t row = 0; row < reader.GetNumberOfRows(chunk); ++row) {
+      for (size_t col = 0; col < n_columns; ++col) {
+        std::visit([row, &offset = offsets[col]](
+                       const auto &column) { print(column, row, offset); },
+                   values[col]);
+        cout << (col + 1 < n_columns ? "," : "\n");
+      }
+    }
+  }
+}
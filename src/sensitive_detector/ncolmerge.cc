@@ -0,0 +1,47 @@
+/*
+    This file is part of nutr.
+
+    nutr is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    nutr is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with nutr.  If not, see <https://www.gnu.org/licenses/>.
+
+    Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
+*/
+
+// Merge files in the nutr columnar output format, for example the shards
+// written by different threads, into a single file.
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::cerr;
+using std::cout;
+using std::string;
+using std::vector;
+
+#include "ColumnarMerger.hh"
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    cerr << "Usage: " << argv[0]
+         << " OUTPUT.ncol INPUT.ncol [INPUT.ncol ...]\n";
+    return 1;
+  }
+
+  const vector<string> input_file_names(argv + 2, argv + argc);
+  const auto n_rows = ncol::merge(input_file_names, argv[1],
+                                  std::thread::hardware_concurrency());
+  cout << "Merged " << input_file_names.size() << " files with " << n_rows
+       << " rows into '" << argv[1] << "'.\n";
+}
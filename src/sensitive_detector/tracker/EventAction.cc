@@ -17,26 +17,39 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include <memory>
-
-using std::make_shared;
-
 #include "G4Event.hh"
-#include "G4EventManager.hh"
 #include "G4ios.hh"
 
-#include "DetectorHit.hh"
+#include "DetectorHits.hh"
 #include "EventAction.hh"
+#include "Trigger.hh"
 
-EventAction::EventAction(AnalysisManager *ana_man) : NEventAction(ana_man) {}
+namespace tracker {
 
-void EventAction::EndOfEventAction(const G4Event *event) {
-  G4VHitsCollection *hc = nullptr;
-  for (int n_hc = 0; n_hc < event->GetHCofThisEvent()->GetNumberOfCollections();
-       ++n_hc) {
-    hc = event->GetHCofThisEvent()->GetHC(n_hc);
+EventAction::EventAction(TupleManager *tuple_man)
+    : NEventAction(tuple_man), tuple_manager(tuple_man) {}
 
-    for (size_t i = 0; i < hc->GetSize(); ++i)
-      analysis_manager->FillNtuple(event, {(DetectorHit *)hc->GetHit(i)});
+void EventAction::ProcessEvent(const G4Event *event) {
+  if (event->IsAborted()) {
+    return;
+  }
+
+  // The trigger sees the same digitized energy depositions as the other
+  // back-ends, so they all accept the same events.
+  if (Trigger::IsActive() && !Trigger::Accept(DigitizedEdep())) {
+    return;
+  }
+
+  const DetectorHits &hits = DetectorHits::Instance();
+  for (size_t i = 0; i < hits.Size(); ++i) {
+    tuple_manager->FillHit(event, hits, i);
+  }
+
+  if (hits.GetNumberOfDroppedHits()) {
+    G4cout << "Warning: Event #" << event->GetEventID() << " truncated, "
+           << hits.GetNumberOfDroppedHits()
+           << " hits exceeded /analysis/hit_memory." << G4endl;
   }
 }
+
+} // namespace tracker
@@ -17,38 +17,65 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
-#include "G4SDManager.hh"
-
+#include "EnergyAccumulator.hh"
+#include "HitFilter.hh"
+#include "NutrMessenger.hh"
+#include "PerfCounters.hh"
 #include "SensitiveDetector.hh"
 
-void SensitiveDetector::Initialize(G4HCofThisEvent *hce) {
-
-  fDetectorHitsCollection = new G4THitsCollection<DetectorHit>(
-      SensitiveDetectorName, collectionName[0]);
-
-  int hcID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
-  hce->AddHitsCollection(hcID, fDetectorHitsCollection);
-}
+namespace tracker {
 
 G4bool SensitiveDetector::ProcessHits(G4Step *aStep, G4TouchableHistory *) {
+  const PerfCounters::Scope scope(PerfCounters::Phase::sensitive_detector);
   // Hits with no energy deposition are recorded as well.
   // This makes it possible to read out the point where a particle entered a
   // detector volume, because movement ('transportation') counts as a 'hit' with
   // an energy deposition of 0.
 
-  DetectorHit *newDetectorHit = new DetectorHit();
+  const G4Track *track = aStep->GetTrack();
+  const G4StepPoint *pre_step_point = aStep->GetPreStepPoint();
+  const G4ThreeVector &pos = pre_step_point->GetPosition();
+  const G4ThreeVector &mom = pre_step_point->GetMomentum();
+  const unsigned int detector_id = GetDetectorID(aStep);
+  const double edep = aStep->GetTotalEnergyDeposit();
 
-  newDetectorHit->SetTrackID(aStep->GetTrack()->GetTrackID());
-  newDetectorHit->SetParticleID(
-      aStep->GetTrack()->GetDynamicParticle()->GetPDGcode());
-  newDetectorHit->SetDetectorID(fDetectorID);
-  newDetectorHit->SetGlobalTime(aStep->GetPreStepPoint()->GetGlobalTime());
-  newDetectorHit->SetEdep(aStep->GetTotalEnergyDeposit());
-  newDetectorHit->SetEnergy(aStep->GetPreStepPoint()->GetKineticEnergy());
-  newDetectorHit->SetPos(aStep->GetPreStepPoint()->GetPosition());
-  newDetectorHit->SetMom(aStep->GetPreStepPoint()->GetMomentum());
+  // The energy deposition per detector is needed by the trigger.
+  if (edep > 0.) {
+    EnergyAccumulator::Add(detector_id, edep);
+  }
 
-  fDetectorHitsCollection->insert(newDetectorHit);
+  const int particle_id = track->GetDynamicParticle()->GetPDGcode();
+  const double ekin = pre_step_point->GetKineticEnergy();
+  if (!HitFilter::AcceptDetector(detector_id) ||
+      !HitFilter::AcceptParticle(particle_id) ||
+      !HitFilter::AcceptEnergy(ekin)) {
+    return false;
+  }
 
-  return true;
+  const double time = pre_step_point->GetGlobalTime();
+  DetectorHits &hits = DetectorHits::Instance();
+
+  // Add the step to the previous hit if it belongs to the same particle in the
+  // same detector, and if it begins close to the first step of that hit.
+  const double merge_distance = NutrMessenger::GetTrackerMergeDistance();
+  if (merge_distance > 0. && hits.Size() > 0) {
+    const size_t last = hits.Size() - 1;
+    if (hits.GetI(hit::track_id, last) == track->GetTrackID() &&
+        hits.GetI(hit::detector_id, last) ==
+            static_cast<int32_t>(detector_id) &&
+        time - hits.GetD(hit::time, last) <=
+            NutrMessenger::GetTrackerMergeTime() &&
+        (pos - G4ThreeVector(hits.GetD(hit::x, last), hits.GetD(hit::y, last),
+                             hits.GetD(hit::z, last)))
+                .mag2() <= merge_distance * merge_distance) {
+      hits.GetD(hit::edep, last) += edep;
+      return true;
+    }
+  }
+
+  return hits.Add(
+      {track->GetTrackID(), particle_id, static_cast<int32_t>(detector_id)},
+      {time, edep, ekin, pos.x(), pos.y(), pos.z(), mom.x(), mom.y(), mom.z()});
 }
+
+} // namespace tracker
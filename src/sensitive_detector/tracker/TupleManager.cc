@@ -17,54 +17,82 @@
     Copyright (C) 2020-2022 Udo Friman-Gayer and Oliver Papst
 */
 
+#include <stdexcept>
+
+using std::runtime_error;
+
+#include "NutrMessenger.hh"
 #include "TupleManager.hh"
-#include "DetectorHit.hh"
-
-void TupleManager::CreateNtupleColumns(G4AnalysisManager *analysisManager) {
-  analysisManager->CreateNtuple("hits", "Hits");
-  AnalysisManager::CreateNtupleColumns(analysisManager);
-  analysisManager->CreateNtupleIColumn("trid");
-  analysisManager->CreateNtupleIColumn("paid");
-  analysisManager->CreateNtupleIColumn("deid");
-  analysisManager->CreateNtupleDColumn("time");
-  analysisManager->CreateNtupleDColumn("edep");
-  analysisManager->CreateNtupleDColumn("ekin");
-  analysisManager->CreateNtupleDColumn("posx");
-  analysisManager->CreateNtupleDColumn("posy");
-  analysisManager->CreateNtupleDColumn("posz");
-  analysisManager->CreateNtupleDColumn("momx");
-  analysisManager->CreateNtupleDColumn("momy");
-  analysisManager->CreateNtupleDColumn("momz");
+
+namespace tracker {
+
+void TupleManager::CreateNtupleColumns() {
+  CreateNtuple("hits", "Hits");
+  AnalysisManager::CreateNtupleColumns();
+  CreateNtupleIColumn("trid");
+  CreateNtupleIColumn("paid");
+  CreateNtupleIColumn("deid");
+
+  compact = NutrMessenger::GetTrackerCompact();
+  // Geant4 merges the rows of all threads into a single ntuple in an
+  // arbitrary order, which would break the chain of relative positions.
+  if (compact && output_format != OutputFormat::ncol) {
+    throw runtime_error("tracker::TupleManager: The compact mode "
+                        "(/analysis/tracker/compact) requires the native "
+                        "columnar output format (/analysis/format ncol).");
+  }
+  previous_event_id = -1;
+  previous_track_id = -1;
+  for (auto name : {"time", "edep", "ekin", "posx", "posy", "posz", "momx",
+                    "momy", "momz"}) {
+    if (compact) {
+      CreateNtupleFColumn(name);
+    } else {
+      CreateNtupleDColumn(name);
+    }
+  }
 }
 
-size_t TupleManager::FillNtupleColumns(G4AnalysisManager *analysisManager,
-                                       const G4Event *event,
-                                       vector<G4VHit *> hits) {
-  auto col = AnalysisManager::FillNtupleColumns(analysisManager, event, hits);
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetTrackID());
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetParticleID());
-  analysisManager->FillNtupleIColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetDetectorID());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetGlobalTime());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetEdep());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetEkin());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().x());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().y());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetPos().z());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().x());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().y());
-  analysisManager->FillNtupleDColumn(
-      0, col++, static_cast<DetectorHit *>(hits[0])->GetMom().z());
-
-  return col;
+void TupleManager::FillHit(const G4Event *event, const DetectorHits &hits,
+                           const size_t hit) {
+
+  auto col = AnalysisManager::FillNtupleColumns(event, {});
+
+  FillNtupleIColumn(col++, hits.GetI(hit::track_id, hit));
+  FillNtupleIColumn(col++, hits.GetI(hit::particle_id, hit));
+  FillNtupleIColumn(col++, hits.GetI(hit::detector_id, hit));
+
+  if (!compact) {
+    for (size_t field = hit::time; field < hit::n_doubles; ++field) {
+      FillNtupleDColumn(col++, hits.GetD(field, hit));
+    }
+    AddNtupleRow(hit + 1 == hits.Size());
+    return;
+  }
+
+  FillNtupleFColumn(col++, static_cast<float>(hits.GetD(hit::time, hit)));
+  FillNtupleFColumn(col++, static_cast<float>(hits.GetD(hit::edep, hit)));
+  FillNtupleFColumn(col++, static_cast<float>(hits.GetD(hit::ekin, hit)));
+
+  const int event_id = event->GetEventID();
+  const int track_id = hits.GetI(hit::track_id, hit);
+  const bool relative =
+      event_id == previous_event_id && track_id == previous_track_id;
+  for (size_t i = 0; i < 3; ++i) {
+    const double position = hits.GetD(hit::x + i, hit);
+    const float value = static_cast<float>(
+        relative ? position - previous_position[i] : position);
+    FillNtupleFColumn(col++, value);
+    previous_position[i] = relative ? previous_position[i] + value : value;
+  }
+  previous_event_id = event_id;
+  previous_track_id = track_id;
+
+  for (size_t field = hit::px; field < hit::n_doubles; ++field) {
+    FillNtupleFColumn(col++, static_cast<float>(hits.GetD(field, hit)));
+  }
+
+  AddNtupleRow(hit + 1 == hits.Size());
 }
+
+} // namespace tracker